@@ -0,0 +1,995 @@
+#include "../src/task_manager.h"
+#include "../src/search_kernel.h"
+#include "../src/thread_pool.h"
+#include "../src/date_key.h"
+#include "../src/ranking.h"
+#include "../src/title_trie.h"
+#include "../src/case_fold.h"
+#include "../src/task_query.h"
+#include "../src/radix_sort.h"
+#include "../src/tim_sort.h"
+#include "../src/concurrent_task_manager.h"
+#include "../src/snapshot_task_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <locale>
+#include <random>
+#include <regex>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+const char* const titleWords[] = {
+    "Buy", "milk", "bread", "Call", "mom", "Finish", "homework", "report", "meeting", "with",
+    "team", "Pay", "bills", "Clean", "kitchen", "Walk", "the", "dog", "Book", "tickets",
+    "Купить", "молоко", "хлеб", "Позвонить", "маме", "Сделать", "домашнее", "задание",
+    "Оплатить", "счета", "Убрать", "кухню", "встреча", "отчёт", "врач", "подарок",
+};
+
+string randomTitle(mt19937& rng) {
+    const size_t wordCount = sizeof(titleWords) / sizeof(titleWords[0]);
+    string title;
+    const int words = 2 + static_cast<int>(rng() % 4);
+    for (int i = 0; i < words; ++i) {
+        if (i) title += ' ';
+        title += titleWords[rng() % wordCount];
+    }
+    return title;
+}
+
+string randomDate(mt19937& rng) {
+    char date[16];
+    snprintf(date, sizeof(date), "%02u.%02u.%04u",
+        static_cast<unsigned>(1 + rng() % 28), static_cast<unsigned>(1 + rng() % 12), static_cast<unsigned>(2024 + rng() % 3));
+    return date;
+}
+
+void fillManager(TaskManager& manager, size_t count, unsigned seed = 1) {
+    mt19937 rng(seed);
+    for (size_t i = 0; i < count; ++i) {
+        manager.addTask(randomTitle(rng), randomDate(rng), 1 + static_cast<int>(rng() % 3));
+    }
+}
+
+template <class Function>
+double measureMs(Function&& function, int repeats = 5) {
+    double best = 1e100;
+    for (int i = 0; i < repeats; ++i) {
+        const auto start = chrono::steady_clock::now();
+        function();
+        const auto stop = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, milli>(stop - start).count());
+    }
+    return best;
+}
+
+void benchSearch() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+    manager.setResultCacheCapacity(0);
+
+    cout << "search: " << count << " tasks, kernel " << searchKernelName()
+        << ", " << ThreadPool::shared().size() << " threads\n";
+    for (const string keyword : { "homework", "молоко", "15.06.2025", "absent keyword" }) {
+        size_t expected = 0;
+        const double scalarMs = measureMs([&] {
+            expected = 0;
+            for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+                const auto& task = manager.getTask(i);
+                if (task.title.find(keyword) != string::npos || task.date.find(keyword) != string::npos) ++expected;
+            }
+        });
+
+        size_t found = 0;
+        const double kernelMs = measureMs([&] { found = manager.findTaskIndices(keyword).size(); });
+
+        cout << "  \"" << keyword << "\": " << found << " matches"
+            << (found == expected ? "" : " (MISMATCH)")
+            << ", string::find " << scalarMs << " ms, findTaskIndices " << kernelMs << " ms, x"
+            << scalarMs / kernelMs << "\n";
+
+        const string folded = foldCase(keyword);
+        const double foldOnSearchMs = measureMs([&] {
+            expected = 0;
+            for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+                const auto& task = manager.getTask(i);
+                if (foldCase(task.title).find(folded) != string::npos || foldCase(task.date).find(folded) != string::npos) ++expected;
+            }
+        });
+        const double ignoreCaseMs = measureMs([&] { found = manager.findTaskIndices(keyword, true).size(); });
+        cout << "    ignoring case: " << found << " matches" << (found == expected ? "" : " (MISMATCH)")
+            << ", folding per search " << foldOnSearchMs << " ms, folded column " << ignoreCaseMs << " ms\n";
+    }
+}
+
+void benchMultiKeywordSearch() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+    manager.setResultCacheCapacity(0);
+
+    cout << "multi-keyword search: " << count << " tasks\n";
+    const size_t wordCount = sizeof(titleWords) / sizeof(titleWords[0]);
+    for (size_t keywords : { 2, 8, 32 }) {
+        string expression;
+        for (size_t i = 0; i < keywords; ++i) {
+            if (i) expression += " OR ";
+            expression += string("\"") + titleWords[(i * 7) % wordCount] + " \"";
+        }
+
+        size_t found = 0;
+        const double ms = measureMs([&] { found = manager.findTaskIndicesMatching(expression).size(); });
+        cout << "  " << keywords << " keywords OR-ed: " << found << " matches, " << ms << " ms\n";
+    }
+}
+
+void benchFuzzySearch() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+
+    cout << "fuzzy search: " << count << " tasks\n";
+    for (const string keyword : { "homwork", "малоко", "tikets meting" }) {
+        size_t found = 0;
+        const double ms = measureMs([&] { found = manager.findTasksFuzzy(keyword, 2).size(); });
+        cout << "  \"" << keyword << "\" within 2 edits: " << found << " matches, " << ms << " ms\n";
+    }
+}
+
+void benchDateRange() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+
+    cout << "date range: " << count << " tasks\n";
+    const pair<const char*, const char*> ranges[] = {
+        { "01.06.2025", "07.06.2025" }, { "01.06.2025", "30.06.2025" }, { "01.01.2024", "31.12.2026" },
+    };
+    for (const auto& range : ranges) {
+        const int from = dateKey(range.first);
+        const int to = dateKey(range.second);
+
+        size_t expected = 0;
+        const double scanMs = measureMs([&] {
+            expected = 0;
+            for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+                const int key = dateKey(manager.getTask(i).date);
+                if (key >= from && key <= to) ++expected;
+            }
+        });
+
+        size_t found = 0;
+        const double indexMs = measureMs([&] { found = manager.findTasksInRange(range.first, range.second).size(); });
+        cout << "  " << range.first << " - " << range.second << ": " << found << " tasks"
+            << (found == expected ? "" : " (MISMATCH)") << ", scan " << scanMs << " ms, index " << indexMs << " ms\n";
+    }
+
+    const double addMs = measureMs([&] { manager.addTask("Extra", "15.06.2025", 1); }, 1000);
+    cout << "  addTask with index maintenance: " << addMs * 1000 << " us\n";
+}
+
+void benchResultCache() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+
+    cout << "result cache: " << count << " tasks\n";
+    for (const string query : { "priority>=2 completed:no text:\"tickets\"", "Book AND tickets" }) {
+        manager.setResultCacheCapacity(0);
+        const double uncachedMs = measureMs([&] { manager.findTasksByQuery(query); });
+        manager.setResultCacheCapacity(32);
+        manager.findTasksByQuery(query);
+        const double cachedMs = measureMs([&] { manager.findTasksByQuery(query); });
+        const double patchedMs = measureMs([&] {
+            manager.addTask("Book tickets", "01.06.2025", 2);
+            manager.findTasksByQuery(query);
+        });
+        cout << "  \"" << query << "\": uncached " << uncachedMs << " ms, cached " << cachedMs
+            << " ms, after an append " << patchedMs << " ms\n";
+    }
+
+    const auto stats = manager.resultCacheStats();
+    cout << "  hits " << stats.hits << ", patches " << stats.patches << ", misses " << stats.misses
+        << ", hit rate " << stats.hitRate() << "\n";
+}
+
+void benchRanking() {
+    const size_t count = 1000000;
+    const size_t k = 10;
+    TaskManager manager;
+    fillManager(manager, count);
+
+    TermStatistics statistics;
+    for (size_t i = 0; i < count; ++i) statistics.addTitle(manager.getTask(i).title);
+
+    cout << "ranking: " << count << " tasks, top " << k << "\n";
+    for (const string query : { "milk", "Book tickets", "Купить молоко хлеб" }) {
+        size_t matched = 0;
+        const double sortMs = measureMs([&] {
+            const Bm25Scorer scorer(query, statistics);
+            vector<pair<double, size_t>> scored;
+            for (size_t i = 0; i < count; ++i) {
+                const double score = scorer.score(manager.getTask(i).title);
+                if (score > 0) scored.emplace_back(-score, i);
+            }
+            sort(scored.begin(), scored.end());
+            matched = scored.size();
+        });
+        const double heapMs = measureMs([&] { manager.findTopTasks(query, k); });
+        cout << "  \"" << query << "\": " << matched << " matches, score and sort " << sortMs
+            << " ms, bounded heap " << heapMs << " ms\n";
+    }
+}
+
+void benchCompletion() {
+    const size_t count = 1000000;
+    const size_t limit = 5;
+    mt19937 rng(1);
+    vector<string> titles(count);
+    for (auto& title : titles) title = randomTitle(rng);
+
+    TitleTrie trie;
+    const double buildMs = measureMs([&] {
+        trie.clear();
+        for (const auto& title : titles) trie.insert(title);
+    }, 1);
+
+    // Alternative: distinct normalized titles with use counts, sorted, searched with
+    // lower_bound and ranked by scanning the whole matching range.
+    vector<pair<string, uint32_t>> sorted;
+    const double sortedBuildMs = measureMs([&] {
+        vector<string> normalized;
+        normalized.reserve(count);
+        for (const auto& title : titles) normalized.push_back(normalizeTitle(title));
+        sort(normalized.begin(), normalized.end());
+        sorted.clear();
+        for (const auto& title : normalized) {
+            if (sorted.empty() || sorted.back().first != title) sorted.emplace_back(title, 0);
+            ++sorted.back().second;
+        }
+        sorted.shrink_to_fit();
+    }, 1);
+    size_t sortedBytes = sorted.capacity() * sizeof(sorted[0]);
+    for (const auto& entry : sorted) {
+        if (entry.first.capacity() > 15) sortedBytes += entry.first.capacity() + 1;
+    }
+
+    cout << "completion: " << count << " tasks, " << trie.titleCount() << " distinct titles\n";
+    cout << "  build: trie " << buildMs << " ms, sorted vector " << sortedBuildMs << " ms\n";
+    cout << "  memory per title: trie " << static_cast<double>(trie.memoryUsage()) / trie.titleCount()
+        << " bytes, sorted vector " << static_cast<double>(sortedBytes) / sorted.size() << " bytes\n";
+
+    for (const string prefix : { "b", "buy m", "купить молоко х" }) {
+        const double trieMs = measureMs([&] { trie.complete(prefix, limit); }, 1000);
+        const double sortedMs = measureMs([&] {
+            const string key = normalizeTitle(prefix);
+            auto it = lower_bound(sorted.begin(), sorted.end(), make_pair(key, uint32_t(0)));
+            vector<pair<uint32_t, size_t>> ranked;
+            for (; it != sorted.end() && it->first.compare(0, key.size(), key) == 0; ++it)
+                ranked.emplace_back(it->second, it - sorted.begin());
+            partial_sort(ranked.begin(), ranked.begin() + min(limit, ranked.size()), ranked.end(),
+                [](const auto& a, const auto& b) { return a.first > b.first; });
+        }, 1000);
+        cout << "  \"" << prefix << "\": trie " << trieMs * 1000 << " us, sorted vector " << sortedMs * 1000 << " us\n";
+    }
+}
+
+void benchPagination() {
+    const size_t count = 1000000;
+    const size_t pageSize = 20;
+    TaskManager manager;
+    fillManager(manager, count);
+    manager.setResultCacheCapacity(0);
+
+    cout << "pagination: " << count << " tasks, pages of " << pageSize << "\n";
+    for (const string expression : { "Buy", "milk OR bread", "врач AND подарок" }) {
+        size_t found = 0;
+        const double allMs = measureMs([&] { found = manager.findTaskIndicesMatching(expression).size(); });
+        const double firstPageMs = measureMs([&] { manager.searchCursor(expression).next(pageSize); });
+        const double offsetPageMs = measureMs([&] {
+            auto cursor = manager.searchCursor(expression);
+            cursor.skip(found / 2);
+            cursor.next(pageSize);
+        });
+        cout << "  \"" << expression << "\": " << found << " matches, all " << allMs << " ms, first page "
+            << firstPageMs << " ms, page at offset " << found / 2 << " " << offsetPageMs << " ms\n";
+    }
+}
+
+void benchBlockSkipping() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+    for (size_t i = 0; i < 20; ++i) manager.editTask(i * 49999, "Renew passport", "", -1);
+    manager.setResultCacheCapacity(0);
+
+    size_t taskBytes = count * sizeof(Task);
+    for (size_t i = 0; i < count; ++i) taskBytes += manager.getTask(i).title.capacity() + manager.getTask(i).date.capacity();
+    const size_t blocks = (count + SearchColumn::blockRecords - 1) / SearchColumn::blockRecords;
+    const size_t summaryBytes = blocks * (SearchColumn::bloomBytesPerBlock + sizeof(ZoneMaps::Zone));
+    cout << "block skipping: " << count << " tasks, " << blocks << " blocks, summaries "
+        << 100.0 * summaryBytes / taskBytes << "% of task memory\n";
+
+    for (const string keyword : { "passport", "homework", "absent keyword" }) {
+        size_t found = 0;
+        const auto before = manager.blockSkipStats();
+        manager.findTaskIndices(keyword);
+        const auto after = manager.blockSkipStats();
+        const double ms = measureMs([&] { found = manager.findTaskIndices(keyword).size(); });
+        cout << "  \"" << keyword << "\": " << found << " matches, " << ms << " ms, "
+            << 100.0 * (after.skipped - before.skipped) / blocks << "% of blocks skipped\n";
+    }
+
+    manager.sortTasks([](const Task& a, const Task& b) { return dateKey(a.date) < dateKey(b.date); });
+    for (const string query : { "NOT due<01.12.2026", "NOT (due<01.06.2025 OR due>30.06.2025)" }) {
+        const auto parsed = TaskQuery::parse(query);
+        size_t expected = 0;
+        const double bruteMs = measureMs([&] {
+            expected = 0;
+            for (size_t i = 0; i < count; ++i) expected += parsed.matches(manager.getTask(i));
+        });
+        size_t found = 0;
+        const auto before = manager.blockSkipStats();
+        manager.findTasksByQuery(query);
+        const auto after = manager.blockSkipStats();
+        const double zoneMs = measureMs([&] { found = manager.findTasksByQuery(query).size(); });
+        cout << "  \"" << query << "\": " << found << " matches" << (found == expected ? "" : " (MISMATCH)")
+            << ", evaluating every task " << bruteMs << " ms, zone maps " << zoneMs << " ms, "
+            << 100.0 * (after.skipped - before.skipped) / blocks << "% of blocks decided by zone map\n";
+    }
+}
+
+void benchRegex() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+    for (size_t i = 0; i < 20; ++i) manager.editTask(i * 49999, "Renew passport 2025", "", -1);
+    manager.setResultCacheCapacity(0);
+
+    cout << "regex: " << count << " tasks\n";
+    for (const string pattern : { "^Buy (milk|bread)", "(homework|report) with", "^Купить .*хлеб$", "passport \\d+", "m[aeiou]m" }) {
+        // std::regex is far too slow for the whole list; time it on a slice and scale.
+        const size_t slice = count / 10;
+        const std::regex reference(pattern);
+        size_t expected = 0;
+        const double stdMs = measureMs([&] {
+            expected = 0;
+            for (size_t i = 0; i < slice; ++i) expected += std::regex_search(manager.getTask(i).title, reference);
+        }, 1) * (count / slice);
+
+        size_t found = 0;
+        manager.findTasksByRegex(pattern);
+        const double dfaMs = measureMs([&] { found = manager.findTasksByRegex(pattern).size(); });
+        size_t sliceFound = 0;
+        for (const size_t i : manager.findTasksByRegex(pattern)) sliceFound += i < slice;
+        cout << "  \"" << pattern << "\": " << found << " matches" << (sliceFound == expected ? "" : " (MISMATCH)")
+            << ", std::regex ~" << stdMs << " ms, lazy DFA " << dfaMs << " ms\n";
+    }
+}
+
+struct Suite {
+    const char* name;
+    void (*run)();
+};
+
+// Sorts fresh copies of the tasks, so every run starts from the same unsorted order.
+template <class Compare>
+double measureSortMs(const vector<Task>& original, Compare comparator) {
+    double best = 1e100;
+    for (int i = 0; i < 3; ++i) {
+        vector<Task> tasks = original;
+        const auto start = chrono::steady_clock::now();
+        sort(tasks.begin(), tasks.end(), comparator);
+        const auto stop = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, milli>(stop - start).count());
+    }
+    return best;
+}
+
+// Sorting task indices keeps the moves cheap, so the cost of the comparison itself shows.
+template <class Compare>
+double measureIndexSortMs(const vector<Task>& original, Compare comparator) {
+    double best = 1e100;
+    for (int i = 0; i < 3; ++i) {
+        vector<uint32_t> order(original.size());
+        for (size_t j = 0; j < order.size(); ++j) order[j] = static_cast<uint32_t>(j);
+        const auto start = chrono::steady_clock::now();
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return comparator(original[a], original[b]); });
+        const auto stop = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, milli>(stop - start).count());
+    }
+    return best;
+}
+
+template <class Compare>
+void benchSortOrder(const char* name, const vector<Task>& original, Compare comparator) {
+    const function<bool(const Task&, const Task&)> erased = comparator;
+    const double inlinedMs = measureSortMs(original, comparator);
+    const double erasedMs = measureSortMs(original, erased);
+    const double inlinedIndexMs = measureIndexSortMs(original, comparator);
+    const double erasedIndexMs = measureIndexSortMs(original, erased);
+    cout << "  " << name << ": tasks std::function " << erasedMs << " ms, functor " << inlinedMs
+        << " ms; indices std::function " << erasedIndexMs << " ms, functor " << inlinedIndexMs << " ms\n";
+}
+
+void benchSort() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+    vector<Task> original;
+    original.reserve(count);
+    for (size_t i = 0; i < count; ++i) original.push_back(manager.getTask(i));
+
+    cout << "sort: " << count << " tasks\n";
+    benchSortOrder("priority ascending", original, ByPriorityAscending());
+    benchSortOrder("priority descending", original, ByPriorityDescending());
+    benchSortOrder("date ascending", original, ByDateAscending());
+    benchSortOrder("date descending", original, ByDateDescending());
+    benchSortOrder("title", original, ByTitle());
+
+    const double sortTasksMs = measureMs([&] {
+        manager.sortTasks(SortOrder::Title);
+        manager.sortTasks(SortOrder::PriorityAscending);
+    }, 1);
+    cout << "  sortTasks by title, then priority, with index rebuilds: " << sortTasksMs << " ms\n";
+}
+
+void benchRadixSort() {
+    const size_t count = 10000000;
+    vector<Task> original;
+    original.reserve(count);
+    mt19937 rng(1);
+    for (size_t i = 0; i < count; ++i) original.push_back({ randomTitle(rng), randomDate(rng), 1 + static_cast<int>(rng() % 3), false });
+
+    cout << "radix sort: " << count << " tasks\n";
+    long long prioritySum = 0;
+    const double passMs = measureMs([&] {
+        prioritySum = 0;
+        for (const auto& task : original) prioritySum += task.priority;
+    });
+    // A sequential pass that moves every task, the floor for any sort that reorders them.
+    double movePassMs = 0;
+    {
+        vector<Task> tasks = original;
+        const auto start = chrono::steady_clock::now();
+        vector<Task> moved;
+        moved.reserve(tasks.size());
+        for (auto& task : tasks) moved.push_back(move(task));
+        movePassMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    cout << "  one pass summing priorities: " << passMs << " ms (sum " << prioritySum << "), moving every task: "
+        << movePassMs << " ms\n";
+
+    vector<uint32_t> priorities(count);
+    for (size_t i = 0; i < count; ++i) priorities[i] = static_cast<uint32_t>(original[i].priority);
+    cout << "  radix order of the priority keys alone: " << measureMs([&] { radixSortOrder(priorities); }) << " ms\n";
+
+    const auto measureRadixMs = [&](auto keyOf) {
+        double best = 1e100;
+        for (int i = 0; i < 3; ++i) {
+            vector<Task> tasks = original;
+            const auto start = chrono::steady_clock::now();
+            radixSort(tasks, keyOf);
+            const auto stop = chrono::steady_clock::now();
+            best = min(best, chrono::duration<double, milli>(stop - start).count());
+        }
+        return best;
+    };
+    cout << "  by priority: std::sort " << measureSortMs(original, ByPriorityAscending()) << " ms, radix sort "
+        << measureRadixMs([](const Task& task) { return static_cast<uint32_t>(task.priority); }) << " ms\n";
+    cout << "  by date: std::sort " << measureSortMs(original, ByDateAscending()) << " ms, radix sort "
+        << measureRadixMs([](const Task& task) { return static_cast<uint32_t>(dateKey(task.date)); }) << " ms\n";
+}
+
+void benchParallelSort() {
+    const size_t count = 10000000;
+    vector<Task> original;
+    original.reserve(count);
+    mt19937 rng(1);
+    for (size_t i = 0; i < count; ++i) original.push_back({ randomTitle(rng), randomDate(rng), 1 + static_cast<int>(rng() % 3), false });
+
+    cout << "parallel sort: " << count << " tasks by title, " << thread::hardware_concurrency() << " hardware threads\n";
+    vector<Task> expected = original;
+    const double serialMs = measureMs([&] { stable_sort(expected.begin(), expected.end(), ByTitle()); }, 1);
+    cout << "  stable_sort: " << serialMs << " ms\n";
+
+    for (const size_t threads : { 1, 2, 4, 8, 16 }) {
+        ThreadPool pool(threads);
+        vector<Task> tasks = original;
+        const double parallelMs = measureMs([&] { pool.stableSort(tasks.begin(), tasks.end(), ByTitle()); }, 1);
+        bool same = true;
+        for (size_t i = 0; i < count && same; ++i) same = tasks[i].title == expected[i].title && tasks[i].date == expected[i].date;
+        cout << "  " << threads << " threads: " << parallelMs << " ms, speedup " << serialMs / parallelMs
+            << (same ? "" : " (MISMATCH)") << "\n";
+    }
+}
+
+void benchMultiKeySort() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+    vector<Task> original;
+    original.reserve(count);
+    for (size_t i = 0; i < count; ++i) original.push_back(manager.getTask(i));
+
+    const vector<SortKey> keys = { { SortField::Priority, true }, { SortField::Date }, { SortField::Title } };
+    const function<bool(const Task&, const Task&)> erased = [](const Task& a, const Task& b) {
+        if (a.priority != b.priority) return a.priority > b.priority;
+        const int dateA = dateKey(a.date), dateB = dateKey(b.date);
+        if (dateA != dateB) return dateA < dateB;
+        return a.title < b.title;
+    };
+
+    cout << "multi-key sort: " << count << " tasks, priority desc, date, title\n";
+    cout << "  stable_sort with a std::function comparator: " << measureSortMs(original, erased) << " ms\n";
+    cout << "  stable_sort with CompositeOrder: " << measureSortMs(original, CompositeOrder{ keys }) << " ms\n";
+    cout << "  packed keys, sortTasks (6 title bytes packed, ties on longer shared prefixes): " << measureMs([&] { manager.sortTasks(keys); }, 1) << " ms\n";
+    const vector<SortKey> integerKeys = { { SortField::Priority, true }, { SortField::Date } };
+    cout << "  packed keys without title, sortTasks: " << measureMs([&] { manager.sortTasks(integerKeys); }, 1) << " ms\n";
+    size_t found = 0;
+    const double topMs = measureMs([&] { found = manager.topTasks(10, keys, true).size(); });
+    cout << "  topTasks(10) in the same order: " << topMs << " ms (" << found << " tasks)\n";
+    cout << "  topTasks(10) most urgent first: " << measureMs([&] { found = manager.topTasks(10).size(); }) << " ms\n";
+    cout << "  single integer key, sortTasks by date: " << measureMs([&] { manager.sortTasks(SortOrder::DateAscending); }, 1) << " ms\n";
+}
+
+void benchIndirectSort() {
+    const size_t count = 1000000;
+    cout << "indirect sort: " << count << " tasks by title\n";
+    for (const int parts : { 1, 4 }) {
+        vector<Task> original;
+        original.reserve(count);
+        mt19937 rng(1);
+        size_t titleBytes = 0;
+        for (size_t i = 0; i < count; ++i) {
+            string title = randomTitle(rng);
+            for (int part = 1; part < parts; ++part) title += " " + randomTitle(rng);
+            titleBytes += title.size();
+            original.push_back({ title, randomDate(rng), 1 + static_cast<int>(rng() % 3), false });
+        }
+
+        const double directMs = measureSortMs(original, ByTitle());
+        double indirectMs = 1e100;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            vector<Task> tasks = original;
+            const auto start = chrono::steady_clock::now();
+            vector<uint32_t> order(tasks.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+            stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return tasks[a].title < tasks[b].title; });
+            applyPermutation(tasks, move(order));
+            const auto stop = chrono::steady_clock::now();
+            indirectMs = min(indirectMs, chrono::duration<double, milli>(stop - start).count());
+        }
+        cout << "  titles of " << titleBytes / count << " bytes on average: sorting tasks " << directMs
+            << " ms, sorting indices and moving each task once " << indirectMs << " ms\n";
+
+        // sortTasks by title sorts packed title prefixes with their indices, then moves
+        // each task once; the comparator version sorts the tasks. Both rebuild indexes.
+        TaskManager manager;
+        for (const auto& task : original) manager.addTask(task.title, task.date, task.priority);
+        const double keyMs = measureMs([&] { manager.sortTasks(SortOrder::Title); manager.sortTasks(SortOrder::DateAscending); }, 3);
+        const double comparatorMs = measureMs([&] {
+            manager.sortTasks([](const Task& a, const Task& b) { return a.title < b.title; });
+            manager.sortTasks(SortOrder::DateAscending);
+        }, 3);
+        cout << "    sortTasks by title, then by date: packed title keys " << keyMs << " ms, title comparator " << comparatorMs << " ms\n";
+    }
+}
+
+void benchAdaptiveSort() {
+    const size_t count = 1000000;
+    const size_t edits = 100;
+    TaskManager manager;
+    fillManager(manager, count);
+    const auto urgentFirst = [](const Task& a, const Task& b) {
+        if (a.priority != b.priority) return a.priority > b.priority;
+        return a.title < b.title;
+    };
+    manager.sortTasks(urgentFirst);
+
+    // A sorted list with a few tasks changed in place, as after a day of edits.
+    mt19937 rng(1);
+    vector<Task> nearlySorted;
+    nearlySorted.reserve(count);
+    for (size_t i = 0; i < count; ++i) nearlySorted.push_back(manager.getTask(i));
+    for (size_t i = 0; i < edits; ++i) {
+        auto& task = nearlySorted[rng() % count];
+        task.title = randomTitle(rng);
+        task.priority = 1 + static_cast<int>(rng() % 3);
+    }
+
+    size_t comparisons = 0;
+    const auto counted = [&](const Task& a, const Task& b) { ++comparisons; return urgentFirst(a, b); };
+    const auto measure = [&](const char* name, auto sortRange) {
+        double best = 1e100;
+        for (int i = 0; i < 3; ++i) {
+            vector<Task> tasks = nearlySorted;
+            comparisons = 0;
+            const auto start = chrono::steady_clock::now();
+            sortRange(tasks.begin(), tasks.end(), counted);
+            const auto stop = chrono::steady_clock::now();
+            best = min(best, chrono::duration<double, milli>(stop - start).count());
+        }
+        cout << "  " << name << ": " << best << " ms, " << static_cast<double>(comparisons) / count << " comparisons per task\n";
+    };
+
+    cout << "adaptive sort: " << count << " sorted tasks with " << edits << " edited, priority desc then title\n";
+    measure("std::sort", [](auto first, auto last, auto compare) { sort(first, last, compare); });
+    measure("stable_sort", [](auto first, auto last, auto compare) { stable_sort(first, last, compare); });
+    measure("timSort", [](auto first, auto last, auto compare) { timSort(first, last, compare); });
+
+    for (size_t i = 0; i < edits; ++i) manager.editTask(rng() % count, randomTitle(rng), "", 1 + static_cast<int>(rng() % 3));
+    cout << "  sortTasks with the comparator after the edits, with index rebuilds: "
+        << measureMs([&] { manager.sortTasks(urgentFirst); }, 1) << " ms\n";
+
+    const vector<SortKey> keys = { { SortField::Priority, true }, { SortField::Title } };
+    const double firstMs = measureMs([&] { manager.sortTasks(keys); }, 1);
+    const double againMs = measureMs([&] { manager.sortTasks(keys); });
+    for (size_t i = 0; i < edits; ++i) manager.editTask(rng() % count, "", "", 1 + static_cast<int>(rng() % 3));
+    const double afterEditsMs = measureMs([&] { manager.sortTasks(keys); }, 1);
+    cout << "  sortTasks by keys: " << firstMs << " ms, again while still sorted " << againMs
+        << " ms, after " << edits << " edits " << afterEditsMs << " ms\n";
+}
+
+void benchCollation() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    fillManager(manager, count);
+
+    // ru_RU is not installed everywhere; the C.UTF-8 collation still pays for a locale
+    // call per comparison, which is what the cached keys avoid.
+    locale collating = locale::classic();
+    string localeName = "classic";
+    for (const char* name : { "ru_RU.UTF-8", "C.UTF-8" }) {
+        try {
+            collating = locale(name);
+            localeName = name;
+            break;
+        }
+        catch (const runtime_error&) {}
+    }
+    const auto& collate = use_facet<std::collate<char>>(collating);
+
+    vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    const double localeMs = measureMs([&] {
+        stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const string& left = manager.getTask(a).title;
+            const string& right = manager.getTask(b).title;
+            return collate.compare(left.data(), left.data() + left.size(), right.data(), right.data() + right.size()) < 0;
+        });
+    }, 1);
+
+    size_t keyBytes = 0;
+    const double keysMs = measureMs([&] {
+        keyBytes = 0;
+        for (size_t i = 0; i < count; ++i) keyBytes += collationKey(manager.getTask(i).title).size();
+    }, 1);
+
+    size_t checksum = 0;
+    const auto walk = [&] {
+        size_t position = 0;
+        manager.forEachInOrder(SortOrder::CollatedTitle, [&](size_t index) { checksum += index * ++position; });
+    };
+    const double firstWalkMs = measureMs(walk, 1);
+    const double walkMs = measureMs(walk, 3);
+    const double sortMs = measureMs([&] {
+        manager.sortTasks(SortOrder::CollatedTitle);
+        manager.sortTasks(SortOrder::DateAscending);
+    }, 3);
+
+    cout << "collation: " << count << " tasks\n";
+    cout << "  stable_sort with a " << localeName << " locale comparison: " << localeMs << " ms\n";
+    cout << "  building all collation keys: " << keysMs << " ms, " << keyBytes / count << " bytes per key\n";
+    cout << "  CollatedTitle order: first walk (keys built) " << firstWalkMs << " ms, then " << walkMs << " ms\n";
+    cout << "  sortTasks by CollatedTitle, then by date, keys moved along: " << sortMs << " ms (" << checksum % 10 << ")\n";
+}
+
+void benchOrderedViews() {
+    const size_t count = 1000000;
+    TaskManager manager;
+    const double addMs = measureMs([&] { fillManager(manager, count); }, 1);
+    cout << "ordered views: " << count << " tasks, addTask " << addMs * 1000 / count << " us per task\n";
+
+    size_t checksum = 0;
+    const auto walk = [&](SortOrder order) {
+        size_t position = 0;
+        manager.forEachInOrder(order, [&](size_t index) { checksum += index * ++position; });
+    };
+    for (const auto order : { SortOrder::PriorityDescending, SortOrder::DateAscending, SortOrder::Title }) {
+        // The title order sorts the tasks added since the last read on the first walk.
+        const double firstWalkMs = measureMs([&] { walk(order); }, 1);
+        const double walkMs = measureMs([&] { walk(order); });
+        const double sortMs = measureMs([&] { manager.sortTasks(order); }, 1);
+        cout << "  order " << static_cast<int>(order) << ": first walk " << firstWalkMs << " ms, then "
+            << walkMs << " ms; sortTasks " << sortMs << " ms\n";
+    }
+    cout << "  checksum " << checksum % 1000 << "\n";
+
+    const double editMs = measureMs([&] {
+        for (size_t i = 0; i < 1000; ++i) manager.editTask(i * 997, "Renamed task", "01.01.2026", 2);
+    }, 1);
+    const double deleteMs = measureMs([&] {
+        for (size_t i = 0; i < 10; ++i) manager.deleteTask(i * 99991);
+    }, 1);
+    cout << "  with views built: editTask " << editMs << " us, deleteTask " << deleteMs / 10 << " ms\n";
+}
+
+struct Throughput {
+    double reads;
+    double writes;
+};
+
+// Reads and writes per second with `readers` threads calling read(rng) while one writer
+// calls write(step) and sleeps a millisecond, for about durationMs.
+template <class Read, class Write>
+Throughput measureThroughput(size_t readers, Read&& read, Write&& write, int durationMs = 500) {
+    atomic<bool> running{ true };
+    atomic<size_t> reads{ 0 };
+    vector<thread> threads;
+    for (size_t i = 0; i < readers; ++i) {
+        threads.emplace_back([&, i] {
+            mt19937 rng(static_cast<unsigned>(i + 1));
+            size_t done = 0;
+            while (running) {
+                read(rng);
+                ++done;
+            }
+            reads += done;
+        });
+    }
+    const auto start = chrono::steady_clock::now();
+    size_t writes = 0;
+    for (; chrono::steady_clock::now() - start < chrono::milliseconds(durationMs); ++writes) {
+        write(writes);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    running = false;
+    for (auto& thread : threads) thread.join();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return { reads / seconds, writes / seconds };
+}
+
+void benchConcurrency() {
+    const size_t count = 200000;
+    const char* const keywords[] = { "milk", "report", "маме", "team" };
+
+    ConcurrentTaskManager shared;
+    shared.write([&](TaskManager& manager) { fillManager(manager, count); });
+    // The alternative: one TaskManager behind a plain mutex, readers queueing one by one.
+    TaskManager exclusive;
+    fillManager(exclusive, count);
+    mutex exclusiveMutex;
+    // ConcurrentTaskManager::getTask returns a copy; the mutex side copies as well.
+    size_t copiedPriorities = 0;
+
+    // Mostly point reads, every eighth read a keyword search. The writer appends, so cached
+    // results are patched rather than recomputed.
+    const auto sharedRead = [&](mt19937& rng) {
+        const size_t r = rng();
+        if (r % 8 == 0) shared.findTaskIndices(keywords[r / 8 % 4]);
+        else shared.getTask(r % count);
+    };
+    const auto exclusiveRead = [&](mt19937& rng) {
+        const size_t r = rng();
+        lock_guard<mutex> lock(exclusiveMutex);
+        if (r % 8 == 0) exclusive.findTaskIndices(keywords[r / 8 % 4]);
+        else if (r % count < exclusive.getTaskCount()) copiedPriorities += Task(exclusive.getTask(r % count)).priority;
+    };
+    const auto sharedWrite = [&](size_t step) { shared.addTask("Added task " + to_string(step), "01.01.2026", 2); };
+    const auto exclusiveWrite = [&](size_t step) {
+        lock_guard<mutex> lock(exclusiveMutex);
+        exclusive.addTask("Added task " + to_string(step), "01.01.2026", 2);
+    };
+
+    cout << "concurrency: " << count << " tasks, one writer adding tasks, "
+        << thread::hardware_concurrency() << " hardware threads\n";
+    for (const size_t readers : { 1u, 2u, 4u, 8u }) {
+        const auto sharedRate = measureThroughput(readers, sharedRead, sharedWrite);
+        const auto exclusiveRate = measureThroughput(readers, exclusiveRead, exclusiveWrite);
+        cout << "  " << readers << " readers: shared lock " << sharedRate.reads / 1000 << "k reads/s, "
+            << sharedRate.writes << " writes/s; one mutex " << exclusiveRate.reads / 1000 << "k reads/s, "
+            << exclusiveRate.writes << " writes/s\n";
+    }
+    cout << "  (" << copiedPriorities % 10 << ")\n";
+
+    // Uncached scans of the size that goes to the shared pool, from several readers at
+    // once. Each reader's scan is its own batch, so readers should not queue behind one
+    // another.
+    vector<string> titles(count);
+    for (size_t i = 0; i < count; ++i) titles[i] = exclusive.getTask(i).title;
+    atomic<size_t> scanHits{ 0 };
+    const auto poolScan = [&](mt19937& rng) {
+        const string keyword = keywords[rng() % 4];
+        const auto found = ThreadPool::shared().scanChunks<size_t>(count, [&](size_t first, size_t last, vector<size_t>& out) {
+            for (size_t i = first; i < last; ++i) if (titles[i].find(keyword) != string::npos) out.push_back(i);
+        });
+        scanHits += found.size();
+    };
+    cout << "  uncached scans on a " << ThreadPool::shared().size() << "-thread pool:";
+    for (const size_t readers : { 1u, 2u, 4u, 8u }) {
+        const auto rate = measureThroughput(readers, poolScan, [](size_t) {});
+        cout << " " << readers << " readers " << static_cast<size_t>(rate.reads) << " scans/s;";
+    }
+    cout << " (" << scanHits % 10 << ")\n";
+}
+
+// Read latencies, in microseconds, of `readers` threads calling read(rng) until
+// importing() returns, sorted.
+template <class Read, class Import>
+vector<double> readLatenciesDuring(size_t readers, Read&& read, Import&& import) {
+    atomic<bool> running{ true };
+    vector<vector<double>> latencies(readers);
+    vector<thread> threads;
+    for (size_t i = 0; i < readers; ++i) {
+        threads.emplace_back([&, i] {
+            mt19937 rng(static_cast<unsigned>(i + 1));
+            while (running) {
+                const auto start = chrono::steady_clock::now();
+                read(rng);
+                latencies[i].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+            }
+        });
+    }
+    import();
+    running = false;
+    for (auto& thread : threads) thread.join();
+
+    vector<double> all;
+    for (const auto& latency : latencies) all.insert(all.end(), latency.begin(), latency.end());
+    sort(all.begin(), all.end());
+    return all;
+}
+
+void benchSnapshots() {
+    const size_t count = 1000000, imported = 200000, batch = 20000;
+    mt19937 titles(7);
+    vector<Task> incoming;
+    for (size_t i = 0; i < imported; ++i) incoming.push_back({ randomTitle(titles), randomDate(titles), 2, false });
+
+    SnapshotTaskManager snapshots;
+    const double fillMs = measureMs([&] {
+        snapshots.update([&](PersistentTaskList& tasks) {
+            mt19937 rng(1);
+            for (size_t i = 0; i < count; ++i) tasks.pushBack({ randomTitle(rng), randomDate(rng), 1 + static_cast<int>(rng() % 3), false });
+        });
+    }, 1);
+    ConcurrentTaskManager locked;
+    locked.write([&](TaskManager& manager) { fillManager(manager, count); });
+
+    // The import lands in batches, each published as one version or applied under one
+    // write lock.
+    const auto snapshotRead = [&](mt19937& rng) {
+        const auto view = snapshots.snapshot();
+        return view.getTask(rng() % count).priority;
+    };
+    const auto snapshotImport = [&] {
+        for (size_t first = 0; first < imported; first += batch) {
+            snapshots.update([&](PersistentTaskList& tasks) {
+                for (size_t i = first; i < first + batch; ++i) tasks.pushBack(incoming[i]);
+            });
+        }
+    };
+    const auto lockedRead = [&](mt19937& rng) { return locked.getTask(rng() % count)->priority; };
+    const auto lockedImport = [&] {
+        for (size_t first = 0; first < imported; first += batch) {
+            locked.write([&](TaskManager& manager) {
+                for (size_t i = first; i < first + batch; ++i) manager.addTask(incoming[i].title, incoming[i].date, incoming[i].priority);
+            });
+        }
+    };
+
+    const auto report = [](const char* name, const vector<double>& latencies) {
+        const auto at = [&](double share) { return latencies[static_cast<size_t>(share * (latencies.size() - 1))]; };
+        cout << "  " << name << ": " << latencies.size() << " reads, p50 " << at(0.5) << " us, p99 " << at(0.99)
+            << " us, p99.9 " << at(0.999) << " us, max " << latencies.back() << " us\n";
+    };
+    cout << "snapshots: " << count << " tasks (one version built in " << fillMs << " ms), importing " << imported
+        << " in batches of " << batch << " with 2 readers, " << thread::hardware_concurrency() << " hardware threads\n";
+    report("snapshot reads", readLatenciesDuring(2, snapshotRead, snapshotImport));
+    report("shared-lock reads", readLatenciesDuring(2, lockedRead, lockedImport));
+
+    PersistentTaskList before;
+    snapshots.update([&](PersistentTaskList& tasks) { before = tasks; });
+    snapshots.editTask(count / 2, "Edited");
+    const double editUs = measureMs([&] { snapshots.editTask(count / 2, "Edited again"); }) * 1000;
+    cout << "  single edit publishes a version in " << editUs << " us, sharing "
+        << snapshots.snapshot().tasks().sharedChunks(before) << " of " << before.chunkCount() << " chunks\n";
+
+    const auto view = snapshots.snapshot();
+    size_t hits = 0;
+    const double plainMs = measureMs([&] { hits += view.findTaskIndices("milk").size(); });
+    const double foldedMs = measureMs([&] { hits += view.findTaskIndices("MILK", true).size(); });
+    cout << "  snapshot search of " << view.getTaskCount() << " tasks: " << plainMs << " ms, ignoring case "
+        << foldedMs << " ms (" << hits % 10 << ")\n";
+}
+
+void benchTransactions() {
+    const size_t count = 100000, edits = 1000, committers = 4;
+    const string journalFile = (filesystem::temp_directory_path() / "task_manager_bench.journal").string();
+    ConcurrentTaskManager manager;
+    manager.write([&](TaskManager& tasks) { fillManager(tasks, count); });
+    const auto edit = [&](size_t i) { return (i * 7919) % count; };
+
+    cout << "transactions: " << edits << " edits of " << count << " tasks, journal in " << journalFile << "\n";
+    for (const bool journaled : { false, true }) {
+        remove(journalFile.c_str());
+        if (journaled) manager.openJournal(journalFile);
+
+        size_t syncs = manager.journalSyncCount();
+        const double singleMs = measureMs([&] {
+            for (size_t i = 0; i < edits; ++i) manager.editTask(edit(i), "", "", 1 + static_cast<int>(i % 3));
+        }, 1);
+        const size_t singleSyncs = manager.journalSyncCount() - syncs;
+
+        syncs = manager.journalSyncCount();
+        const double batchMs = measureMs([&] {
+            auto transaction = manager.begin();
+            for (size_t i = 0; i < edits; ++i) transaction.editTask(edit(i), "", "", 1 + static_cast<int>(i % 3));
+            transaction.commit();
+        }, 1);
+        const size_t batchSyncs = manager.journalSyncCount() - syncs;
+
+        // Separate committers each waiting for their own edit to be durable.
+        syncs = manager.journalSyncCount();
+        const double groupMs = measureMs([&] {
+            vector<thread> threads;
+            for (size_t t = 0; t < committers; ++t) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = t; i < edits; i += committers) manager.editTask(edit(i), "", "", 2);
+                });
+            }
+            for (auto& thread : threads) thread.join();
+        }, 1);
+        const size_t groupSyncs = manager.journalSyncCount() - syncs;
+
+        if (journaled) manager.closeJournal();
+        cout << "  " << (journaled ? "journaled" : "in memory") << ": one commit per edit " << singleMs << " ms ("
+            << singleSyncs << " syncs), one transaction " << batchMs << " ms (" << batchSyncs << "), "
+            << committers << " threads committing " << groupMs << " ms (" << groupSyncs << ")\n";
+    }
+    remove(journalFile.c_str());
+}
+
+const Suite suites[] = {
+    { "search", benchSearch },
+    { "multisearch", benchMultiKeywordSearch },
+    { "fuzzy", benchFuzzySearch },
+    { "daterange", benchDateRange },
+    { "cache", benchResultCache },
+    { "ranking", benchRanking },
+    { "completion", benchCompletion },
+    { "pagination", benchPagination },
+    { "blocks", benchBlockSkipping },
+    { "regex", benchRegex },
+    { "sort", benchSort },
+    { "radixsort", benchRadixSort },
+    { "views", benchOrderedViews },
+    { "parallelsort", benchParallelSort },
+    { "multikey", benchMultiKeySort },
+    { "indirectsort", benchIndirectSort },
+    { "adaptivesort", benchAdaptiveSort },
+    { "collation", benchCollation },
+    { "concurrency", benchConcurrency },
+    { "snapshots", benchSnapshots },
+    { "transactions", benchTransactions },
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    for (const auto& suite : suites) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) selected = selected || string(argv[i]) == suite.name;
+        if (selected) suite.run();
+    }
+    return 0;
+}
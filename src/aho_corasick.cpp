@@ -0,0 +1,85 @@
+﻿#include "aho_corasick.h"
+#include <queue>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+const uint32_t noState = UINT32_MAX;
+}
+
+AhoCorasick::AhoCorasick(const vector<string>& patternList) : patterns(patternList.size()) {
+    if (patternList.size() > maxPatterns) throw invalid_argument("too many keywords in one query");
+
+    // Bytes that occur in no pattern (and '\0') share class 0, which always leads
+    // back to the root; this keeps the table small enough to stay in cache.
+    byteClass.fill(0);
+    classCount = 1;
+    for (const auto& pattern : patternList) {
+        if (pattern.find('\0') != string::npos) throw invalid_argument("keyword contains a zero byte");
+        for (unsigned char c : pattern) {
+            if (byteClass[c] == 0) byteClass[c] = static_cast<uint8_t>(classCount++);
+        }
+    }
+
+    transitions.assign(classCount, noState);
+    vector<uint64_t> stateOutputs(1, 0);
+    for (size_t i = 0; i < patternList.size(); ++i) {
+        uint32_t state = 0;
+        for (unsigned char c : patternList[i]) {
+            uint32_t& next = transitions[state * classCount + byteClass[c]];
+            if (next == noState) {
+                next = static_cast<uint32_t>(stateOutputs.size());
+                transitions.resize(transitions.size() + classCount, noState);
+                stateOutputs.push_back(0);
+            }
+            state = transitions[state * classCount + byteClass[c]];
+        }
+        stateOutputs[state] |= uint64_t(1) << i;
+        allPatterns |= uint64_t(1) << i;
+    }
+
+    // Breadth-first pass that turns the trie into a complete automaton: missing
+    // edges follow the failure link, and outputs inherit the failure state's output.
+    vector<uint32_t> failure(stateOutputs.size(), 0);
+    queue<uint32_t> pending;
+    for (size_t c = 0; c < classCount; ++c) {
+        uint32_t& next = transitions[c];
+        if (next == noState || c == 0) next = 0;
+        else pending.push(next);
+    }
+    while (!pending.empty()) {
+        const uint32_t state = pending.front();
+        pending.pop();
+        stateOutputs[state] |= stateOutputs[failure[state]];
+        for (size_t c = 0; c < classCount; ++c) {
+            uint32_t& next = transitions[state * classCount + c];
+            const uint32_t fallback = transitions[failure[state] * classCount + c];
+            if (c == 0) next = 0;
+            else if (next == noState) next = fallback;
+            else {
+                failure[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+
+    // Store row offsets instead of state numbers so matching needs no multiplication.
+    for (auto& next : transitions) next *= static_cast<uint32_t>(classCount);
+    outputs.assign(transitions.size(), 0);
+    for (size_t state = 0; state < stateOutputs.size(); ++state) outputs[state * classCount] = stateOutputs[state];
+}
+
+uint64_t AhoCorasick::match(const char* text, size_t size) const {
+    uint64_t hits = outputs[0];
+    uint32_t row = 0;
+    for (size_t i = 0; i < size && hits != allPatterns; ++i) {
+        row = transitions[row + byteClass[static_cast<unsigned char>(text[i])]];
+        hits |= outputs[row];
+    }
+    return hits;
+}
+
+size_t AhoCorasick::patternCount() const {
+    return patterns;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Multi-pattern matcher that finds up to 64 keywords in a single pass over the text.
+// The automaton is fully expanded into a transition table over byte classes, so every
+// input byte costs two table lookups. A '\0' byte restarts matching, which keeps the title
+// and the date of a search record apart.
+class AhoCorasick {
+public:
+    static constexpr size_t maxPatterns = 64;
+
+    explicit AhoCorasick(const vector<string>& patterns);
+
+    // Bit i of the result is set when patterns[i] occurs in the text.
+    uint64_t match(const char* text, size_t size) const;
+    size_t patternCount() const;
+
+private:
+    array<uint8_t, 256> byteClass;
+    size_t classCount = 1;
+    vector<uint32_t> transitions;
+    vector<uint64_t> outputs;
+    uint64_t allPatterns = 0;
+    size_t patterns = 0;
+};
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+
+// How many fixed-size blocks of tasks scans looked at and how many they skipped
+// thanks to a block summary (trigram Bloom filter or zone map).
+struct BlockSkipStats {
+    size_t scanned = 0;
+    size_t skipped = 0;
+
+    double skippedFraction() const {
+        const size_t total = scanned + skipped;
+        return total == 0 ? 0 : static_cast<double>(skipped) / total;
+    }
+};
+
+// BlockSkipStats updated from parallel scan chunks.
+class BlockSkipCounters {
+public:
+    BlockSkipCounters() = default;
+    BlockSkipCounters(const BlockSkipCounters& other) : scanned(other.scanned.load()), skipped(other.skipped.load()) {}
+    BlockSkipCounters& operator=(const BlockSkipCounters& other) {
+        scanned = other.scanned.load();
+        skipped = other.skipped.load();
+        return *this;
+    }
+
+    void record(size_t scannedBlocks, size_t skippedBlocks) {
+        scanned.fetch_add(scannedBlocks, memory_order_relaxed);
+        skipped.fetch_add(skippedBlocks, memory_order_relaxed);
+    }
+
+    BlockSkipStats stats() const {
+        BlockSkipStats result;
+        result.scanned = scanned.load(memory_order_relaxed);
+        result.skipped = skipped.load(memory_order_relaxed);
+        return result;
+    }
+
+private:
+    atomic<size_t> scanned{ 0 };
+    atomic<size_t> skipped{ 0 };
+};
@@ -0,0 +1,117 @@
+﻿#include "case_fold.h"
+
+using namespace std;
+
+namespace {
+
+const char32_t combiningBreve = 0x306;
+const char32_t combiningDiaeresis = 0x308;
+
+// Precomposed letter for a folded base letter followed by a combining mark, or 0.
+char32_t compose(char32_t base, char32_t mark) {
+    if (mark == combiningBreve && base == 0x438) return 0x439;
+    if (mark == combiningDiaeresis && base == 0x435) return 0x451;
+    if (mark == combiningDiaeresis && base == 0x456) return 0x457;
+    return 0;
+}
+
+void appendCodePoint(string& out, char32_t c) {
+    if (c < 0x80) {
+        out += static_cast<char>(c);
+    } else if (c < 0x800) {
+        out += static_cast<char>(0xC0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+}
+
+char32_t foldCodePoint(char32_t c) {
+    if (c < 0x80) return c >= 'A' && c <= 'Z' ? c + 0x20 : c;
+    if (c >= 0xC0 && c <= 0xDE) return c == 0xD7 ? c : c + 0x20;
+    if (c < 0x100) return c;
+    if (c < 0x180) {
+        if (c == 0x178) return 0xFF;
+        // Long s folds to s. Dotted İ has no simple folding (only Turkic rules map it, to
+        // i), so it stays as it is rather than matching dotless ı.
+        if (c == 0x17F) return 's';
+        if (c == 0x130) return c;
+        const bool evenUpper = (c >= 0x100 && c <= 0x137) || (c >= 0x14A && c <= 0x177);
+        const bool oddUpper = (c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E);
+        if ((evenUpper && c % 2 == 0) || (oddUpper && c % 2 == 1)) return c + 1;
+        return c;
+    }
+    if (c >= 0x386 && c <= 0x3A9) {
+        if (c >= 0x391) return c == 0x3A2 ? c : c + 0x20;
+        if (c == 0x386) return 0x3AC;
+        if (c >= 0x388 && c <= 0x38A) return c + 0x25;
+        if (c == 0x38C) return 0x3CC;
+        if (c >= 0x38E) return c + 0x3F;
+        return c;
+    }
+    if (c == 0x3C2) return 0x3C3;
+    if (c >= 0x400 && c <= 0x52F) {
+        if (c < 0x410) return c + 0x50;
+        if (c < 0x430) return c + 0x20;
+        if (c == 0x4C0) return 0x4CF;
+        const bool evenUpper = (c >= 0x460 && c <= 0x481) || (c >= 0x48A && c <= 0x4BF) || c >= 0x4D0;
+        const bool oddUpper = c >= 0x4C1 && c <= 0x4CE;
+        if ((evenUpper && c % 2 == 0) || (oddUpper && c % 2 == 1)) return c + 1;
+    }
+    return c;
+}
+
+string foldCase(string_view text) {
+    string folded;
+    folded.reserve(text.size());
+    appendFolded(folded, text);
+    return folded;
+}
+
+void appendFolded(string& out, string_view text) {
+    // Folding keeps the encoded length of the code points it touches, except that ſ
+    // becomes a one-byte s, and the only code points composed are two-byte letters, so
+    // positions stay simple.
+    char32_t previous = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        const auto lead = static_cast<unsigned char>(text[i]);
+        if (lead < 0x80) {
+            previous = foldCodePoint(lead);
+            out += static_cast<char>(previous);
+            ++i;
+            continue;
+        }
+
+        // Only two- and three-byte sequences can contain foldable code points.
+        const size_t length = (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : 0;
+        bool valid = length != 0 && i + length <= text.size();
+        char32_t c = length == 2 ? lead & 0x1F : lead & 0x0F;
+        for (size_t j = 1; valid && j < length; ++j) {
+            const auto next = static_cast<unsigned char>(text[i + j]);
+            valid = (next & 0xC0) == 0x80;
+            c = (c << 6) | (next & 0x3F);
+        }
+        // Overlong forms are copied as they are rather than re-encoded.
+        valid = valid && c >= (length == 2 ? 0x80u : 0x800u);
+        if (!valid) {
+            previous = 0;
+            out += text[i++];
+            continue;
+        }
+
+        i += length;
+        if (const char32_t composed = compose(previous, c)) {
+            out.resize(out.size() - 2);
+            appendCodePoint(out, composed);
+            previous = composed;
+            continue;
+        }
+        previous = foldCodePoint(c);
+        appendCodePoint(out, previous);
+    }
+}
@@ -0,0 +1,14 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Simple Unicode case folding of UTF-8 text for Latin (ASCII, Latin-1, Latin
+// Extended-A), Greek and Cyrillic, so that "Купить" and "кУПИТЬ" fold to the same
+// bytes. Decomposed й, ё and ї (base letter plus combining mark) are composed.
+// Other code points and invalid bytes are copied unchanged.
+string foldCase(string_view text);
+void appendFolded(string& out, string_view text);
+// Folded form of a single code point, the lower case letter for the covered scripts.
+char32_t foldCodePoint(char32_t c);
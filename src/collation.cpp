@@ -0,0 +1,150 @@
+﻿#include "collation.h"
+#include "case_fold.h"
+#include "permutation.h"
+#include "task_manager.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+const char32_t combiningBreve = 0x306;
+const char32_t combiningDiaeresis = 0x308;
+const char32_t cyrillicI = 0x438;
+const char32_t cyrillicShortI = 0x439;
+const char32_t cyrillicIe = 0x435;
+const char32_t cyrillicIo = 0x451;
+// Stands in for bytes that are not valid UTF-8; sorts after everything else.
+const char32_t invalidCodePoint = 0x10FFFF;
+
+// Accent weights: plain, diaeresis (ё), any other combining mark.
+const char plainAccent = 5;
+const char diaeresisAccent = 6;
+const char otherAccent = 7;
+// Case weights.
+const char lowerCase = 5;
+const char upperCase = 6;
+
+struct Element {
+    uint16_t primary;
+    char accent;
+    char letterCase;
+};
+
+// Every primary weight has a non-zero high byte, so a level cut short by its zero
+// separator sorts before any longer one; the other levels use non-zero bytes for the
+// same reason.
+uint16_t primaryWeight(char32_t folded) {
+    if (folded >= '0' && folded <= '9') return static_cast<uint16_t>(0x200 + (folded - '0'));
+    if (folded >= 'a' && folded <= 'z') return static_cast<uint16_t>(0x600 + (folded - 'a'));
+    if (folded < 0xC0 || folded == 0xD7 || folded == 0xF7) return static_cast<uint16_t>(0x100 + folded);
+    if (folded == cyrillicIo) folded = cyrillicIe;
+    if (folded >= 0x430 && folded <= 0x44F) return static_cast<uint16_t>(0x300 + (folded - 0x430));
+    if (folded >= 0x400 && folded <= 0x52F) return static_cast<uint16_t>(0x400 + (folded - 0x400));
+    if (folded < 0x180) return static_cast<uint16_t>(0x700 + folded);
+    return static_cast<uint16_t>(min<char32_t>(0x1000 + folded, 0xFFFF));
+}
+
+// Decodes the code point at text[i] and moves i past it.
+char32_t decode(string_view text, size_t& i) {
+    const auto lead = static_cast<unsigned char>(text[i]);
+    const size_t length = lead < 0x80 ? 1 : (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : (lead & 0xF8) == 0xF0 ? 4 : 0;
+    if (length == 1) {
+        ++i;
+        return lead;
+    }
+    if (length == 0 || i + length > text.size()) {
+        ++i;
+        return invalidCodePoint;
+    }
+
+    char32_t c = lead & (0x7F >> length);
+    for (size_t j = 1; j < length; ++j) {
+        const auto next = static_cast<unsigned char>(text[i + j]);
+        if ((next & 0xC0) != 0x80) {
+            ++i;
+            return invalidCodePoint;
+        }
+        c = (c << 6) | (next & 0x3F);
+    }
+    i += length;
+    return c;
+}
+
+}
+
+string collationKey(string_view text) {
+    vector<Element> elements;
+    elements.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        const char32_t c = decode(text, i);
+        if (c >= 0x300 && c <= 0x36F && !elements.empty()) {
+            // A combining mark changes the letter before it rather than adding one.
+            auto& letter = elements.back();
+            if (c == combiningBreve && letter.primary == primaryWeight(cyrillicI)) letter.primary = primaryWeight(cyrillicShortI);
+            else if (c == combiningDiaeresis && letter.primary == primaryWeight(cyrillicIe)) letter.accent = diaeresisAccent;
+            else letter.accent = otherAccent;
+            continue;
+        }
+        const char32_t folded = foldCodePoint(c);
+        elements.push_back({ primaryWeight(folded), folded == cyrillicIo ? diaeresisAccent : plainAccent,
+            folded != c ? upperCase : lowerCase });
+    }
+
+    // Trailing plain accents and lower case letters are left out: they carry the lowest
+    // weight of their level, and those levels only compare texts of equal letter count.
+    size_t accents = elements.size(), cases = elements.size();
+    while (accents > 0 && elements[accents - 1].accent == plainAccent) --accents;
+    while (cases > 0 && elements[cases - 1].letterCase == lowerCase) --cases;
+
+    string key;
+    key.reserve(elements.size() * 2 + accents + cases + text.size() + 3);
+    for (const auto& element : elements) {
+        key += static_cast<char>(element.primary >> 8);
+        key += static_cast<char>(element.primary & 0xFF);
+    }
+    key += '\0';
+    for (size_t i = 0; i < accents; ++i) key += elements[i].accent;
+    key += '\0';
+    for (size_t i = 0; i < cases; ++i) key += elements[i].letterCase;
+    key += '\0';
+    key += text;
+    return key;
+}
+
+void CollationKeys::rebuild(const vector<Task>& tasks) {
+    keys.clear();
+    keys.reserve(tasks.size());
+    for (const auto& task : tasks) keys.push_back(collationKey(task.title));
+    valid = true;
+}
+
+void CollationKeys::append(const Task& task) {
+    keys.push_back(collationKey(task.title));
+}
+
+void CollationKeys::update(size_t index, const Task& task) {
+    keys[index] = collationKey(task.title);
+}
+
+void CollationKeys::erase(size_t index) {
+    keys.erase(keys.begin() + index);
+}
+
+void CollationKeys::reorder(vector<uint32_t> order) {
+    applyPermutation(keys, move(order));
+}
+
+void CollationKeys::invalidate() {
+    keys.clear();
+    keys.shrink_to_fit();
+    valid = false;
+}
+
+bool CollationKeys::isValid() const {
+    return valid;
+}
+
+const string& CollationKeys::key(size_t index) const {
+    return keys[index];
+}
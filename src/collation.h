@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+struct Task;
+
+// Binary sort key of UTF-8 text under Russian alphabetical order: comparing two keys
+// bytewise (memcmp, or string's operator<) orders the texts the way the costly locale
+// comparison would, so a sort builds n keys and then compares bytes. Levels, as in the
+// Unicode collation algorithm with the Cyrillic script first:
+//   1. letters regardless of case and accents: punctuation and symbols, digits, the
+//      Russian alphabet (ё as е, й a letter of its own), other Cyrillic, Latin, the rest;
+//   2. accents: е before ё;
+//   3. case: lower case first;
+//   4. the text's own bytes, so that only equal texts have equal keys.
+// Decomposed й and ё (letter plus combining mark) get the keys of the composed letters
+// on the first three levels.
+string collationKey(string_view text);
+
+// Collation keys of all task titles, parallel to the task list. It starts out invalid
+// and is built on first use, as SearchColumn is; after that the owner keeps it in step
+// with the tasks, so a sort by collated title builds no key twice.
+class CollationKeys {
+public:
+    void rebuild(const vector<Task>& tasks);
+    void append(const Task& task);
+    void update(size_t index, const Task& task);
+    void erase(size_t index);
+    // Moves the keys like applyPermutation(tasks, order).
+    void reorder(vector<uint32_t> order);
+    void invalidate();
+    bool isValid() const;
+    const string& key(size_t index) const;
+
+private:
+    vector<string> keys;
+    bool valid = false;
+};
@@ -0,0 +1,94 @@
+﻿#include "completion_bitmap.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+inline size_t lowestSetBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward64(&bit, word);
+    return bit;
+#else
+    return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+}
+
+}
+
+void CompletionBitmap::rebuild(const vector<bool>& completed) {
+    words.assign((completed.size() + 63) / 64, 0);
+    bitCount = 0;
+    setCount = 0;
+    for (bool bit : completed) {
+        if (bit) {
+            words[bitCount / 64] |= uint64_t(1) << (bitCount % 64);
+            ++setCount;
+        }
+        ++bitCount;
+    }
+}
+
+void CompletionBitmap::append(bool completed) {
+    if (bitCount % 64 == 0) words.push_back(0);
+    if (completed) {
+        words[bitCount / 64] |= uint64_t(1) << (bitCount % 64);
+        ++setCount;
+    }
+    ++bitCount;
+}
+
+void CompletionBitmap::set(size_t index) {
+    uint64_t& word = words[index / 64];
+    const uint64_t bit = uint64_t(1) << (index % 64);
+    if (!(word & bit)) {
+        word |= bit;
+        ++setCount;
+    }
+}
+
+void CompletionBitmap::erase(size_t index) {
+    if (test(index)) --setCount;
+
+    const size_t first = index / 64;
+    const uint64_t lowMask = (uint64_t(1) << (index % 64)) - 1;
+    uint64_t& word = words[first];
+    word = (word & lowMask) | ((word >> 1) & ~lowMask);
+    for (size_t i = first + 1; i < words.size(); ++i) {
+        words[i - 1] |= (words[i] & 1) << 63;
+        words[i] >>= 1;
+    }
+
+    --bitCount;
+    if (bitCount % 64 == 0) words.pop_back();
+}
+
+bool CompletionBitmap::test(size_t index) const {
+    return (words[index / 64] >> (index % 64)) & 1;
+}
+
+size_t CompletionBitmap::size() const {
+    return bitCount;
+}
+
+size_t CompletionBitmap::completedCount() const {
+    return setCount;
+}
+
+vector<size_t> CompletionBitmap::indices(bool completed) const {
+    vector<size_t> result;
+    result.reserve(completed ? setCount : bitCount - setCount);
+    for (size_t i = 0; i < words.size(); ++i) {
+        uint64_t word = completed ? words[i] : ~words[i];
+        if (i == words.size() - 1 && bitCount % 64 != 0) word &= (uint64_t(1) << (bitCount % 64)) - 1;
+        while (word != 0) {
+            result.push_back(i * 64 + lowestSetBit(word));
+            word &= word - 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// One bit per task, set when the task is completed, plus a running count of set bits.
+class CompletionBitmap {
+public:
+    void rebuild(const vector<bool>& completed);
+    void append(bool completed);
+    void set(size_t index);
+    // Removes the bit of a deleted task, shifting the following bits down by one.
+    void erase(size_t index);
+
+    bool test(size_t index) const;
+    size_t size() const;
+    size_t completedCount() const;
+    // Indices whose bit equals `completed`, in ascending order.
+    vector<size_t> indices(bool completed) const;
+
+private:
+    vector<uint64_t> words;
+    size_t bitCount = 0;
+    size_t setCount = 0;
+};
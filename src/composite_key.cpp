@@ -0,0 +1,106 @@
+﻿#include "composite_key.h"
+#include "task_manager.h"
+#include "date_key.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// Dates as days; invalid dates get the lowest value, as ByDateAscending orders them.
+constexpr int64_t invalidDate = INT64_MIN;
+
+int64_t dateCode(const Task& task) {
+    const int key = dateKey(task.date);
+    return key ? daysFromDateKey(key) : invalidDate;
+}
+
+int64_t fieldValue(SortField field, const Task& task) {
+    return field == SortField::Priority ? task.priority : dateCode(task);
+}
+
+int bitWidth(uint64_t value) {
+    int bits = 0;
+    for (; value; value >>= 1) ++bits;
+    return bits;
+}
+
+}
+
+bool CompositeOrder::operator()(const Task& a, const Task& b) const {
+    for (const auto& key : keys) {
+        int order = 0;
+        if (key.field == SortField::Title) order = a.title.compare(b.title);
+        else {
+            const int64_t left = fieldValue(key.field, a), right = fieldValue(key.field, b);
+            order = left < right ? -1 : left > right;
+        }
+        if (order) return key.descending ? order > 0 : order < 0;
+    }
+    return false;
+}
+
+CompositeKey::CompositeKey(const vector<Task>& tasks, const vector<SortKey>& keys) : keyCount(keys.size()) {
+    int freeBits = 64;
+    for (const auto& key : keys) {
+        if (key.field == SortField::Title) {
+            // Whole bytes of the title, the rest of the key; always needs the tie check.
+            const int bits = freeBits / 8 * 8;
+            if (bits) fields.push_back({ key.field, key.descending, freeBits - bits, bits, 0, 0 });
+            break;
+        }
+
+        int64_t minimum = INT64_MAX, maximum = INT64_MIN;
+        bool anyInvalid = false;
+        for (const auto& task : tasks) {
+            const int64_t value = fieldValue(key.field, task);
+            if (value == invalidDate) {
+                anyInvalid = true;
+                continue;
+            }
+            minimum = min(minimum, value);
+            maximum = max(maximum, value);
+        }
+        if (minimum > maximum) minimum = maximum = 0;
+        // Invalid dates are packed as the code just below the earliest valid one.
+        if (anyInvalid) --minimum;
+
+        const uint64_t span = static_cast<uint64_t>(maximum - minimum);
+        const int bits = bitWidth(span);
+        if (bits > freeBits) break;
+        ++exactCount;
+        // A field with one value in the whole list orders nothing.
+        if (bits == 0) continue;
+        freeBits -= bits;
+        fields.push_back({ key.field, key.descending, freeBits, bits, minimum, span });
+    }
+}
+
+uint64_t CompositeKey::pack(const Task& task) const {
+    uint64_t packed = 0;
+    for (const auto& field : fields) {
+        uint64_t code = 0;
+        if (field.field == SortField::Title) {
+            // Big-endian bytes, zero padded: shorter titles sort before their extensions.
+            for (int offset = 0; offset < field.bits / 8; ++offset) {
+                const uint64_t byte = offset < static_cast<int>(task.title.size()) ? static_cast<unsigned char>(task.title[offset]) : 0;
+                code = code << 8 | byte;
+            }
+            if (field.descending) code = ~code & (field.bits == 64 ? ~0ull : (1ull << field.bits) - 1);
+        }
+        else {
+            code = static_cast<uint64_t>(max(fieldValue(field.field, task), field.minimum) - field.minimum);
+            if (field.descending) code = field.span - code;
+        }
+        packed |= code << field.shift;
+    }
+    return packed;
+}
+
+size_t CompositeKey::exactKeys() const {
+    return exactCount;
+}
+
+bool CompositeKey::isExact() const {
+    return exactCount == keyCount;
+}
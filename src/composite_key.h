@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+struct Task;
+
+enum class SortField { Priority, Date, Title };
+
+// One level of a multi-field order; dates compare chronologically, titles bytewise.
+struct SortKey {
+    SortField field;
+    bool descending = false;
+};
+
+inline bool operator==(const SortKey& a, const SortKey& b) {
+    return a.field == b.field && a.descending == b.descending;
+}
+
+// Full comparison of two tasks by the keys in turn.
+struct CompositeOrder {
+    const vector<SortKey>& keys;
+
+    bool operator()(const Task& a, const Task& b) const;
+};
+
+// Packs the leading keys of a multi-field order into one 64-bit integer per task, so that
+// a smaller packed key means an earlier task. Priorities and dates take just the bits
+// their range in the list needs; a title takes the bytes left over as a prefix. Equal
+// packed keys need the full CompositeOrder comparison unless isExact().
+class CompositeKey {
+public:
+    CompositeKey(const vector<Task>& tasks, const vector<SortKey>& keys);
+
+    uint64_t pack(const Task& task) const;
+    // Number of leading keys packed whole: tasks with equal packed keys are equal on
+    // those, so ties only need comparing on the remaining keys.
+    size_t exactKeys() const;
+    // True when every key was packed whole, so equal packed keys mean equal tasks.
+    bool isExact() const;
+
+private:
+    struct Field {
+        SortField field;
+        bool descending;
+        int shift;
+        int bits;
+        int64_t minimum;
+        uint64_t span;
+    };
+
+    vector<Field> fields;
+    size_t keyCount = 0;
+    size_t exactCount = 0;
+};
@@ -0,0 +1,246 @@
+﻿#include "concurrent_task_manager.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+const string checkpointPrefix = "checkpoint,";
+
+// Journal record standing for the current tasks: their count and a 64-bit FNV-1a hash
+// of their lines in the task file.
+string checkpointRecord(const TaskManager& manager) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+        for (const char c : formatTaskLine(manager.getTask(i)) + "\n") {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+    }
+    ostringstream record;
+    record << checkpointPrefix << manager.getTaskCount() << "," << hex << hash << "\n";
+    return record.str();
+}
+
+bool isCheckpoint(const string& record) {
+    return record.compare(0, checkpointPrefix.size(), checkpointPrefix) == 0;
+}
+
+}
+
+ConcurrentTaskManager::Transaction::Transaction(ConcurrentTaskManager& owner) : owner(&owner) {}
+
+bool ConcurrentTaskManager::Transaction::commit() {
+    // A journal failure is thrown after the changes were applied, so the buffer is spent
+    // either way; committing it again would apply it twice.
+    try {
+        const bool applied = owner->commit(*this);
+        clear();
+        return applied;
+    }
+    catch (...) {
+        clear();
+        throw;
+    }
+}
+
+void ConcurrentTaskManager::Transaction::rollback() {
+    clear();
+}
+
+ConcurrentTaskManager::Transaction ConcurrentTaskManager::begin() {
+    return Transaction(*this);
+}
+
+void ConcurrentTaskManager::addTask(const string& title, const string& date, int priority) {
+    TaskTransaction change;
+    change.addTask(title, date, priority);
+    commit(change);
+}
+
+bool ConcurrentTaskManager::editTask(size_t index, const string& newTitle, const string& newDate, int newPriority) {
+    TaskTransaction change;
+    change.editTask(index, newTitle, newDate, newPriority);
+    return commit(change);
+}
+
+bool ConcurrentTaskManager::deleteTask(size_t index) {
+    TaskTransaction change;
+    change.deleteTask(index);
+    return commit(change);
+}
+
+bool ConcurrentTaskManager::markCompleted(size_t index) {
+    TaskTransaction change;
+    change.markCompleted(index);
+    return commit(change);
+}
+
+void ConcurrentTaskManager::sortTasks(SortOrder order) {
+    TaskTransaction change;
+    change.sortTasks(order);
+    commit(change);
+}
+
+void ConcurrentTaskManager::sortTasks(const vector<SortKey>& keys) {
+    TaskTransaction change;
+    change.sortTasks(keys);
+    commit(change);
+}
+
+void ConcurrentTaskManager::loadFromFile(const string& filename) {
+    const auto lock = writeLock();
+    if (journal) throw logic_error("cannot replace the tasks while a journal is open");
+    manager.loadFromFile(filename);
+}
+
+void ConcurrentTaskManager::openJournal(const string& filename) {
+    const auto lock = writeLock();
+    auto opened = make_shared<TaskJournal>(filename);
+    const auto& records = opened->recoveredRecords();
+    const string state = checkpointRecord(manager);
+    if (records.empty()) {
+        opened->waitDurable(opened->enqueue(state));
+        journal = move(opened);
+        return;
+    }
+
+    // The journal's first record, or a later one left by a save that crashed before
+    // restarting the journal; replaying from an earlier one would repeat saved changes.
+    const auto start = find(records.rbegin(), records.rend(), state);
+    if (start == records.rend()) throw runtime_error("task journal " + filename + " does not start from these tasks");
+    for (auto record = start.base(); record != records.end(); ++record) {
+        if (isCheckpoint(*record)) continue;
+        const auto transaction = TaskTransaction::parse(*record);
+        if (!transaction.validFor(manager.getTaskCount())) throw runtime_error("task journal " + filename + " does not fit the tasks");
+        transaction.applyTo(manager);
+    }
+    journal = move(opened);
+}
+
+void ConcurrentTaskManager::closeJournal() {
+    // Commits still waiting keep the journal alive until their records are synced.
+    const auto lock = writeLock();
+    journal.reset();
+}
+
+size_t ConcurrentTaskManager::journalSyncCount() const {
+    const auto lock = readLock();
+    return journal ? journal->syncCount() : 0;
+}
+
+bool ConcurrentTaskManager::commit(const TaskTransaction& transaction) {
+    shared_ptr<TaskJournal> log;
+    uint64_t sequence = 0;
+    {
+        const auto lock = writeLock();
+        if (!transaction.validFor(manager.getTaskCount())) return false;
+        if (journal) {
+            log = journal;
+            sequence = log->enqueue(transaction.serialize());
+        }
+        transaction.applyTo(manager);
+    }
+    // Waiting outside the lock lets readers in and lets transactions committed meanwhile
+    // share the sync.
+    if (log) log->waitDurable(sequence);
+    return true;
+}
+
+void ConcurrentTaskManager::saveToFile(const string& filename) const {
+    const auto lock = readLock();
+    if (!journal) {
+        manager.saveToFile(filename);
+        return;
+    }
+
+    // The journal first gets a checkpoint record of the tasks about to be saved, so that
+    // recovery from a crash after the rename but before the restart skips what the file
+    // already holds.
+    lock_guard<mutex> checkpoint(checkpointMutex);
+    const string state = checkpointRecord(manager);
+    journal->waitDurable(journal->enqueue(state));
+
+    const string temporary = filename + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) throw runtime_error("cannot write " + temporary);
+    bool written = true;
+    for (size_t i = 0; i < manager.getTaskCount() && written; ++i) {
+        const string line = formatTaskLine(manager.getTask(i)) + "\n";
+        written = fwrite(line.data(), 1, line.size(), file) == line.size();
+    }
+    written = flushToDisk(file) && written;
+    fclose(file);
+    if (!written) throw runtime_error("cannot write " + temporary);
+    filesystem::rename(temporary, filename);
+    journal->restart(state);
+}
+
+void ConcurrentTaskManager::showTasks() const {
+    const auto lock = readLock();
+    manager.showTasks();
+}
+
+void ConcurrentTaskManager::showTasks(SortOrder order) const {
+    const auto lock = readLock();
+    manager.showTasks(order);
+}
+
+size_t ConcurrentTaskManager::getTaskCount() const {
+    const auto lock = readLock();
+    return manager.getTaskCount();
+}
+
+optional<Task> ConcurrentTaskManager::getTask(size_t index) const {
+    const auto lock = readLock();
+    if (index >= manager.getTaskCount()) return nullopt;
+    return manager.getTask(index);
+}
+
+vector<Task> ConcurrentTaskManager::snapshot() const {
+    const auto lock = readLock();
+    vector<Task> tasks;
+    tasks.reserve(manager.getTaskCount());
+    for (size_t i = 0; i < manager.getTaskCount(); ++i) tasks.push_back(manager.getTask(i));
+    return tasks;
+}
+
+vector<size_t> ConcurrentTaskManager::findTaskIndices(const string& keyword, bool ignoreCase) const {
+    const auto lock = readLock();
+    return manager.findTaskIndices(keyword, ignoreCase);
+}
+
+vector<IndexedTask> ConcurrentTaskManager::findTasks(const string& keyword, bool ignoreCase) const {
+    const auto lock = readLock();
+    vector<IndexedTask> found;
+    for (const size_t index : manager.findTaskIndices(keyword, ignoreCase)) found.push_back({ index, manager.getTask(index) });
+    return found;
+}
+
+vector<size_t> ConcurrentTaskManager::findTaskIndicesMatching(const string& expression, bool ignoreCase) const {
+    const auto lock = readLock();
+    return manager.findTaskIndicesMatching(expression, ignoreCase);
+}
+
+vector<size_t> ConcurrentTaskManager::findTasksByQuery(const string& query) const {
+    const auto lock = readLock();
+    return manager.findTasksByQuery(query);
+}
+
+vector<size_t> ConcurrentTaskManager::topTasks(size_t n, const vector<SortKey>& order, bool includeCompleted) const {
+    const auto lock = readLock();
+    return manager.topTasks(n, order, includeCompleted);
+}
+
+shared_lock<shared_mutex> ConcurrentTaskManager::readLock() const {
+    lock_guard<mutex> turnstile(writerTurnstile);
+    return shared_lock<shared_mutex>(tasksMutex);
+}
+
+unique_lock<shared_mutex> ConcurrentTaskManager::writeLock() {
+    lock_guard<mutex> turnstile(writerTurnstile);
+    return unique_lock<shared_mutex>(tasksMutex);
+}
@@ -0,0 +1,117 @@
+﻿#pragma once
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "task_manager.h"
+#include "task_journal.h"
+#include "task_transaction.h"
+
+using namespace std;
+
+struct IndexedTask {
+    size_t index;
+    Task task;
+};
+
+// TaskManager shared between threads: queries take a shared lock and run side by side,
+// mutations take the exclusive lock. Tasks come back as copies, since a reference into
+// the list could dangle as soon as another thread edits, deletes or sorts; an index is
+// only a hint for the same reason, and getTask returns nullopt once it is out of range.
+//
+// Several changes can be made at once as a transaction: begin() buffers them, and
+// commit() checks that every index fits, then applies them all under one write lock, so
+// readers see either none or all of them, and a transaction that does not fit changes
+// nothing. With a journal open every commit, single changes included, is also written to
+// it as one record and is durable by the time commit returns.
+class ConcurrentTaskManager {
+public:
+    // Buffered changes bound to their manager; dropping it uncommitted rolls it back.
+    class Transaction : public TaskTransaction {
+    public:
+        // Applies the changes and starts over empty; false, with nothing applied, if an
+        // index does not fit. Throws runtime_error if the journal cannot be written, in
+        // which case the changes are applied but not durable, and still starts over empty.
+        bool commit();
+        void rollback();
+
+    private:
+        friend class ConcurrentTaskManager;
+        explicit Transaction(ConcurrentTaskManager& owner);
+
+        ConcurrentTaskManager* owner;
+    };
+
+    Transaction begin();
+
+    void addTask(const string& title, const string& date, int priority);
+    bool editTask(size_t index, const string& newTitle = "", const string& newDate = "", int newPriority = -1);
+    bool deleteTask(size_t index);
+    bool markCompleted(size_t index);
+    void sortTasks(SortOrder order);
+    void sortTasks(const vector<SortKey>& keys);
+    // Throws logic_error while a journal is open, since the journal would no longer fit.
+    void loadFromFile(const string& filename);
+    // With a journal open, saving is a checkpoint: the file is written to a temporary
+    // path, synced and renamed into place, and the journal restarts from the saved tasks.
+    void saveToFile(const string& filename) const;
+
+    void showTasks() const;
+    void showTasks(SortOrder order) const;
+    size_t getTaskCount() const;
+    optional<Task> getTask(size_t index) const;
+    // Copy of all tasks, consistent as of one moment.
+    vector<Task> snapshot() const;
+    vector<size_t> findTaskIndices(const string& keyword, bool ignoreCase = false) const;
+    // Matching tasks with their indices, copied under the same lock as the search.
+    vector<IndexedTask> findTasks(const string& keyword, bool ignoreCase = false) const;
+    vector<size_t> findTaskIndicesMatching(const string& expression, bool ignoreCase = false) const;
+    vector<size_t> findTasksByQuery(const string& query) const;
+    vector<size_t> topTasks(size_t n, const vector<SortKey>& order = mostUrgentFirst, bool includeCompleted = false) const;
+
+    // Runs read(const TaskManager&) under the shared lock, for queries not wrapped above.
+    // Nothing it returns may refer into the manager.
+    template <class Read>
+    auto read(Read&& read) const {
+        const auto lock = readLock();
+        return read(static_cast<const TaskManager&>(manager));
+    }
+
+    // Opens or creates a journal of the changes made from now on. A journal starts from
+    // the tasks it was opened on or last saved with, and remembers a fingerprint of them;
+    // transactions in it after the matching start are replayed, so recovery after a
+    // crash is loading the task file, then opening the journal again. Throws
+    // runtime_error if the journal does not start from the current tasks.
+    void openJournal(const string& filename);
+    void closeJournal();
+    // Syncs of the open journal so far; with group commit, fewer than its commits.
+    size_t journalSyncCount() const;
+
+    // Runs write(TaskManager&) under the exclusive lock, e.g. to fill the list before a
+    // journal is opened. Throws logic_error while a journal is open, since its changes
+    // could not be replayed; use a transaction then.
+    template <class Write>
+    auto write(Write&& write) {
+        const auto lock = writeLock();
+        if (journal) throw logic_error("cannot change the tasks outside a transaction while a journal is open");
+        return write(manager);
+    }
+
+private:
+    bool commit(const TaskTransaction& transaction);
+    shared_lock<shared_mutex> readLock() const;
+    unique_lock<shared_mutex> writeLock();
+
+    mutable shared_mutex tasksMutex;
+    // A writer holds it while waiting for the readers to drain, and new readers pass
+    // through it first, so a steady stream of readers cannot starve writers (glibc's
+    // shared_mutex lets readers in as long as any reader holds it).
+    mutable mutex writerTurnstile;
+    // Serializes saves; the shared lock they hold already keeps commits out.
+    mutable mutex checkpointMutex;
+    TaskManager manager;
+    shared_ptr<TaskJournal> journal;
+};
@@ -0,0 +1,91 @@
+﻿#include "date_key.h"
+#include <cstdio>
+#include <ctime>
+
+using namespace std;
+
+namespace {
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int daysInMonth(int year, int month) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+}
+
+int digit(char c) {
+    return c >= '0' && c <= '9' ? c - '0' : -1;
+}
+
+}
+
+int dateKey(const string& date) {
+    if (date.size() != 10 || date[2] != '.' || date[5] != '.') return 0;
+
+    int value[8];
+    const int positions[8] = { 6, 7, 8, 9, 3, 4, 0, 1 };
+    for (int i = 0; i < 8; ++i) {
+        value[i] = digit(date[positions[i]]);
+        if (value[i] < 0) return 0;
+    }
+
+    const int year = value[0] * 1000 + value[1] * 100 + value[2] * 10 + value[3];
+    const int month = value[4] * 10 + value[5];
+    const int day = value[6] * 10 + value[7];
+    if (year == 0 || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) return 0;
+    return year * 10000 + month * 100 + day;
+}
+
+string formatDateKey(int key) {
+    char text[16];
+    snprintf(text, sizeof(text), "%02d.%02d.%04d", key % 100, key / 100 % 100, key / 10000);
+    return text;
+}
+
+// Days since 01.01.1970, after Howard Hinnant's days_from_civil.
+int daysFromDateKey(int key) {
+    int year = key / 10000;
+    const int month = key / 100 % 100;
+    const int day = key % 100;
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+int dateKeyFromDays(int days) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const int dayOfEra = days - era * 146097;
+    const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int monthIndex = (5 * dayOfYear + 2) / 153;
+    const int day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    const int month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    const int year = yearOfEra + era * 400 + (month <= 2);
+    return year * 10000 + month * 100 + day;
+}
+
+int addDays(int key, int days) {
+    return dateKeyFromDays(daysFromDateKey(key) + days);
+}
+
+int todayDateKey() {
+    const time_t now = time(nullptr);
+    const tm* local = localtime(&now);
+    return (local->tm_year + 1900) * 10000 + (local->tm_mon + 1) * 100 + local->tm_mday;
+}
+
+int weekdayOfDateKey(int key) {
+    // 01.01.1970 was a Thursday.
+    const int days = daysFromDateKey(key);
+    return ((days % 7) + 7 + 3) % 7;
+}
+
+int lastDayOfMonthKey(int key) {
+    return key / 100 * 100 + daysInMonth(key / 10000, key / 100 % 100);
+}
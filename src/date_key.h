@@ -0,0 +1,18 @@
+﻿#pragma once
+#include <string>
+
+using namespace std;
+
+// Dates are stored as "DD.MM.YYYY" strings; a date key packs them as YYYYMMDD so that
+// chronological order is plain integer order. Invalid dates have key 0.
+int dateKey(const string& date);
+string formatDateKey(int key);
+
+int daysFromDateKey(int key);
+int dateKeyFromDays(int days);
+int addDays(int key, int days);
+
+int todayDateKey();
+// 0 = Monday ... 6 = Sunday.
+int weekdayOfDateKey(int key);
+int lastDayOfMonthKey(int key);
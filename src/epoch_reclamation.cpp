@@ -0,0 +1,54 @@
+﻿#include "epoch_reclamation.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+using namespace std;
+
+EpochDomain::Guard::Guard(atomic<uint64_t>* slot) : slot(slot) {}
+
+EpochDomain::Guard::Guard(Guard&& other) noexcept : slot(exchange(other.slot, nullptr)) {}
+
+EpochDomain::Guard& EpochDomain::Guard::operator=(Guard&& other) noexcept {
+    if (this != &other) {
+        if (slot) slot->store(0, memory_order_release);
+        slot = exchange(other.slot, nullptr);
+    }
+    return *this;
+}
+
+EpochDomain::Guard::~Guard() {
+    if (slot) slot->store(0, memory_order_release);
+}
+
+EpochDomain::Guard EpochDomain::pin() {
+    // The epoch may be stale by the time the slot is claimed; an older pin only keeps
+    // more objects alive. Threads start probing at different slots to avoid contention.
+    const uint64_t epoch = globalEpoch.load();
+    for (size_t i = hash<thread::id>()(this_thread::get_id());; ++i) {
+        auto& slot = slots[i % slotCount].epoch;
+        uint64_t free = 0;
+        if (slot.load(memory_order_relaxed) == 0 && slot.compare_exchange_strong(free, epoch)) return Guard(&slot);
+    }
+}
+
+void EpochDomain::retire(shared_ptr<const void> object) {
+    // Objects are unpublished before they are retired, so a reader pinned after the
+    // increment cannot reach this one.
+    retired.push_back({ globalEpoch.fetch_add(1), move(object) });
+}
+
+size_t EpochDomain::collect() {
+    uint64_t oldestPin = UINT64_MAX;
+    for (const auto& slot : slots) {
+        const uint64_t epoch = slot.epoch.load();
+        if (epoch) oldestPin = min(oldestPin, epoch);
+    }
+    retired.erase(remove_if(retired.begin(), retired.end(),
+        [&](const Retired& object) { return object.epoch < oldestPin; }), retired.end());
+    return retired.size();
+}
+
+size_t EpochDomain::pending() const {
+    return retired.size();
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Epoch-based reclamation of objects that lock-free readers may still hold. A reader pins
+// the current epoch while it uses them; a writer that unpublishes an object retires it
+// instead of deleting it, and collect() deletes it once every reader pinned at or before
+// its retirement has unpinned. Pinning is one compare-and-swap on a reader slot and never
+// waits for writers; with more than slotCount pins at once, further pins spin until one
+// is released. retire() and collect() must not run concurrently with each other.
+class EpochDomain {
+public:
+    static constexpr size_t slotCount = 128;
+
+    class Guard {
+    public:
+        Guard(Guard&& other) noexcept;
+        Guard& operator=(Guard&& other) noexcept;
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard();
+
+    private:
+        friend class EpochDomain;
+        explicit Guard(atomic<uint64_t>* slot);
+
+        atomic<uint64_t>* slot;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+    // Deletes everything still retired; no guard may outlive the domain.
+    ~EpochDomain() = default;
+
+    Guard pin();
+    // Takes the last reference to an object no longer reachable by new readers.
+    void retire(shared_ptr<const void> object);
+    // Deletes the retired objects no pinned reader can hold; returns how many remain.
+    size_t collect();
+    size_t pending() const;
+
+private:
+    struct alignas(64) Slot {
+        // Epoch pinned by the reader using the slot, 0 when free.
+        atomic<uint64_t> epoch{ 0 };
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        shared_ptr<const void> object;
+    };
+
+    Slot slots[slotCount];
+    atomic<uint64_t> globalEpoch{ 1 };
+    vector<Retired> retired;
+};
@@ -0,0 +1,105 @@
+﻿#include "fuzzy_search.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+// Decodes one UTF-8 sequence starting at text[i] and advances i; malformed bytes
+// are returned as-is so that they still compare equal to themselves.
+uint32_t nextCodePoint(const char* text, size_t size, size_t& i) {
+    const unsigned char lead = static_cast<unsigned char>(text[i++]);
+    int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    if (extra == 0 || i + extra > size) return lead;
+
+    uint32_t codePoint = lead & (0x3F >> extra);
+    for (int k = 0; k < extra; ++k) {
+        const unsigned char next = static_cast<unsigned char>(text[i + k]);
+        if ((next & 0xC0) != 0x80) return lead;
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    i += extra;
+    return codePoint;
+}
+
+}
+
+FuzzyPattern::FuzzyPattern(const string& pattern) {
+    vector<pair<uint32_t, uint64_t>> nonAscii;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        if (patternLength == maxLength) throw invalid_argument("fuzzy search pattern is longer than 64 characters");
+
+        const uint32_t codePoint = nextCodePoint(pattern.data(), pattern.size(), i);
+        const uint64_t bit = uint64_t(1) << patternLength++;
+        if (codePoint < 128) {
+            asciiMasks[codePoint] |= bit;
+            continue;
+        }
+
+        nonAscii.push_back({ codePoint, bit });
+    }
+
+    // Sorted by code point with the bits of repeated letters merged, so that each text
+    // code point is a binary search over the pattern's distinct ones.
+    sort(nonAscii.begin(), nonAscii.end());
+    size_t distinct = 0;
+    for (const auto& [codePoint, bit] : nonAscii) {
+        if (distinct > 0 && codePoints[distinct - 1] == codePoint) {
+            codePointMasks[distinct - 1] |= bit;
+            continue;
+        }
+        codePoints.push_back(codePoint);
+        codePointMasks.push_back(bit);
+        ++distinct;
+    }
+}
+
+uint64_t FuzzyPattern::equalityMask(uint32_t codePoint) const {
+    if (codePoints.empty() || codePoint < codePoints.front() || codePoint > codePoints.back()) return 0;
+    const auto it = lower_bound(codePoints.begin(), codePoints.end(), codePoint);
+    return *it == codePoint ? codePointMasks[it - codePoints.begin()] : 0;
+}
+
+int FuzzyPattern::distance(const char* text, size_t size) const {
+    if (patternLength == 0) return 0;
+
+    const uint64_t lastBit = uint64_t(1) << (patternLength - 1);
+    uint64_t positive = ~uint64_t(0);
+    uint64_t negative = 0;
+    int score = static_cast<int>(patternLength);
+    int best = score;
+
+    size_t i = 0;
+    while (i < size && best > 0) {
+        const unsigned char byte = static_cast<unsigned char>(text[i]);
+        uint64_t equal;
+        if (byte < 128) {
+            equal = asciiMasks[byte];
+            ++i;
+        }
+        else {
+            equal = equalityMask(nextCodePoint(text, size, i));
+        }
+
+        const uint64_t verticalEqual = equal | negative;
+        const uint64_t horizontalEqual = (((equal & positive) + positive) ^ positive) | equal;
+        uint64_t horizontalPositive = negative | ~(horizontalEqual | positive);
+        uint64_t horizontalNegative = positive & horizontalEqual;
+
+        score += static_cast<int>((horizontalPositive & lastBit) != 0) - static_cast<int>((horizontalNegative & lastBit) != 0);
+        best = min(best, score);
+
+        // The top row of the matrix stays zero: a match may start anywhere in the text.
+        horizontalPositive <<= 1;
+        horizontalNegative <<= 1;
+        positive = horizontalNegative | ~(verticalEqual | horizontalPositive);
+        negative = horizontalPositive & verticalEqual;
+    }
+    return best;
+}
+
+size_t FuzzyPattern::length() const {
+    return patternLength;
+}
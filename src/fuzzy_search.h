@@ -0,0 +1,31 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Approximate substring matcher based on Myers' bit-parallel algorithm: one machine
+// word holds the edit-distance column for up to 64 pattern characters, so each text
+// character costs a handful of word operations. Distances are counted in UTF-8 code
+// points, so a typo in a Cyrillic letter costs 1 rather than 2.
+class FuzzyPattern {
+public:
+    static constexpr size_t maxLength = 64;
+
+    // Throws invalid_argument when the pattern is longer than maxLength code points.
+    explicit FuzzyPattern(const string& pattern);
+
+    // Smallest edit distance between the pattern and any substring of the text.
+    int distance(const char* text, size_t size) const;
+    size_t length() const;
+
+private:
+    uint64_t equalityMask(uint32_t codePoint) const;
+
+    uint64_t asciiMasks[128] = {};
+    // Distinct non-ASCII code points of the pattern in ascending order, with their masks.
+    vector<uint32_t> codePoints;
+    vector<uint64_t> codePointMasks;
+    size_t patternLength = 0;
+};
@@ -0,0 +1,57 @@
+﻿#include "key_index.h"
+#include "task_manager.h"
+#include <algorithm>
+
+using namespace std;
+
+void KeyIndex::rebuild(const vector<Task>& tasks, int (*keyOf)(const Task&)) {
+    buckets.clear();
+    for (size_t i = 0; i < tasks.size(); ++i) buckets[keyOf(tasks[i])].push_back(i);
+}
+
+void KeyIndex::insert(size_t index, int key) {
+    auto& bucket = buckets[key];
+    if (bucket.empty() || bucket.back() < index) bucket.push_back(index);
+    else bucket.insert(lower_bound(bucket.begin(), bucket.end(), index), index);
+}
+
+void KeyIndex::update(size_t index, int oldKey, int newKey) {
+    if (oldKey == newKey) return;
+    remove(index, oldKey);
+    insert(index, newKey);
+}
+
+void KeyIndex::erase(size_t index, int key) {
+    remove(index, key);
+    for (auto& bucket : buckets) {
+        for (auto& entry : bucket.second) {
+            if (entry > index) --entry;
+        }
+    }
+}
+
+vector<size_t> KeyIndex::range(int from, int to) const {
+    vector<size_t> indices;
+    if (from > to) return indices;
+
+    const auto last = buckets.upper_bound(to);
+    for (auto bucket = buckets.lower_bound(from); bucket != last; ++bucket) {
+        indices.insert(indices.end(), bucket->second.begin(), bucket->second.end());
+    }
+    return indices;
+}
+
+size_t KeyIndex::countInRange(int from, int to) const {
+    if (from > to) return 0;
+
+    size_t count = 0;
+    const auto last = buckets.upper_bound(to);
+    for (auto bucket = buckets.lower_bound(from); bucket != last; ++bucket) count += bucket->second.size();
+    return count;
+}
+
+void KeyIndex::remove(size_t index, int key) {
+    auto bucket = buckets.find(key);
+    bucket->second.erase(lower_bound(bucket->second.begin(), bucket->second.end(), index));
+    if (bucket->second.empty()) buckets.erase(bucket);
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <map>
+#include <vector>
+
+using namespace std;
+
+struct Task;
+
+// Task indices grouped by an integer key (date key, priority), kept in order as tasks
+// are added, edited and deleted. Each key owns a sorted list of indices, so appending
+// a task is O(log d) for d distinct keys.
+class KeyIndex {
+public:
+    void rebuild(const vector<Task>& tasks, int (*keyOf)(const Task&));
+    void insert(size_t index, int key);
+    void update(size_t index, int oldKey, int newKey);
+    // Removes the entry of a deleted task and renumbers the tasks that followed it.
+    void erase(size_t index, int key);
+
+    // Indices of tasks with from <= key <= to, in key order.
+    vector<size_t> range(int from, int to) const;
+    size_t countInRange(int from, int to) const;
+
+    // Calls visit(index) for every task in key order, or in reverse key order when
+    // descending; tasks with equal keys come in index order either way.
+    template <class Visit>
+    void forEach(bool descending, Visit&& visit) const {
+        if (descending) {
+            for (auto bucket = buckets.rbegin(); bucket != buckets.rend(); ++bucket) {
+                for (const size_t index : bucket->second) visit(index);
+            }
+        }
+        else {
+            for (const auto& bucket : buckets) {
+                for (const size_t index : bucket.second) visit(index);
+            }
+        }
+    }
+
+private:
+    void remove(size_t index, int key);
+
+    map<int, vector<size_t>> buckets;
+};
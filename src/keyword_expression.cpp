@@ -0,0 +1,206 @@
+﻿#include "keyword_expression.h"
+#include "aho_corasick.h"
+#include "case_fold.h"
+#include <stdexcept>
+
+using namespace std;
+
+class KeywordExpression::Parser {
+public:
+    Parser(const string& text, bool foldKeywords, KeywordExpression& expression)
+        : expression(expression), foldKeywords(foldKeywords) {
+        tokenize(text);
+    }
+
+    size_t parseAll() {
+        if (tokens.empty()) throw invalid_argument("empty search expression");
+        const size_t node = parseOr();
+        if (position != tokens.size()) throw invalid_argument("unexpected '" + tokens[position].text + "'");
+        return node;
+    }
+
+private:
+    struct Token {
+        string text;
+        bool quoted;
+    };
+
+    void tokenize(const string& text) {
+        size_t i = 0;
+        while (i < text.size()) {
+            const char c = text[i];
+            if (c == ' ' || c == '\t') {
+                ++i;
+            }
+            else if (c == '(' || c == ')') {
+                tokens.push_back({ string(1, c), false });
+                ++i;
+            }
+            else if (c == '"') {
+                const size_t close = text.find('"', i + 1);
+                if (close == string::npos) throw invalid_argument("unterminated quote");
+                tokens.push_back({ text.substr(i + 1, close - i - 1), true });
+                i = close + 1;
+            }
+            else {
+                size_t end = i;
+                while (end < text.size() && text[end] != ' ' && text[end] != '\t' && text[end] != '(' && text[end] != ')' && text[end] != '"') ++end;
+                tokens.push_back({ text.substr(i, end - i), false });
+                i = end;
+            }
+        }
+    }
+
+    bool isOperator(const char* name) const {
+        return position < tokens.size() && !tokens[position].quoted && tokens[position].text == name;
+    }
+
+    bool startsOperand() const {
+        return position < tokens.size() && !isOperator("OR") && !isOperator("AND") && !isOperator(")");
+    }
+
+    size_t addKeyword(size_t keyword) {
+        expression.nodes.push_back({ Kind::Keyword, keyword, 0, {} });
+        return expression.nodes.size() - 1;
+    }
+
+    size_t addNot(size_t operand) {
+        expression.nodes.push_back({ Kind::Not, 0, 0, { operand } });
+        return expression.nodes.size() - 1;
+    }
+
+    size_t combine(Kind kind, size_t left, size_t right) {
+        auto& nodes = expression.nodes;
+        if (nodes[left].kind != kind) {
+            nodes.push_back({ kind, 0, 0, {} });
+            addOperand(nodes.size() - 1, left);
+            left = nodes.size() - 1;
+        }
+        addOperand(left, right);
+        return left;
+    }
+
+    void addOperand(size_t node, size_t operand) {
+        auto& nodes = expression.nodes;
+        if (nodes[operand].kind == Kind::Keyword) nodes[node].mask |= uint64_t(1) << nodes[operand].keyword;
+        else nodes[node].children.push_back(operand);
+    }
+
+    size_t parseOr() {
+        size_t node = parseAnd();
+        while (isOperator("OR")) {
+            ++position;
+            node = combine(Kind::Or, node, parseAnd());
+        }
+        return node;
+    }
+
+    size_t parseAnd() {
+        size_t node = parseUnary();
+        while (true) {
+            if (isOperator("AND")) ++position;
+            else if (!startsOperand()) return node;
+            node = combine(Kind::And, node, parseUnary());
+        }
+    }
+
+    size_t parseUnary() {
+        if (position == tokens.size()) throw invalid_argument("search expression ends unexpectedly");
+        if (isOperator("NOT")) {
+            ++position;
+            return addNot(parseUnary());
+        }
+        if (isOperator("(")) {
+            ++position;
+            const size_t node = parseOr();
+            if (!isOperator(")")) throw invalid_argument("missing ')'");
+            ++position;
+            return node;
+        }
+        if (isOperator(")") || isOperator("AND") || isOperator("OR")) {
+            throw invalid_argument("unexpected '" + tokens[position].text + "'");
+        }
+        return addKeyword(keywordIndex(tokens[position++].text));
+    }
+
+    size_t keywordIndex(const string& text) {
+        const string keyword = foldKeywords ? foldCase(text) : text;
+        auto& keywords = expression.keywordList;
+        for (size_t i = 0; i < keywords.size(); ++i) {
+            if (keywords[i] == keyword) return i;
+        }
+        if (keywords.size() == AhoCorasick::maxPatterns) throw invalid_argument("too many keywords in one query");
+        keywords.push_back(keyword);
+        return keywords.size() - 1;
+    }
+
+    KeywordExpression& expression;
+    bool foldKeywords;
+    vector<Token> tokens;
+    size_t position = 0;
+};
+
+KeywordExpression KeywordExpression::parse(const string& text, bool foldKeywords) {
+    KeywordExpression expression;
+    Parser parser(text, foldKeywords, expression);
+    expression.root = parser.parseAll();
+    return expression;
+}
+
+const vector<string>& KeywordExpression::keywords() const {
+    return keywordList;
+}
+
+bool KeywordExpression::evaluate(uint64_t hits) const {
+    return evaluate(root, hits);
+}
+
+bool KeywordExpression::isSingleKeyword() const {
+    return nodes[root].kind == Kind::Keyword;
+}
+
+string KeywordExpression::toString() const {
+    return toString(root);
+}
+
+bool KeywordExpression::evaluate(size_t node, uint64_t hits) const {
+    const Node& current = nodes[node];
+    switch (current.kind) {
+    case Kind::Keyword:
+        return (hits >> current.keyword) & 1;
+    case Kind::Not:
+        return !evaluate(current.children[0], hits);
+    case Kind::And:
+        if ((hits & current.mask) != current.mask) return false;
+        for (size_t child : current.children) {
+            if (!evaluate(child, hits)) return false;
+        }
+        return true;
+    case Kind::Or:
+        if ((hits & current.mask) != 0) return true;
+        for (size_t child : current.children) {
+            if (evaluate(child, hits)) return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+string KeywordExpression::toString(size_t node) const {
+    const Node& current = nodes[node];
+    if (current.kind == Kind::Keyword) return "\"" + keywordList[current.keyword] + "\"";
+    if (current.kind == Kind::Not) return "NOT " + toString(current.children[0]);
+
+    vector<string> operands;
+    for (size_t i = 0; i < keywordList.size(); ++i) {
+        if ((current.mask >> i) & 1) operands.push_back("\"" + keywordList[i] + "\"");
+    }
+    for (size_t child : current.children) operands.push_back(toString(child));
+
+    string text = "(";
+    for (size_t i = 0; i < operands.size(); ++i) {
+        if (i) text += current.kind == Kind::And ? " AND " : " OR ";
+        text += operands[i];
+    }
+    return text + ")";
+}
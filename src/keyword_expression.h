@@ -0,0 +1,43 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Boolean keyword query such as `milk OR bread`, `cat AND feed` or `Buy NOT (milk OR "old bread")`.
+// NOT binds tighter than AND, AND binds tighter than OR, and adjacent terms are joined by AND.
+// Operators are recognised in upper case only; quotes keep spaces and operator words literal.
+class KeywordExpression {
+public:
+    // Throws invalid_argument on syntax errors. With foldKeywords the keywords are
+    // case-folded (see foldCase), operators are still matched in upper case.
+    static KeywordExpression parse(const string& text, bool foldKeywords = false);
+
+    // Distinct keywords of the expression; bit i of a hit mask stands for keywords()[i].
+    const vector<string>& keywords() const;
+    bool evaluate(uint64_t hits) const;
+    bool isSingleKeyword() const;
+    string toString() const;
+
+private:
+    enum class Kind { Keyword, Not, And, Or };
+
+    // AND and OR nodes are n-ary: keyword operands are folded into a bit mask so that
+    // `a OR b OR c` evaluates as a single mask test, other operands stay in children.
+    struct Node {
+        Kind kind;
+        size_t keyword;
+        uint64_t mask;
+        vector<size_t> children;
+    };
+
+    class Parser;
+
+    bool evaluate(size_t node, uint64_t hits) const;
+    string toString(size_t node) const;
+
+    vector<Node> nodes;
+    vector<string> keywordList;
+    size_t root = 0;
+};
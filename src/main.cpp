@@ -1,6 +1,8 @@
 ﻿#include <iostream>
 #include <string>
+#include <stdexcept>
 #include "task_manager.h"
+#include "date_key.h"
 
 using namespace std;
 
@@ -16,16 +18,38 @@ void showMenu() {
     cout << "|       6.Delete task       |\n";
     cout << "|     7.Mark as completed   |\n";
     cout << "|      8.Exit and save      |\n";
+    cout << "|       9.Next tasks        |\n";
     cout << "=============================\n";
     cout << " > ";
 }
 
+// Reads a title; a line ending in '?' lists existing titles with that prefix, and
+// entering the number of a suggestion picks it.
+string readTitle(const TaskManager& manager, const string& prompt) {
+    vector<string> suggestions;
+    string line;
+    while (true) {
+        cout << prompt;
+        getline(cin, line);
+
+        if (!suggestions.empty() && !line.empty() && line.size() < 4 && line.find_first_not_of("0123456789") == string::npos) {
+            const size_t choice = stoul(line);
+            if (choice >= 1 && choice <= suggestions.size()) return suggestions[choice - 1];
+        }
+        if (line.empty() || line.back() != '?') return line;
+
+        line.pop_back();
+        suggestions = manager.suggestTitles(line);
+        if (suggestions.empty()) cout << "No suggestions\n";
+        for (size_t i = 0; i < suggestions.size(); ++i) cout << "  " << i + 1 << ". " << suggestions[i] << "\n";
+    }
+}
+
 void addTask(TaskManager& manager) {
     string title, date;
     int priority;
 
-    cout << "Title: ";
-    getline(cin, title);
+    title = readTitle(manager, "Title (end with ? for suggestions): ");
 
     cout << "Date (DD.MM.YYYY): ";
     getline(cin, date);
@@ -38,28 +62,216 @@ void addTask(TaskManager& manager) {
     cout << "Task added!\n";
 }
 
-void showSortedTasks(TaskManager& manager) {
+void showSortedTasks(const TaskManager& manager) {
     cout << "\nSort tasks\n";
     cout << "1. By priority (^)\n";
     cout << "2. By priority (v)\n";
     cout << "3. By date (^)\n";
     cout << "4. By date (v)\n";
+    cout << "5. By title\n";
+    cout << "6. By title (alphabetical)\n";
     cout << "> ";
 
     int choice;
     cin >> choice;
     cin.ignore();
 
-    switch (choice) {
-    case 1: manager.sortTasks([](const Task& a, const Task& b) { return a.priority < b.priority; }); break;
-    case 2: manager.sortTasks([](const Task& a, const Task& b) { return a.priority > b.priority; }); break;
-    case 3: manager.sortTasks([](const Task& a, const Task& b) { return a.date < b.date; }); break;
-    case 4: manager.sortTasks([](const Task& a, const Task& b) { return a.date > b.date; }); break;
-    default: cout << "Invalid choice!\n"; return;
+    const SortOrder orders[] = { SortOrder::PriorityAscending, SortOrder::PriorityDescending,
+        SortOrder::DateAscending, SortOrder::DateDescending, SortOrder::Title, SortOrder::CollatedTitle };
+    if (choice < 1 || choice > 6) {
+        cout << "Invalid choice!\n";
+        return;
     }
 
+    // Only the display order changes, so task numbers stay valid for editing.
     cout << "\nSorted tasks:\n";
-    manager.showTasks();
+    manager.showTasks(orders[choice - 1]);
+}
+
+// The most urgent open tasks; numbers are task numbers, as in the full list.
+void showNextTasks(const TaskManager& manager) {
+    const auto next = manager.topTasks(10);
+    if (next.empty()) {
+        cout << "Nothing to do!\n";
+        return;
+    }
+
+    cout << "\nNext tasks:\n";
+    for (const size_t index : next) {
+        const auto& task = manager.getTask(index);
+        cout << index + 1 << ". " << task.title << " (" << task.date << ", priority: " << task.priority << ")\n";
+    }
+}
+
+void showFoundTask(const TaskManager& manager, size_t index) {
+    const auto& task = manager.getTask(index);
+    cout << index + 1 << ". " << task.title << " (" << task.date << ")";
+}
+
+void findByKeywords(TaskManager& manager) {
+    string query;
+    cout << "Search (AND, OR, NOT, \"phrase\"): ";
+    getline(cin, query);
+
+    const size_t pageSize = 20;
+    try {
+        auto cursor = manager.searchCursor(query, true);
+        size_t shown = 0;
+        while (true) {
+            const auto page = cursor.next(pageSize);
+            for (auto i : page) {
+                showFoundTask(manager, i);
+                cout << "\n";
+            }
+            shown += page.size();
+            if (page.size() < pageSize || cursor.done()) break;
+
+            string answer;
+            cout << "-- Enter for more, q to stop -- ";
+            getline(cin, answer);
+            if (answer == "q") break;
+        }
+        if (shown == 0) cout << "No tasks found\n";
+    }
+    catch (const invalid_argument& error) {
+        cout << "Invalid search: " << error.what() << "\n";
+    }
+}
+
+void findFuzzy(TaskManager& manager) {
+    string keyword;
+    int maxTypos;
+
+    cout << "Search: ";
+    getline(cin, keyword);
+
+    cout << "Max typos (0-3): ";
+    cin >> maxTypos;
+    cin.ignore();
+
+    vector<FuzzyMatch> matches;
+    try {
+        matches = manager.findTasksFuzzy(keyword, maxTypos);
+    }
+    catch (const invalid_argument& error) {
+        cout << "Invalid search: " << error.what() << "\n";
+        return;
+    }
+
+    if (matches.empty()) {
+        cout << "No tasks found\n";
+        return;
+    }
+    for (const auto& match : matches) {
+        showFoundTask(manager, match.index);
+        cout << " [typos: " << match.distance << "]\n";
+    }
+}
+
+void showDueTasks(const TaskManager& manager, int fromKey, int toKey, bool onlyOpen) {
+    bool found = false;
+    for (auto i : manager.findTasksInRange(formatDateKey(fromKey), formatDateKey(toKey))) {
+        const auto& task = manager.getTask(i);
+        if (onlyOpen && task.completed) continue;
+        cout << i + 1 << ". " << (task.completed ? "[x] " : "[ ] ") << task.title << " (" << task.date << ")\n";
+        found = true;
+    }
+    if (!found) cout << "No tasks found\n";
+}
+
+void findByQuery(TaskManager& manager) {
+    string query;
+    cout << "Query (e.g. priority>=2 completed:no due<01.05.2025 text:\"milk\"; prefix with explain to see the plan): ";
+    getline(cin, query);
+
+    try {
+        if (query.compare(0, 8, "explain ") == 0) {
+            cout << manager.explainQuery(query.substr(8));
+            return;
+        }
+
+        auto indices = manager.findTasksByQuery(query);
+        if (indices.empty()) {
+            cout << "No tasks found\n";
+            return;
+        }
+        for (auto i : indices) {
+            showFoundTask(manager, i);
+            cout << "\n";
+        }
+    }
+    catch (const invalid_argument& error) {
+        cout << "Invalid query: " << error.what() << "\n";
+    }
+}
+
+void findByRegex(TaskManager& manager) {
+    string pattern;
+    cout << "Regex (e.g. ^Buy (milk|bread)): ";
+    getline(cin, pattern);
+
+    try {
+        auto indices = manager.findTasksByRegex(pattern);
+        if (indices.empty()) {
+            cout << "No tasks found\n";
+            return;
+        }
+        for (auto i : indices) {
+            showFoundTask(manager, i);
+            cout << "\n";
+        }
+    }
+    catch (const invalid_argument& error) {
+        cout << "Invalid regex: " << error.what() << "\n";
+    }
+}
+
+void findBestMatches(TaskManager& manager) {
+    const string query = readTitle(manager, "Search (end with ? for suggestions): ");
+
+    auto matches = manager.findTopTasks(query, 10);
+    if (matches.empty()) {
+        cout << "No tasks found\n";
+        return;
+    }
+    for (const auto& match : matches) {
+        showFoundTask(manager, match.index);
+        cout << " [score: " << match.score << "]\n";
+    }
+}
+
+void findTasks(TaskManager& manager) {
+    cout << "\nFind tasks\n";
+    cout << "1. By keywords\n";
+    cout << "2. Fuzzy (with typos)\n";
+    cout << "3. Overdue\n";
+    cout << "4. Due this week\n";
+    cout << "5. Due this month\n";
+    cout << "6. Query\n";
+    cout << "7. Best matches\n";
+    cout << "8. Regex\n";
+    cout << "> ";
+
+    int choice;
+    cin >> choice;
+    cin.ignore();
+
+    const int today = todayDateKey();
+    switch (choice) {
+    case 1: findByKeywords(manager); break;
+    case 2: findFuzzy(manager); break;
+    case 3: showDueTasks(manager, 10101, addDays(today, -1), true); break;
+    case 4: {
+        const int monday = addDays(today, -weekdayOfDateKey(today));
+        showDueTasks(manager, monday, addDays(monday, 6), false);
+        break;
+    }
+    case 5: showDueTasks(manager, today / 100 * 100 + 1, lastDayOfMonthKey(today), false); break;
+    case 6: findByQuery(manager); break;
+    case 7: findBestMatches(manager); break;
+    case 8: findByRegex(manager); break;
+    default: cout << "Invalid choice!\n";
+    }
 }
 
 void editTask(TaskManager& manager) {
@@ -72,8 +284,7 @@ void editTask(TaskManager& manager) {
     string title, date;
     int priority;
 
-    cout << "New title (Enter to keep): ";
-    getline(cin, title);
+    title = readTitle(manager, "New title (Enter to keep, end with ? for suggestions): ");
 
     cout << "New date (Enter to keep): ";
     getline(cin, date);
@@ -101,23 +312,7 @@ int main() {
         case 1: addTask(manager); break;
         case 2: manager.showTasks(); break;
         case 3: showSortedTasks(manager); break;
-        case 4: {
-            string keyword;
-            cout << "Search: ";
-            cin >> keyword;
-
-            auto indices = manager.findTaskIndices(keyword);
-            if (indices.empty()) {
-                cout << "No tasks found\n";
-            }
-            else {
-                for (auto i : indices) {
-                    const auto& task = manager.getTask(i);
-                    cout << i + 1 << ". " << task.title << " (" << task.date << ")\n";
-                }
-            }
-            break;
-        }
+        case 4: findTasks(manager); break;
         case 5: editTask(manager); break;
         case 6: {
             manager.showTasks();
@@ -146,6 +341,7 @@ int main() {
         case 8:
             manager.saveToFile("tasks.txt");
             return 0;
+        case 9: showNextTasks(manager); break;
         default:
             cout << "Invalid choice!\n";
         }
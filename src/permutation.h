@@ -0,0 +1,27 @@
+﻿#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Reorders items so that items[i] becomes the old items[order[i]], in place: the
+// permutation is followed cycle by cycle, so every item is moved once plus one
+// temporary per cycle, and no second copy of the items is allocated.
+template <class Item>
+void applyPermutation(vector<Item>& items, vector<uint32_t> order) {
+    for (size_t start = 0; start < order.size(); ++start) {
+        if (order[start] == start) continue;
+
+        Item carried = move(items[start]);
+        size_t position = start;
+        while (order[position] != start) {
+            const size_t source = order[position];
+            items[position] = move(items[source]);
+            order[position] = static_cast<uint32_t>(position);
+            position = source;
+        }
+        items[position] = move(carried);
+        order[position] = static_cast<uint32_t>(position);
+    }
+}
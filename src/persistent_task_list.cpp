@@ -0,0 +1,163 @@
+﻿#include "persistent_task_list.h"
+#include "case_fold.h"
+#include "search_kernel.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+size_t PersistentTaskList::size() const {
+    return count;
+}
+
+bool PersistentTaskList::empty() const {
+    return count == 0;
+}
+
+const Task& PersistentTaskList::operator[](size_t index) const {
+    const auto [chunk, offset] = locate(index);
+    return chunks[chunk]->tasks[offset];
+}
+
+void PersistentTaskList::pushBack(Task task) {
+    if (chunks.empty() || chunks.back()->tasks.size() == chunkCapacity) {
+        chunks.push_back(make_shared<Chunk>());
+        chunks.back()->tasks.reserve(chunkCapacity);
+        starts.push_back(count);
+    }
+    auto& chunk = writable(chunks.size() - 1);
+    chunk.tasks.push_back(move(task));
+    chunk.append(chunk.tasks.back());
+    ++count;
+}
+
+void PersistentTaskList::set(size_t index, Task task) {
+    if (index >= count) throw out_of_range("task index out of range");
+    const auto [chunk, offset] = locate(index);
+    auto& written = writable(chunk);
+    written.tasks[offset] = move(task);
+    written.refold();
+}
+
+void PersistentTaskList::erase(size_t index) {
+    if (index >= count) throw out_of_range("task index out of range");
+    const auto [chunk, offset] = locate(index);
+    auto& written = writable(chunk);
+    auto& tasks = written.tasks;
+    tasks.erase(tasks.begin() + offset);
+    --count;
+    for (size_t i = chunk + 1; i < starts.size(); ++i) --starts[i];
+
+    // Fold a chunk into its successor once both fit in one, so that deletions cannot
+    // leave a long tail of nearly empty chunks.
+    if (tasks.empty()) {
+        chunks.erase(chunks.begin() + chunk);
+        starts.erase(starts.begin() + chunk);
+    }
+    else {
+        if (chunk + 1 < chunks.size() && tasks.size() + chunks[chunk + 1]->tasks.size() <= chunkCapacity) {
+            const auto& next = chunks[chunk + 1]->tasks;
+            tasks.insert(tasks.end(), next.begin(), next.end());
+            chunks.erase(chunks.begin() + chunk + 1);
+            starts.erase(starts.begin() + chunk + 1);
+        }
+        written.refold();
+    }
+}
+
+void PersistentTaskList::assign(vector<Task> tasks) {
+    chunks.clear();
+    starts.clear();
+    count = 0;
+    for (auto& task : tasks) pushBack(move(task));
+}
+
+vector<Task> PersistentTaskList::toVector() const {
+    vector<Task> tasks;
+    tasks.reserve(count);
+    for (const auto& chunk : chunks) tasks.insert(tasks.end(), chunk->tasks.begin(), chunk->tasks.end());
+    return tasks;
+}
+
+vector<size_t> PersistentTaskList::findTaskIndices(const string& keyword, bool ignoreCase) const {
+    const string pattern = ignoreCase ? foldCase(keyword) : keyword;
+    vector<size_t> found;
+    const auto contains = [&](const string& text) {
+        return findSubstring(text.data(), text.size(), pattern.data(), pattern.size()) != string::npos;
+    };
+    // A keyword with '\0' could match across the record separators, so it is checked
+    // field by field.
+    if (!ignoreCase || pattern.find('\0') != string::npos) {
+        forEach([&](size_t index, const Task& task) {
+            if (ignoreCase ? contains(foldCase(task.title)) || contains(foldCase(task.date))
+                           : contains(task.title) || contains(task.date)) found.push_back(index);
+        });
+        return found;
+    }
+    if (pattern.empty()) {
+        for (size_t i = 0; i < count; ++i) found.push_back(i);
+        return found;
+    }
+
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const auto& chunk = *chunks[c];
+        const size_t end = chunk.folded.size();
+        size_t pos = 0;
+        while (pos < end) {
+            const size_t hit = findSubstring(chunk.folded.data() + pos, end - pos, pattern.data(), pattern.size());
+            if (hit == string::npos) break;
+            const size_t record = upper_bound(chunk.ends.begin(), chunk.ends.end(), pos + hit) - chunk.ends.begin();
+            found.push_back(starts[c] + record);
+            pos = chunk.ends[record];
+        }
+    }
+    return found;
+}
+
+size_t PersistentTaskList::chunkCount() const {
+    return chunks.size();
+}
+
+size_t PersistentTaskList::sharedChunks(const PersistentTaskList& other) const {
+    vector<const Chunk*> mine, theirs;
+    for (const auto& chunk : chunks) mine.push_back(chunk.get());
+    for (const auto& chunk : other.chunks) theirs.push_back(chunk.get());
+    sort(mine.begin(), mine.end());
+    sort(theirs.begin(), theirs.end());
+    vector<const Chunk*> common;
+    set_intersection(mine.begin(), mine.end(), theirs.begin(), theirs.end(), back_inserter(common));
+    return common.size();
+}
+
+pair<size_t, size_t> PersistentTaskList::locate(size_t index) const {
+    const size_t chunk = upper_bound(starts.begin(), starts.end(), index) - starts.begin() - 1;
+    return { chunk, index - starts[chunk] };
+}
+
+PersistentTaskList::Chunk& PersistentTaskList::writable(size_t i) {
+    // Lists share chunks only through copies, and copies are made under the owner's
+    // write lock, so a use count of 1 means no other list can see this chunk.
+    if (chunks[i].use_count() > 1) {
+        auto copy = make_shared<Chunk>();
+        copy->tasks.reserve(chunkCapacity);
+        copy->tasks.assign(chunks[i]->tasks.begin(), chunks[i]->tasks.end());
+        copy->folded = chunks[i]->folded;
+        copy->ends = chunks[i]->ends;
+        chunks[i] = move(copy);
+    }
+    return *chunks[i];
+}
+
+void PersistentTaskList::Chunk::append(const Task& task) {
+    appendFolded(folded, task.title);
+    folded += '\0';
+    appendFolded(folded, task.date);
+    folded += '\0';
+    ends.push_back(static_cast<uint32_t>(folded.size()));
+}
+
+void PersistentTaskList::Chunk::refold() {
+    folded.clear();
+    ends.clear();
+    for (const auto& task : tasks) append(task);
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "task_manager.h"
+
+using namespace std;
+
+// Task list stored as chunks shared between copies. Copying a list copies only the chunk
+// pointers; changing a task copies just its chunk, and only if another list still shares
+// it, so a modified copy costs O(n / chunkCapacity + chunkCapacity) and leaves the
+// original untouched. A list must not be changed while other threads read it, but its
+// copies may be.
+//
+// Each chunk keeps the case-folded titles and dates of its tasks packed in one buffer,
+// refolded whenever the chunk is written, so a case-insensitive search runs the search
+// kernel over the chunks without folding anything.
+class PersistentTaskList {
+public:
+    static constexpr size_t chunkCapacity = 256;
+
+    size_t size() const;
+    bool empty() const;
+    const Task& operator[](size_t index) const;
+
+    template <class Visit>
+    void forEach(Visit&& visit) const {
+        size_t index = 0;
+        for (const auto& chunk : chunks) {
+            for (const auto& task : chunk->tasks) visit(index++, task);
+        }
+    }
+
+    void pushBack(Task task);
+    void set(size_t index, Task task);
+    void erase(size_t index);
+    // Replaces all tasks, packed into full chunks.
+    void assign(vector<Task> tasks);
+    vector<Task> toVector() const;
+    // Indices of the tasks whose title or date contains keyword, as
+    // TaskManager::findTaskIndices.
+    vector<size_t> findTaskIndices(const string& keyword, bool ignoreCase) const;
+
+    size_t chunkCount() const;
+    // Number of chunks also held by other, i.e. not copied since the two diverged.
+    size_t sharedChunks(const PersistentTaskList& other) const;
+
+private:
+    struct Chunk {
+        void append(const Task& task);
+        void refold();
+
+        vector<Task> tasks;
+        // "title\0date\0" records of the tasks, case-folded, and the end of each record.
+        string folded;
+        vector<uint32_t> ends;
+    };
+
+    // Chunk holding the task at index and the task's position in it.
+    pair<size_t, size_t> locate(size_t index) const;
+    // Chunk i, copied first if another list shares it.
+    Chunk& writable(size_t i);
+
+    vector<shared_ptr<Chunk>> chunks;
+    // Index of the first task of each chunk.
+    vector<size_t> starts;
+    size_t count = 0;
+};
@@ -0,0 +1,333 @@
+﻿#include "query_planner.h"
+#include "task_manager.h"
+#include <climits>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// Relative cost of handling one task on each path; a full scan evaluates the whole
+// predicate tree per task, the text scan only runs the SIMD kernel over the buffer.
+const double fullScanCostPerTask = 1.0;
+const double textScanCostPerTask = 0.1;
+const double bitmapCostPerTask = 1.0 / 64;
+const size_t textSampleSize = 1024;
+
+bool satisfies(TaskQuery::Op op, int actual, int value) {
+    switch (op) {
+    case TaskQuery::Op::Equal: return actual == value;
+    case TaskQuery::Op::NotEqual: return actual != value;
+    case TaskQuery::Op::Less: return actual < value;
+    case TaskQuery::Op::LessEqual: return actual <= value;
+    case TaskQuery::Op::Greater: return actual > value;
+    case TaskQuery::Op::GreaterEqual: return actual >= value;
+    }
+    return false;
+}
+
+bool keyRange(const TaskQuery::Predicate& predicate, int& from, int& to) {
+    const int value = predicate.value;
+    const int lowest = predicate.field == TaskQuery::Field::Due ? 1 : INT_MIN;
+    switch (predicate.op) {
+    case TaskQuery::Op::Equal: from = value; to = value; return true;
+    case TaskQuery::Op::Less: from = lowest; to = value == INT_MIN ? INT_MIN : value - 1; return value != INT_MIN;
+    case TaskQuery::Op::LessEqual: from = lowest; to = value; return true;
+    case TaskQuery::Op::Greater: from = value == INT_MAX ? INT_MAX : value + 1; to = INT_MAX; return value != INT_MAX;
+    case TaskQuery::Op::GreaterEqual: from = value; to = INT_MAX; return true;
+    default: return false;
+    }
+}
+
+}
+
+QueryPlanner::QueryPlanner(const TaskManager& manager) : manager(manager) {}
+
+QueryPlanner::Plan QueryPlanner::plan(const TaskQuery& query) const {
+    const double taskCount = static_cast<double>(manager.tasks.size());
+    Plan result;
+    result.fullScanCost = taskCount * fullScanCostPerTask;
+    result.driver = { Access::FullScan, nullptr, 0, 0, taskCount, result.fullScanCost, {} };
+    result.needsFilter = true;
+    result.estimatedResultRows = taskCount * selectivity(query, query.root());
+
+    const auto& root = query.node(query.root());
+    Path candidate;
+    switch (root.kind) {
+    case TaskQuery::Kind::Predicate:
+        if (accessPath(root.predicate, candidate) && candidate.cost < result.driver.cost) {
+            result.driver = candidate;
+            result.needsFilter = false;
+        }
+        break;
+    case TaskQuery::Kind::And:
+        for (size_t child : root.children) {
+            const auto& node = query.node(child);
+            if (node.kind == TaskQuery::Kind::Predicate && accessPath(node.predicate, candidate) && candidate.cost < result.driver.cost) {
+                result.driver = candidate;
+            }
+        }
+        break;
+    case TaskQuery::Kind::Or: {
+        Path unionPath{ Access::IndexUnion, nullptr, 0, 0, 0, 0, {} };
+        bool allIndexed = true;
+        for (size_t child : root.children) {
+            const auto& node = query.node(child);
+            allIndexed = allIndexed && node.kind == TaskQuery::Kind::Predicate && accessPath(node.predicate, candidate);
+            if (!allIndexed) break;
+            unionPath.estimatedRows += candidate.estimatedRows;
+            unionPath.cost += candidate.cost;
+            unionPath.parts.push_back(candidate);
+        }
+        unionPath.estimatedRows = min(unionPath.estimatedRows, taskCount);
+        if (allIndexed && unionPath.cost < result.driver.cost) {
+            result.driver = unionPath;
+            result.needsFilter = false;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return result;
+}
+
+QueryPlanner::Execution QueryPlanner::execute(const TaskQuery& query, const Plan& plan) const {
+    Execution execution;
+    if (plan.driver.access == Access::FullScan) {
+        const auto& zones = manager.zoneMapView();
+        BlockSkipCounters blocks;
+        execution.candidateRows = manager.tasks.size();
+        execution.indices = manager.scanTasks([&](size_t first, size_t last, vector<size_t>& out) {
+            size_t scanned = 0;
+            size_t skipped = 0;
+            for (size_t start = first; start < last;) {
+                const size_t block = start / ZoneMaps::blockTasks;
+                const size_t end = min(last, (block + 1) * ZoneMaps::blockTasks);
+                switch (classify(query, query.root(), zones.zone(block))) {
+                case BlockMatch::None:
+                    ++skipped;
+                    break;
+                case BlockMatch::All:
+                    ++skipped;
+                    for (size_t i = start; i < end; ++i) out.push_back(i);
+                    break;
+                case BlockMatch::Some:
+                    ++scanned;
+                    for (size_t i = start; i < end; ++i) {
+                        if (query.matches(manager.tasks[i])) out.push_back(i);
+                    }
+                    break;
+                }
+                start = end;
+            }
+            blocks.record(scanned, skipped);
+        });
+        execution.blocks = blocks.stats();
+        zones.recordSkips(execution.blocks.scanned, execution.blocks.skipped);
+        return execution;
+    }
+
+    auto candidates = fetch(plan.driver);
+    execution.candidateRows = candidates.size();
+    if (!plan.needsFilter) {
+        execution.indices = move(candidates);
+        return execution;
+    }
+    for (size_t i : candidates) {
+        if (query.matches(manager.tasks[i])) execution.indices.push_back(i);
+    }
+    return execution;
+}
+
+QueryPlanner::BlockMatch QueryPlanner::classify(const TaskQuery& query, size_t node, const ZoneMaps::Zone& zone) {
+    const auto& current = query.node(node);
+    switch (current.kind) {
+    case TaskQuery::Kind::Predicate:
+        return classify(current.predicate, zone);
+    case TaskQuery::Kind::Not: {
+        const auto child = classify(query, current.children[0], zone);
+        return child == BlockMatch::Some ? child : child == BlockMatch::None ? BlockMatch::All : BlockMatch::None;
+    }
+    case TaskQuery::Kind::And:
+    case TaskQuery::Kind::Or: {
+        // For AND, None decides and All is neutral; OR is the mirror image.
+        const bool isAnd = current.kind == TaskQuery::Kind::And;
+        const auto decisive = isAnd ? BlockMatch::None : BlockMatch::All;
+        auto result = isAnd ? BlockMatch::All : BlockMatch::None;
+        for (size_t child : current.children) {
+            const auto match = classify(query, child, zone);
+            if (match == decisive) return decisive;
+            if (match == BlockMatch::Some) result = BlockMatch::Some;
+        }
+        return result;
+    }
+    }
+    return BlockMatch::Some;
+}
+
+QueryPlanner::BlockMatch QueryPlanner::classify(const TaskQuery::Predicate& predicate, const ZoneMaps::Zone& zone) {
+    const auto byCount = [&](size_t matching) {
+        return matching == 0 ? BlockMatch::None : matching == zone.taskCount ? BlockMatch::All : BlockMatch::Some;
+    };
+    // Values known only as a [low, high] range, held by `covered` of the block's tasks.
+    const auto byRange = [&](int low, int high, size_t covered) {
+        int from, to;
+        if (predicate.op == TaskQuery::Op::NotEqual) {
+            if (low == high && low == predicate.value) return BlockMatch::None;
+            if (predicate.value >= low && predicate.value <= high) return BlockMatch::Some;
+        } else {
+            if (!keyRange(predicate, from, to) || high < from || low > to) return BlockMatch::None;
+            if (low < from || high > to) return BlockMatch::Some;
+        }
+        return covered == zone.taskCount ? BlockMatch::All : BlockMatch::Some;
+    };
+
+    switch (predicate.field) {
+    case TaskQuery::Field::Completed:
+        return byCount(predicate.value ? zone.completedCount : zone.taskCount - zone.completedCount);
+    case TaskQuery::Field::Due:
+        // Tasks without a valid date never match a due predicate.
+        return zone.datedCount == 0 ? BlockMatch::None : byRange(zone.minDate, zone.maxDate, zone.datedCount);
+    case TaskQuery::Field::Priority:
+        if (zone.priorityCounts[0] == 0) {
+            size_t matching = 0;
+            for (int priority = 1; priority <= 3; ++priority) {
+                if (satisfies(predicate.op, priority, predicate.value)) matching += zone.priorityCounts[priority];
+            }
+            return byCount(matching);
+        }
+        return byRange(zone.minPriority, zone.maxPriority, zone.taskCount);
+    case TaskQuery::Field::Text:
+        break;
+    }
+    return BlockMatch::Some;
+}
+
+string QueryPlanner::describe(const Path& path) {
+    switch (path.access) {
+    case Access::FullScan: return "full scan";
+    case Access::DateIndex: return "date index range " + TaskQuery::toString(*path.predicate);
+    case Access::PriorityIndex: return "priority index range " + TaskQuery::toString(*path.predicate);
+    case Access::CompletionBitmap: return "completion bitmap " + TaskQuery::toString(*path.predicate);
+    case Access::TextScan: return "text scan " + TaskQuery::toString(*path.predicate);
+    case Access::IndexUnion: {
+        string text = "union of [";
+        for (size_t i = 0; i < path.parts.size(); ++i) {
+            if (i) text += ", ";
+            text += describe(path.parts[i]);
+        }
+        return text + "]";
+    }
+    }
+    return "";
+}
+
+bool QueryPlanner::accessPath(const TaskQuery::Predicate& predicate, Path& path) const {
+    const double taskCount = static_cast<double>(manager.tasks.size());
+    const double lookupCost = log2(taskCount + 2);
+    path = { Access::FullScan, &predicate, 0, 0, predicateRows(predicate), 0, {} };
+
+    switch (predicate.field) {
+    case TaskQuery::Field::Due:
+    case TaskQuery::Field::Priority:
+        if (!keyRange(predicate, path.from, path.to)) return false;
+        path.access = predicate.field == TaskQuery::Field::Due ? Access::DateIndex : Access::PriorityIndex;
+        path.cost = lookupCost + path.estimatedRows;
+        return true;
+    case TaskQuery::Field::Completed:
+        path.access = Access::CompletionBitmap;
+        path.cost = taskCount * bitmapCostPerTask + path.estimatedRows;
+        return true;
+    case TaskQuery::Field::Text:
+        if (predicate.text.find('\0') != string::npos) return false;
+        path.access = Access::TextScan;
+        path.cost = taskCount * textScanCostPerTask + path.estimatedRows;
+        return true;
+    }
+    return false;
+}
+
+double QueryPlanner::selectivity(const TaskQuery& query, size_t node) const {
+    const auto& current = query.node(node);
+    const double taskCount = static_cast<double>(manager.tasks.size());
+    switch (current.kind) {
+    case TaskQuery::Kind::Predicate:
+        return taskCount == 0 ? 0 : predicateRows(current.predicate) / taskCount;
+    case TaskQuery::Kind::Not:
+        return 1 - selectivity(query, current.children[0]);
+    case TaskQuery::Kind::And: {
+        double result = 1;
+        for (size_t child : current.children) result *= selectivity(query, child);
+        return result;
+    }
+    case TaskQuery::Kind::Or: {
+        double none = 1;
+        for (size_t child : current.children) none *= 1 - selectivity(query, child);
+        return 1 - none;
+    }
+    }
+    return 1;
+}
+
+double QueryPlanner::predicateRows(const TaskQuery::Predicate& predicate) const {
+    const size_t taskCount = manager.tasks.size();
+    int from, to;
+    switch (predicate.field) {
+    case TaskQuery::Field::Due:
+    case TaskQuery::Field::Priority: {
+        const auto& index = predicate.field == TaskQuery::Field::Due ? manager.dateIndex : manager.priorityIndex;
+        if (keyRange(predicate, from, to)) return static_cast<double>(index.countInRange(from, to));
+        const int lowest = predicate.field == TaskQuery::Field::Due ? 1 : INT_MIN;
+        return static_cast<double>(index.countInRange(lowest, INT_MAX) - index.countInRange(predicate.value, predicate.value));
+    }
+    case TaskQuery::Field::Completed: {
+        const size_t completed = manager.completion.completedCount();
+        return static_cast<double>(predicate.value ? completed : taskCount - completed);
+    }
+    case TaskQuery::Field::Text: {
+        const size_t samples = min(taskCount, textSampleSize);
+        if (samples == 0) return 0;
+        size_t hits = 0;
+        for (size_t j = 0; j < samples; ++j) {
+            hits += TaskQuery::matches(predicate, manager.tasks[j * taskCount / samples]);
+        }
+        return static_cast<double>(hits) * taskCount / samples;
+    }
+    }
+    return static_cast<double>(taskCount);
+}
+
+vector<size_t> QueryPlanner::fetch(const Path& path) const {
+    vector<size_t> indices;
+    switch (path.access) {
+    case Access::DateIndex:
+        indices = manager.dateIndex.range(path.from, path.to);
+        sort(indices.begin(), indices.end());
+        break;
+    case Access::PriorityIndex:
+        indices = manager.priorityIndex.range(path.from, path.to);
+        sort(indices.begin(), indices.end());
+        break;
+    case Access::CompletionBitmap:
+        indices = manager.completion.indices(path.predicate->value != 0);
+        break;
+    case Access::TextScan:
+        manager.searchColumnView();
+        indices = manager.scanTasks([&](size_t first, size_t last, vector<size_t>& out) {
+            manager.scanKeyword(path.predicate->text, first, last, out);
+        });
+        break;
+    case Access::IndexUnion:
+        for (const auto& part : path.parts) {
+            const auto partIndices = fetch(part);
+            indices.insert(indices.end(), partIndices.begin(), partIndices.end());
+        }
+        sort(indices.begin(), indices.end());
+        indices.erase(unique(indices.begin(), indices.end()), indices.end());
+        break;
+    case Access::FullScan:
+        break;
+    }
+    return indices;
+}
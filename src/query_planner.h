@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "task_query.h"
+#include "zone_map.h"
+
+using namespace std;
+
+class TaskManager;
+
+// Chooses how to evaluate a TaskQuery: through the date or priority index, the
+// completion bitmap, a SIMD text scan, a union of those for OR queries, or a full
+// scan when nothing cheaper applies. Row estimates come from the indexes themselves
+// (exact counts) and from sampling for text predicates. Full scans consult the zone
+// maps first and skip blocks of tasks that cannot match.
+class QueryPlanner {
+public:
+    enum class Access { FullScan, DateIndex, PriorityIndex, CompletionBitmap, TextScan, IndexUnion };
+
+    struct Path {
+        Access access;
+        const TaskQuery::Predicate* predicate;
+        int from;
+        int to;
+        double estimatedRows;
+        double cost;
+        vector<Path> parts;
+    };
+
+    struct Plan {
+        Path driver;
+        bool needsFilter;
+        double estimatedResultRows;
+        double fullScanCost;
+    };
+
+    struct Execution {
+        vector<size_t> indices;
+        size_t candidateRows;
+        // Zone map blocks a full scan evaluated task by task, and blocks it decided
+        // from the summary alone.
+        BlockSkipStats blocks;
+    };
+
+    explicit QueryPlanner(const TaskManager& manager);
+
+    Plan plan(const TaskQuery& query) const;
+    Execution execute(const TaskQuery& query, const Plan& plan) const;
+    static string describe(const Path& path);
+
+private:
+    enum class BlockMatch { None, Some, All };
+
+    static BlockMatch classify(const TaskQuery& query, size_t node, const ZoneMaps::Zone& zone);
+    static BlockMatch classify(const TaskQuery::Predicate& predicate, const ZoneMaps::Zone& zone);
+    bool accessPath(const TaskQuery::Predicate& predicate, Path& path) const;
+    double selectivity(const TaskQuery& query, size_t node) const;
+    double predicateRows(const TaskQuery::Predicate& predicate) const;
+    vector<size_t> fetch(const Path& path) const;
+
+    const TaskManager& manager;
+};
@@ -0,0 +1,118 @@
+﻿#include "radix_sort.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+constexpr int digitBits = 11;
+constexpr uint32_t bucketCount = 1u << digitBits;
+
+template <class Key>
+uint32_t digitOf(Key key, int digit) {
+    return static_cast<uint32_t>(key >> (digitBits * digit)) & (bucketCount - 1);
+}
+
+template <class Key>
+vector<uint32_t> sortOrder(const vector<Key>& keys, vector<Key>* sortedKeys) {
+    constexpr int digitCount = (sizeof(Key) * 8 + digitBits - 1) / digitBits;
+    struct Entry {
+        Key key;
+        uint32_t index;
+    };
+
+    const size_t count = keys.size();
+    vector<uint32_t> histograms(digitCount * bucketCount);
+    for (const Key key : keys) {
+        for (int digit = 0; digit < digitCount; ++digit) ++histograms[digit * bucketCount + digitOf(key, digit)];
+    }
+
+    vector<Entry> entries(count), scratch(count);
+    for (size_t i = 0; i < count; ++i) entries[i] = { keys[i], static_cast<uint32_t>(i) };
+
+    for (int digit = 0; digit < digitCount; ++digit) {
+        uint32_t* offsets = &histograms[digit * bucketCount];
+        if (count == 0 || offsets[digitOf(entries[0].key, digit)] == count) continue;
+
+        uint32_t sum = 0;
+        for (uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+            const uint32_t size = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += size;
+        }
+        for (const Entry& entry : entries) scratch[offsets[digitOf(entry.key, digit)]++] = entry;
+        entries.swap(scratch);
+    }
+
+    vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = entries[i].index;
+    if (sortedKeys) {
+        sortedKeys->resize(count);
+        for (size_t i = 0; i < count; ++i) (*sortedKeys)[i] = entries[i].key;
+    }
+    return order;
+}
+
+// Runs this short cost less to compare than another radix pass with its histograms.
+constexpr size_t comparedRun = 512;
+
+// Bytes [offset, offset + 8) of the key, big-endian, zero past its end.
+uint64_t chunkAt(string_view key, size_t offset) {
+    uint64_t chunk = 0;
+    for (size_t byte = offset; byte < offset + 8; ++byte) {
+        chunk = chunk << 8 | (byte < key.size() ? static_cast<unsigned char>(key[byte]) : 0);
+    }
+    return chunk;
+}
+
+string_view suffix(string_view key, size_t offset) {
+    return key.substr(min(offset, key.size()));
+}
+
+// Sorts order[first, last), whose keys agree on the bytes before offset, stably by the
+// rest of the keys.
+void sortTiedStrings(const vector<string_view>& keys, vector<uint32_t>& order, size_t first, size_t last, size_t offset) {
+    if (last - first <= comparedRun) {
+        stable_sort(order.begin() + first, order.begin() + last, [&](uint32_t a, uint32_t b) {
+            return suffix(keys[a], offset) < suffix(keys[b], offset);
+        });
+        return;
+    }
+
+    vector<uint64_t> chunks(last - first);
+    for (size_t i = 0; i < chunks.size(); ++i) chunks[i] = chunkAt(keys[order[first + i]], offset);
+    const auto runOrder = sortOrder(chunks, &chunks);
+    const vector<uint32_t> unsorted(order.begin() + first, order.begin() + last);
+    for (size_t i = 0; i < runOrder.size(); ++i) order[first + i] = unsorted[runOrder[i]];
+
+    for (size_t run = 0; run < chunks.size();) {
+        size_t runEnd = run + 1;
+        while (runEnd < chunks.size() && chunks[runEnd] == chunks[run]) ++runEnd;
+        if (runEnd - run > 1) {
+            // With equal chunks, a key ending within the chunk is a prefix of the longer
+            // ones: those come first, shortest first, and only the rest read on.
+            const auto begin = order.begin() + first + run, end = order.begin() + first + runEnd;
+            const auto longer = stable_partition(begin, end, [&](uint32_t index) { return keys[index].size() <= offset + 8; });
+            stable_sort(begin, longer, [&](uint32_t a, uint32_t b) { return keys[a].size() < keys[b].size(); });
+            if (end - longer > 1) sortTiedStrings(keys, order, longer - order.begin(), first + runEnd, offset + 8);
+        }
+        run = runEnd;
+    }
+}
+
+}
+
+vector<uint32_t> radixSortOrder(const vector<uint32_t>& keys) {
+    return sortOrder<uint32_t>(keys, nullptr);
+}
+
+vector<uint32_t> radixSortOrder(const vector<uint64_t>& keys, vector<uint64_t>* sortedKeys) {
+    return sortOrder(keys, sortedKeys);
+}
+
+vector<uint32_t> radixSortOrder(const vector<string_view>& keys) {
+    vector<uint32_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    sortTiedStrings(keys, order, 0, order.size(), 0);
+    return order;
+}
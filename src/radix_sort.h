@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "permutation.h"
+
+using namespace std;
+
+// Stable LSD radix sort by 32-bit key: returns the indices 0..n-1 ordered by keys[i],
+// equal keys keeping index order. Sorts in 11-bit digit passes after one histogram
+// pass; a digit that is the same for every key is skipped, so keys spanning a small
+// range (priorities) cost a single counting pass. Expects n < 2^32.
+vector<uint32_t> radixSortOrder(const vector<uint32_t>& keys);
+// Same for 64-bit keys, in up to six passes; sortedKeys, if given, receives the keys in
+// the returned order.
+vector<uint32_t> radixSortOrder(const vector<uint64_t>& keys, vector<uint64_t>* sortedKeys = nullptr);
+// Same for byte strings in string order (bytewise, a prefix first). Sorts by the first
+// 8 bytes as 64-bit keys, then each run still tied by its next 8 bytes, and so on, so
+// shared prefixes are read once per run rather than once per comparison. Short runs
+// are compared directly.
+vector<uint32_t> radixSortOrder(const vector<string_view>& keys);
+
+// Stably reorders items by the 32-bit key keyOf(item), moving each item once.
+template <class Item, class KeyOf>
+void radixSort(vector<Item>& items, KeyOf&& keyOf) {
+    vector<uint32_t> keys(items.size());
+    for (size_t i = 0; i < items.size(); ++i) keys[i] = keyOf(items[i]);
+    applyPermutation(items, radixSortOrder(keys));
+}
@@ -0,0 +1,120 @@
+﻿#include "ranking.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+const double k1 = 1.2;
+const double b = 0.75;
+
+char lowerAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+vector<string> distinctTerms(const string& text) {
+    vector<string> terms;
+    forEachTerm(text, [&](string_view term) {
+        string normalized = normalizeTerm(term);
+        if (find(terms.begin(), terms.end(), normalized) == terms.end()) terms.push_back(move(normalized));
+    });
+    return terms;
+}
+
+size_t termCount(const string& text) {
+    size_t count = 0;
+    forEachTerm(text, [&](string_view) { ++count; });
+    return count;
+}
+
+}
+
+string normalizeTerm(string_view term) {
+    string normalized(term);
+    for (auto& c : normalized) c = lowerAscii(c);
+    return normalized;
+}
+
+bool termEquals(string_view term, const string& normalized) {
+    if (term.size() != normalized.size()) return false;
+    for (size_t i = 0; i < term.size(); ++i) {
+        if (lowerAscii(term[i]) != normalized[i]) return false;
+    }
+    return true;
+}
+
+void TermStatistics::addTitle(const string& title) {
+    for (const auto& term : distinctTerms(title)) ++frequencies[term];
+    totalTerms += termCount(title);
+    ++documents;
+}
+
+void TermStatistics::removeTitle(const string& title) {
+    for (const auto& term : distinctTerms(title)) {
+        auto found = frequencies.find(term);
+        if (--found->second == 0) frequencies.erase(found);
+    }
+    totalTerms -= termCount(title);
+    --documents;
+}
+
+void TermStatistics::clear() {
+    frequencies.clear();
+    documents = 0;
+    totalTerms = 0;
+}
+
+size_t TermStatistics::documentFrequency(const string& term) const {
+    auto found = frequencies.find(term);
+    return found == frequencies.end() ? 0 : found->second;
+}
+
+size_t TermStatistics::documentCount() const {
+    return documents;
+}
+
+double TermStatistics::averageLength() const {
+    return documents == 0 ? 0 : static_cast<double>(totalTerms) / documents;
+}
+
+Bm25Scorer::Bm25Scorer(const string& query, const TermStatistics& statistics)
+    : terms(distinctTerms(query)), averageLength(max(statistics.averageLength(), 1.0)) {
+    if (terms.size() > maxTerms) terms.resize(maxTerms);
+
+    const double documents = static_cast<double>(statistics.documentCount());
+    for (const auto& term : terms) {
+        const double frequency = static_cast<double>(statistics.documentFrequency(term));
+        weights.push_back(log(1 + (documents - frequency + 0.5) / (frequency + 0.5)));
+    }
+}
+
+double Bm25Scorer::score(string_view title) const {
+    unsigned counts[maxTerms] = {};
+    size_t length = 0;
+    bool matched = false;
+
+    forEachTerm(title, [&](string_view term) {
+        ++length;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            if (termEquals(term, terms[i])) {
+                ++counts[i];
+                matched = true;
+                break;
+            }
+        }
+    });
+    if (!matched) return 0;
+
+    const double lengthNorm = k1 * (1 - b + b * static_cast<double>(length) / averageLength);
+    double total = 0;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        const double frequency = counts[i];
+        total += weights[i] * frequency * (k1 + 1) / (frequency + lengthNorm);
+    }
+    return total;
+}
+
+bool Bm25Scorer::empty() const {
+    return terms.empty();
+}
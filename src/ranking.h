@@ -0,0 +1,61 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Calls callback(term) for every term of the text. ASCII letters and digits and all
+// non-ASCII bytes are word characters, everything else separates terms. Terms are
+// views into the text; normalizeTerm() gives the form used for statistics.
+template <class Callback>
+void forEachTerm(string_view text, Callback&& callback) {
+    size_t start = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        const unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        const bool wordChar = c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (wordChar) continue;
+        if (i > start) callback(text.substr(start, i - start));
+        start = i + 1;
+    }
+}
+
+string normalizeTerm(string_view term);
+bool termEquals(string_view term, const string& normalized);
+
+// Document frequencies and lengths of title terms, maintained as titles come and go,
+// so that BM25 scores can be computed in a single pass over the titles.
+class TermStatistics {
+public:
+    void addTitle(const string& title);
+    void removeTitle(const string& title);
+    void clear();
+
+    size_t documentFrequency(const string& term) const;
+    size_t documentCount() const;
+    double averageLength() const;
+
+private:
+    unordered_map<string, size_t> frequencies;
+    size_t documents = 0;
+    size_t totalTerms = 0;
+};
+
+// Okapi BM25 over title terms for a fixed query. Only the first maxTerms distinct
+// query terms are scored.
+class Bm25Scorer {
+public:
+    static constexpr size_t maxTerms = 32;
+
+    Bm25Scorer(const string& query, const TermStatistics& statistics);
+
+    // 0 when the title contains none of the query terms.
+    double score(string_view title) const;
+    bool empty() const;
+
+private:
+    vector<string> terms;
+    vector<double> weights;
+    double averageLength;
+};
@@ -0,0 +1,641 @@
+﻿#include "regex.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+using Ranges = vector<pair<char32_t, char32_t>>;
+
+const uint32_t noState = UINT32_MAX;
+const size_t maxNfaStates = 100000;
+const int maxRepeat = 1000;
+const char32_t maxCodePoint = 0x10FFFF;
+
+void normalize(Ranges& ranges) {
+    sort(ranges.begin(), ranges.end());
+    Ranges merged;
+    for (const auto& range : ranges) {
+        if (!merged.empty() && range.first <= merged.back().second + 1) {
+            merged.back().second = max(merged.back().second, range.second);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    ranges.swap(merged);
+}
+
+Ranges complement(const Ranges& ranges) {
+    Ranges result;
+    char32_t next = 0;
+    for (const auto& range : ranges) {
+        if (range.first > next) result.emplace_back(next, range.first - 1);
+        next = range.second + 1;
+    }
+    if (next <= maxCodePoint) result.emplace_back(next, maxCodePoint);
+    return result;
+}
+
+const Ranges digitRanges = { { '0', '9' } };
+const Ranges spaceRanges = { { '\t', '\r' }, { ' ', ' ' } };
+// ASCII word characters plus Latin, Greek and Cyrillic letters.
+const Ranges wordRanges = { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' },
+    { 0xC0, 0x24F }, { 0x370, 0x3FF }, { 0x400, 0x52F } };
+
+size_t encode(char32_t c, uint8_t* bytes) {
+    if (c < 0x80) {
+        bytes[0] = static_cast<uint8_t>(c);
+        return 1;
+    }
+    if (c < 0x800) {
+        bytes[0] = static_cast<uint8_t>(0xC0 | (c >> 6));
+        bytes[1] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        bytes[0] = static_cast<uint8_t>(0xE0 | (c >> 12));
+        bytes[1] = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+        bytes[2] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        return 3;
+    }
+    bytes[0] = static_cast<uint8_t>(0xF0 | (c >> 18));
+    bytes[1] = static_cast<uint8_t>(0x80 | ((c >> 12) & 0x3F));
+    bytes[2] = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+    bytes[3] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+    return 4;
+}
+
+string encode(char32_t c) {
+    uint8_t bytes[4];
+    const size_t size = encode(c, bytes);
+    return string(reinterpret_cast<const char*>(bytes), size);
+}
+
+// Splits a code point range into sequences of byte ranges that match exactly its UTF-8
+// encodings: ranges are cut at encoded-length boundaries and wherever the continuation
+// bytes of low and high would not cover the full 0x80-0xBF span.
+void utf8Sequences(char32_t low, char32_t high, vector<vector<pair<uint8_t, uint8_t>>>& out) {
+    if (low > high) return;
+    for (const char32_t boundary : { char32_t(0x7F), char32_t(0x7FF), char32_t(0xFFFF) }) {
+        if (low <= boundary && high > boundary) {
+            utf8Sequences(low, boundary, out);
+            utf8Sequences(boundary + 1, high, out);
+            return;
+        }
+    }
+    for (int i = 1; i < 4; ++i) {
+        const char32_t mask = (char32_t(1) << (6 * i)) - 1;
+        if ((low & ~mask) == (high & ~mask)) continue;
+        if ((low & mask) != 0) {
+            utf8Sequences(low, low | mask, out);
+            utf8Sequences((low | mask) + 1, high, out);
+            return;
+        }
+        if ((high & mask) != mask) {
+            utf8Sequences(low, (high & ~mask) - 1, out);
+            utf8Sequences(high & ~mask, high, out);
+            return;
+        }
+    }
+    uint8_t lowBytes[4], highBytes[4];
+    const size_t size = encode(low, lowBytes);
+    encode(high, highBytes);
+    vector<pair<uint8_t, uint8_t>> sequence;
+    for (size_t i = 0; i < size; ++i) sequence.emplace_back(lowBytes[i], highBytes[i]);
+    out.push_back(move(sequence));
+}
+
+}
+
+struct Regex::Node {
+    enum class Kind { Set, Concat, Alternate, Repeat, Begin, End };
+
+    explicit Node(Kind kind) : kind(kind) {}
+
+    Kind kind;
+    Ranges ranges;
+    vector<Node> children;
+    int min = 0;
+    int max = 0;
+
+    bool isLiteral() const {
+        return kind == Kind::Set && ranges.size() == 1 && ranges[0].first == ranges[0].second;
+    }
+};
+
+class Regex::Parser {
+public:
+    explicit Parser(const string& pattern) {
+        size_t i = 0;
+        while (i < pattern.size()) {
+            const auto lead = static_cast<unsigned char>(pattern[i]);
+            const size_t length = lead < 0x80 ? 1 : (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : (lead & 0xF8) == 0xF0 ? 4 : 0;
+            if (length == 0 || i + length > pattern.size()) throw invalid_argument("pattern is not valid UTF-8");
+            char32_t c = length == 1 ? lead : lead & (0x3F >> (length - 1));
+            for (size_t j = 1; j < length; ++j) {
+                const auto next = static_cast<unsigned char>(pattern[i + j]);
+                if ((next & 0xC0) != 0x80) throw invalid_argument("pattern is not valid UTF-8");
+                c = (c << 6) | (next & 0x3F);
+            }
+            text.push_back(c);
+            i += length;
+        }
+    }
+
+    Node parseAll() {
+        Node node = parseAlternate();
+        if (position != text.size()) throw invalid_argument("unmatched ')'");
+        return node;
+    }
+
+private:
+    bool atEnd() const { return position == text.size(); }
+    char32_t peek() const { return text[position]; }
+
+    Node parseAlternate() {
+        Node node{ Node::Kind::Alternate };
+        node.children.push_back(parseConcat());
+        while (!atEnd() && peek() == '|') {
+            ++position;
+            node.children.push_back(parseConcat());
+        }
+        return node.children.size() == 1 ? move(node.children[0]) : move(node);
+    }
+
+    Node parseConcat() {
+        Node node{ Node::Kind::Concat };
+        while (!atEnd() && peek() != '|' && peek() != ')') node.children.push_back(parseRepeat());
+        return node.children.size() == 1 ? move(node.children[0]) : move(node);
+    }
+
+    Node parseRepeat() {
+        Node node = parseAtom();
+        while (!atEnd()) {
+            int low, high;
+            if (peek() == '*') {
+                low = 0;
+                high = -1;
+                ++position;
+            } else if (peek() == '+') {
+                low = 1;
+                high = -1;
+                ++position;
+            } else if (peek() == '?') {
+                low = 0;
+                high = 1;
+                ++position;
+            } else if (peek() != '{' || !parseCounts(low, high)) {
+                break;
+            }
+            if (node.kind == Node::Kind::Begin || node.kind == Node::Kind::End) throw invalid_argument("nothing to repeat");
+            Node repeat{ Node::Kind::Repeat };
+            repeat.min = low;
+            repeat.max = high;
+            repeat.children.push_back(move(node));
+            node = move(repeat);
+        }
+        return node;
+    }
+
+    // {m}, {m,} or {m,n}; anything else leaves the brace to be read as a literal.
+    bool parseCounts(int& low, int& high) {
+        size_t i = position + 1;
+        const auto number = [&](int& value) {
+            const size_t begin = i;
+            value = 0;
+            while (i < text.size() && text[i] >= '0' && text[i] <= '9' && value <= maxRepeat) value = value * 10 + static_cast<int>(text[i++] - '0');
+            return i > begin;
+        };
+        if (!number(low)) return false;
+        high = low;
+        if (i < text.size() && text[i] == ',') {
+            ++i;
+            if (!number(high)) high = -1;
+        }
+        if (i >= text.size() || text[i] != '}') return false;
+        if (low > maxRepeat || high > maxRepeat || (high != -1 && high < low)) throw invalid_argument("bad repetition count");
+        position = i + 1;
+        return true;
+    }
+
+    Node parseAtom() {
+        const char32_t c = text[position++];
+        switch (c) {
+        case '(': {
+            if (position + 1 < text.size() && text[position] == '?' && text[position + 1] == ':') position += 2;
+            Node node = atEnd() || peek() == ')' ? Node{ Node::Kind::Concat } : parseAlternate();
+            if (atEnd() || peek() != ')') throw invalid_argument("missing ')'");
+            ++position;
+            return node;
+        }
+        case ')': throw invalid_argument("unmatched ')'");
+        case '*': case '+': case '?': throw invalid_argument("nothing to repeat");
+        case '^': return Node{ Node::Kind::Begin };
+        case '$': return Node{ Node::Kind::End };
+        case '.': return set({ { 0, maxCodePoint } });
+        case '[': return parseClass();
+        case '\\': {
+            Ranges ranges;
+            if (!parseEscape(ranges)) throw invalid_argument("unsupported escape");
+            return set(ranges);
+        }
+        default: return set({ { c, c } });
+        }
+    }
+
+    Node parseClass() {
+        const bool negated = !atEnd() && peek() == '^';
+        if (negated) ++position;
+        Ranges ranges;
+        bool first = true;
+        while (true) {
+            if (atEnd()) throw invalid_argument("missing ']'");
+            char32_t c = text[position++];
+            if (c == ']' && !first) break;
+            first = false;
+            if (c == '\\') {
+                Ranges escaped;
+                if (!parseEscape(escaped)) throw invalid_argument("unsupported escape");
+                if (escaped.size() != 1 || escaped[0].first != escaped[0].second) {
+                    ranges.insert(ranges.end(), escaped.begin(), escaped.end());
+                    continue;
+                }
+                c = escaped[0].first;
+            }
+            char32_t last = c;
+            if (position + 1 < text.size() && peek() == '-' && text[position + 1] != ']') {
+                position++;
+                last = text[position++];
+                if (last == '\\') {
+                    Ranges escaped;
+                    if (!parseEscape(escaped) || escaped.size() != 1 || escaped[0].first != escaped[0].second)
+                        throw invalid_argument("bad class range");
+                    last = escaped[0].first;
+                }
+                if (last < c) throw invalid_argument("bad class range");
+            }
+            ranges.emplace_back(c, last);
+        }
+        normalize(ranges);
+        return set(negated ? complement(ranges) : ranges);
+    }
+
+    // Reads the character after a backslash.
+    bool parseEscape(Ranges& ranges) {
+        if (atEnd()) throw invalid_argument("trailing backslash");
+        const char32_t c = text[position++];
+        switch (c) {
+        case 'd': ranges = digitRanges; return true;
+        case 'D': ranges = complement(digitRanges); return true;
+        case 's': ranges = spaceRanges; return true;
+        case 'S': ranges = complement(spaceRanges); return true;
+        case 'w': ranges = wordRanges; return true;
+        case 'W': ranges = complement(wordRanges); return true;
+        case 'n': ranges = { { '\n', '\n' } }; return true;
+        case 't': ranges = { { '\t', '\t' } }; return true;
+        default:
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return false;
+            ranges = { { c, c } };
+            return true;
+        }
+    }
+
+    static Node set(Ranges ranges) {
+        Node node{ Node::Kind::Set };
+        normalize(ranges);
+        node.ranges = move(ranges);
+        return node;
+    }
+
+    vector<char32_t> text;
+    size_t position = 0;
+};
+
+Regex::Regex(const string& pattern) : source(pattern) {
+    const Node root = Parser(pattern).parseAll();
+    Fragment whole = compile(root);
+    const uint32_t match = addState(StateType::Match);
+    patch(whole.exits, match);
+    startState = whole.start;
+
+    // Bytes that no range tells apart share a class.
+    array<bool, 257> boundary{};
+    for (const auto& state : states) {
+        if (state.type != StateType::Range) continue;
+        boundary[state.low] = true;
+        boundary[state.high + 1] = true;
+    }
+    for (int b = 0; b < 256; ++b) {
+        if (b > 0 && boundary[b]) ++classCount;
+        byteClass[b] = static_cast<uint8_t>(classCount);
+    }
+    ++classCount;
+
+    analyze(root);
+}
+
+const string& Regex::pattern() const {
+    return source;
+}
+
+const string& Regex::literalPrefix() const {
+    return prefix;
+}
+
+bool Regex::anchoredPrefix() const {
+    return anchored;
+}
+
+const vector<string>& Regex::requiredLiterals() const {
+    return literals;
+}
+
+Regex::Fragment Regex::compile(const Node& node) {
+    switch (node.kind) {
+    case Node::Kind::Set:
+        return compileCodePoints(node.ranges);
+    case Node::Kind::Begin:
+    case Node::Kind::End: {
+        const uint32_t state = addState(node.kind == Node::Kind::Begin ? StateType::Begin : StateType::End);
+        return { state, { state * 2 } };
+    }
+    case Node::Kind::Concat: {
+        if (node.children.empty()) {
+            const uint32_t state = addState(StateType::Split);
+            return { state, { state * 2 } };
+        }
+        Fragment result = compile(node.children[0]);
+        for (size_t i = 1; i < node.children.size(); ++i) result = chain(move(result), compile(node.children[i]));
+        return result;
+    }
+    case Node::Kind::Alternate: {
+        Fragment result = compile(node.children.back());
+        for (size_t i = node.children.size() - 1; i-- > 0;) {
+            Fragment branch = compile(node.children[i]);
+            const uint32_t split = addState(StateType::Split);
+            states[split].out = branch.start;
+            states[split].out1 = result.start;
+            branch.exits.insert(branch.exits.end(), result.exits.begin(), result.exits.end());
+            result = { split, move(branch.exits) };
+        }
+        return result;
+    }
+    case Node::Kind::Repeat: {
+        const Node& child = node.children[0];
+        const uint32_t empty = addState(StateType::Split);
+        Fragment result{ empty, { empty * 2 } };
+        for (int i = 0; i < node.min; ++i) result = chain(move(result), compile(child));
+        if (node.max == -1) {
+            Fragment body = compile(child);
+            const uint32_t loop = addState(StateType::Split);
+            states[loop].out = body.start;
+            patch(body.exits, loop);
+            return chain(move(result), { loop, { loop * 2 + 1 } });
+        }
+        // x{0,k} as (x(x(x)?)?)?, built inside out.
+        Fragment optional{ noState, {} };
+        for (int i = node.min; i < node.max; ++i) {
+            Fragment body = compile(child);
+            const uint32_t split = addState(StateType::Split);
+            states[split].out = body.start;
+            if (optional.start != noState) {
+                patch(body.exits, optional.start);
+                body.exits = optional.exits;
+            }
+            body.exits.push_back(split * 2 + 1);
+            optional = { split, move(body.exits) };
+        }
+        return optional.start == noState ? result : chain(move(result), move(optional));
+    }
+    }
+    throw invalid_argument("unknown regex node");
+}
+
+Regex::Fragment Regex::compileCodePoints(const vector<pair<char32_t, char32_t>>& ranges) {
+    vector<vector<pair<uint8_t, uint8_t>>> sequences;
+    for (const auto& range : ranges) utf8Sequences(range.first, range.second, sequences);
+    if (sequences.empty()) {
+        // An empty class never matches: a range state with no byte leading anywhere.
+        const uint32_t state = addState(StateType::Range, 1, 0);
+        return { state, {} };
+    }
+
+    Fragment result{ noState, {} };
+    for (size_t i = sequences.size(); i-- > 0;) {
+        const auto& sequence = sequences[i];
+        Fragment branch{ noState, {} };
+        for (const auto& bytes : sequence) {
+            const uint32_t state = addState(StateType::Range, bytes.first, bytes.second);
+            branch = branch.start == noState ? Fragment{ state, { state * 2 } } : chain(move(branch), { state, { state * 2 } });
+        }
+        if (result.start == noState) {
+            result = move(branch);
+            continue;
+        }
+        const uint32_t split = addState(StateType::Split);
+        states[split].out = branch.start;
+        states[split].out1 = result.start;
+        branch.exits.insert(branch.exits.end(), result.exits.begin(), result.exits.end());
+        result = { split, move(branch.exits) };
+    }
+    return result;
+}
+
+Regex::Fragment Regex::chain(Fragment first, Fragment second) {
+    patch(first.exits, second.start);
+    return { first.start, move(second.exits) };
+}
+
+uint32_t Regex::addState(StateType type, uint8_t low, uint8_t high) {
+    if (states.size() == maxNfaStates) throw invalid_argument("pattern is too large");
+    states.push_back({ type, low, high, noState, noState });
+    return static_cast<uint32_t>(states.size() - 1);
+}
+
+void Regex::patch(const vector<uint32_t>& exits, uint32_t target) {
+    for (const uint32_t exit : exits) {
+        State& state = states[exit / 2];
+        (exit % 2 ? state.out1 : state.out) = target;
+    }
+}
+
+void Regex::analyze(const Node& root) {
+    const vector<Node> single{ root };
+    const auto& sequence = root.kind == Node::Kind::Concat ? root.children : single;
+
+    // Leading literal run, after an optional ^.
+    size_t i = 0;
+    if (i < sequence.size() && sequence[i].kind == Node::Kind::Begin) {
+        anchored = true;
+        ++i;
+    }
+    for (; i < sequence.size() && sequence[i].isLiteral(); ++i) prefix += encode(sequence[i].ranges[0].first);
+    if (prefix.empty()) anchored = false;
+
+    // Literal runs of the top-level sequence and of groups repeated at least once.
+    string run;
+    const auto flush = [&] {
+        if (!run.empty()) literals.push_back(run);
+        run.clear();
+    };
+    vector<const Node*> pending;
+    for (const auto& node : sequence) pending.push_back(&node);
+    for (size_t j = 0; j < pending.size(); ++j) {
+        const Node& node = *pending[j];
+        if (node.isLiteral()) {
+            run += encode(node.ranges[0].first);
+            continue;
+        }
+        flush();
+        if (node.kind == Node::Kind::Repeat && node.min > 0) {
+            const Node& child = node.children[0];
+            if (child.isLiteral()) {
+                literals.push_back(encode(child.ranges[0].first));
+            } else if (child.kind == Node::Kind::Concat) {
+                string inner;
+                for (const auto& part : child.children) {
+                    if (part.isLiteral()) {
+                        inner += encode(part.ranges[0].first);
+                    } else {
+                        if (!inner.empty()) literals.push_back(inner);
+                        inner.clear();
+                    }
+                }
+                if (!inner.empty()) literals.push_back(inner);
+            }
+        }
+    }
+    flush();
+}
+
+Regex::Matcher::Matcher(const Regex& regex) : regex(regex), marks(regex.states.size(), 0) {
+    reset();
+}
+
+bool Regex::Matcher::search(const char* text, size_t size) {
+    int32_t state = start;
+    if (flags[state]) return flags[state] & matchFlag;
+    const uint32_t stride = regex.classCount;
+    const uint8_t* classes = regex.byteClass.data();
+    // The table and flags only move when a new state is added.
+    const int32_t* transitions = table.data();
+    const uint8_t* stateFlags = flags.data();
+    for (size_t i = 0; i < size; ++i) {
+        const uint32_t byteClass = classes[static_cast<unsigned char>(text[i])];
+        int32_t next = transitions[state * stride + byteClass];
+        if (next < 0) {
+            next = transition(state, byteClass);
+            transitions = table.data();
+            stateFlags = flags.data();
+        }
+        state = next;
+        if (stateFlags[state]) return stateFlags[state] & matchFlag;
+    }
+    return matchesAtEnd(state);
+}
+
+void Regex::Matcher::reset() {
+    ids.clear();
+    sets.clear();
+    table.clear();
+    flags.clear();
+    endMatches.clear();
+    // The start state is the only one reached with ^ satisfied, so it is kept out of
+    // the map and never shared with a later state that has the same NFA states.
+    vector<uint32_t> set;
+    ++generation;
+    closure(regex.startState, true, false, set);
+    sort(set.begin(), set.end());
+    sets.push_back(set);
+    table.assign(regex.classCount, -1);
+    const bool match = any_of(set.begin(), set.end(), [&](uint32_t s) { return regex.states[s].type == StateType::Match; });
+    flags.push_back(match ? matchFlag : set.empty() ? deadFlag : 0);
+    endMatches.push_back(-1);
+    start = 0;
+}
+
+// Adds the states reachable from state through splits and satisfied anchors. Range and
+// Match states end the walk; an End anchor that is not yet satisfied stays in the set.
+void Regex::Matcher::closure(uint32_t state, bool atBegin, bool atEnd, vector<uint32_t>& out) {
+    pending.clear();
+    pending.push_back(state);
+    while (!pending.empty()) {
+        const uint32_t current = pending.back();
+        pending.pop_back();
+        if (current == noState || marks[current] == generation) continue;
+        marks[current] = generation;
+
+        const State& nfaState = regex.states[current];
+        switch (nfaState.type) {
+        case StateType::Split:
+            pending.push_back(nfaState.out1);
+            pending.push_back(nfaState.out);
+            break;
+        case StateType::Begin:
+            if (atBegin) pending.push_back(nfaState.out);
+            break;
+        case StateType::End:
+            if (atEnd) pending.push_back(nfaState.out);
+            else out.push_back(current);
+            break;
+        default:
+            out.push_back(current);
+            break;
+        }
+    }
+}
+
+int32_t Regex::Matcher::addSet(vector<uint32_t> set) {
+    sort(set.begin(), set.end());
+    const auto found = ids.find(set);
+    if (found != ids.end()) return found->second;
+
+    const bool match = any_of(set.begin(), set.end(), [&](uint32_t s) { return regex.states[s].type == StateType::Match; });
+    const auto id = static_cast<int32_t>(sets.size());
+    ids.emplace(set, id);
+    sets.push_back(move(set));
+    table.resize(table.size() + regex.classCount, -1);
+    flags.push_back(match ? matchFlag : sets.back().empty() ? deadFlag : 0);
+    endMatches.push_back(-1);
+    return id;
+}
+
+int32_t Regex::Matcher::transition(int32_t state, uint32_t byteClass) {
+    unsigned byte = 0;
+    while (regex.byteClass[byte] != byteClass) ++byte;
+
+    vector<uint32_t> next;
+    ++generation;
+    for (const uint32_t s : sets[state]) {
+        const State& nfaState = regex.states[s];
+        if (nfaState.type == StateType::Range && byte >= nfaState.low && byte <= nfaState.high) {
+            closure(nfaState.out, false, false, next);
+        }
+    }
+    // Unanchored search: a match may start at every position.
+    closure(regex.startState, false, false, next);
+
+    if (sets.size() >= maxStates) {
+        // The cache is full: start over, keeping only what the caller needs.
+        reset();
+        return addSet(move(next));
+    }
+    const int32_t id = addSet(move(next));
+    table[state * regex.classCount + byteClass] = id;
+    return id;
+}
+
+bool Regex::Matcher::matchesAtEnd(int32_t state) {
+    if (endMatches[state] < 0) {
+        vector<uint32_t> reached;
+        ++generation;
+        for (const uint32_t s : sets[state]) {
+            if (regex.states[s].type == StateType::End) closure(regex.states[s].out, state == start, true, reached);
+        }
+        endMatches[state] = any_of(reached.begin(), reached.end(), [&](uint32_t s) {
+            return regex.states[s].type == StateType::Match;
+        });
+    }
+    return endMatches[state] != 0;
+}
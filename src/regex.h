@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Regular expression for title search, compiled to a Thompson NFA over UTF-8 bytes and
+// run through a lazily built DFA. Supported: literals, `.`, classes such as [a-zа-я]
+// and [^0-9] (code point ranges), \d \w \s and their negations, ^ $ anchors, groups,
+// `|`, and the quantifiers * + ? {m} {m,} {m,n}. Matching is a search: the pattern may
+// match anywhere in the text unless anchored.
+class Regex {
+public:
+    class Matcher;
+
+    // Throws invalid_argument on syntax errors and patterns that compile too large.
+    explicit Regex(const string& pattern);
+
+    const string& pattern() const;
+    // Literal every match starts with, and whether it is anchored to the text start.
+    const string& literalPrefix() const;
+    bool anchoredPrefix() const;
+    // Literals that occur in every matching text, for index-based prefiltering.
+    const vector<string>& requiredLiterals() const;
+
+private:
+    struct Node;
+    class Parser;
+
+    enum class StateType : uint8_t { Range, Split, Begin, End, Match };
+
+    struct State {
+        StateType type;
+        uint8_t low;
+        uint8_t high;
+        uint32_t out;
+        uint32_t out1;
+    };
+
+    struct Fragment {
+        uint32_t start;
+        // Dangling exits as state * 2 + (0 for out, 1 for out1).
+        vector<uint32_t> exits;
+    };
+
+    Fragment compile(const Node& node);
+    Fragment compileCodePoints(const vector<pair<char32_t, char32_t>>& ranges);
+    Fragment chain(Fragment first, Fragment second);
+    uint32_t addState(StateType type, uint8_t low = 0, uint8_t high = 0);
+    void patch(const vector<uint32_t>& exits, uint32_t target);
+    void analyze(const Node& root);
+
+    string source;
+    vector<State> states;
+    uint32_t startState = 0;
+    array<uint8_t, 256> byteClass{};
+    uint32_t classCount = 0;
+    string prefix;
+    bool anchored = false;
+    vector<string> literals;
+};
+
+// Lazy DFA over one Regex: states are sets of NFA states, created as the input first
+// reaches them and cached in a table indexed by byte class. Not thread-safe; use one
+// matcher per thread.
+class Regex::Matcher {
+public:
+    explicit Matcher(const Regex& regex);
+
+    bool search(const char* text, size_t size);
+
+private:
+    static constexpr size_t maxStates = 4096;
+    static constexpr uint8_t matchFlag = 1;
+    static constexpr uint8_t deadFlag = 2;
+
+    void reset();
+    void closure(uint32_t state, bool atBegin, bool atEnd, vector<uint32_t>& out);
+    int32_t addSet(vector<uint32_t> set);
+    int32_t transition(int32_t state, uint32_t byteClass);
+    bool matchesAtEnd(int32_t state);
+
+    const Regex& regex;
+    map<vector<uint32_t>, int32_t> ids;
+    vector<vector<uint32_t>> sets;
+    vector<int32_t> table;
+    vector<uint8_t> flags;
+    vector<int8_t> endMatches;
+    int32_t start = 0;
+    vector<uint32_t> marks;
+    uint32_t generation = 0;
+    vector<uint32_t> pending;
+};
@@ -0,0 +1,57 @@
+﻿#include "result_cache.h"
+
+using namespace std;
+
+double ResultCacheStats::hitRate() const {
+    const size_t lookups = hits + patches + misses;
+    return lookups == 0 ? 0 : static_cast<double>(hits + patches) / lookups;
+}
+
+ResultCache::ResultCache(size_t capacity) : capacity(capacity) {}
+
+ResultCache::Entry* ResultCache::find(const string& key) {
+    auto found = lookup.find(key);
+    if (found == lookup.end()) return nullptr;
+    items.splice(items.begin(), items, found->second);
+    return &found->second->second;
+}
+
+void ResultCache::store(const string& key, Entry entry) {
+    if (capacity == 0) return;
+
+    auto found = lookup.find(key);
+    if (found != lookup.end()) {
+        found->second->second = move(entry);
+        items.splice(items.begin(), items, found->second);
+        return;
+    }
+    items.emplace_front(key, move(entry));
+    lookup.emplace(key, items.begin());
+    evictOverflow();
+}
+
+void ResultCache::setCapacity(size_t newCapacity) {
+    capacity = newCapacity;
+    evictOverflow();
+}
+
+void ResultCache::clear() {
+    items.clear();
+    lookup.clear();
+}
+
+ResultCacheStats& ResultCache::stats() {
+    return counters;
+}
+
+const ResultCacheStats& ResultCache::stats() const {
+    return counters;
+}
+
+void ResultCache::evictOverflow() {
+    while (items.size() > capacity) {
+        lookup.erase(items.back().first);
+        items.pop_back();
+        ++counters.evictions;
+    }
+}
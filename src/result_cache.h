@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+struct ResultCacheStats {
+    size_t hits = 0;
+    size_t patches = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+    // Share of lookups answered without a full rescan (hits and patched entries).
+    double hitRate() const;
+};
+
+// LRU cache of search results keyed by the normalized query. Every entry remembers
+// the mutation epoch and task count it was computed at, so the owner can tell a fresh
+// entry from one that only needs the appended tasks scanned.
+class ResultCache {
+public:
+    struct Entry {
+        vector<size_t> indices;
+        uint64_t epoch;
+        size_t taskCount;
+    };
+
+    explicit ResultCache(size_t capacity = 32);
+
+    // Returns the entry and marks it most recently used, or nullptr.
+    Entry* find(const string& key);
+    void store(const string& key, Entry entry);
+    void setCapacity(size_t capacity);
+    void clear();
+
+    ResultCacheStats& stats();
+    const ResultCacheStats& stats() const;
+
+private:
+    using Item = pair<string, Entry>;
+
+    void evictOverflow();
+
+    list<Item> items;
+    unordered_map<string, list<Item>::iterator> lookup;
+    size_t capacity;
+    ResultCacheStats counters;
+};
@@ -0,0 +1,207 @@
+﻿#include "search_column.h"
+#include "search_kernel.h"
+#include "task_manager.h"
+#include "case_fold.h"
+#include "regex.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+
+// Two filter bits per trigram, taken from one 64-bit multiplicative hash.
+void trigramBits(const char* bytes, uint32_t& first, uint32_t& second) {
+    const uint64_t trigram = static_cast<unsigned char>(bytes[0]) | static_cast<unsigned char>(bytes[1]) << 8
+        | static_cast<uint64_t>(static_cast<unsigned char>(bytes[2])) << 16;
+    const uint64_t hash = trigram * 0x9E3779B97F4A7C15ull;
+    first = static_cast<uint32_t>(hash >> 48);
+    second = static_cast<uint32_t>(hash >> 32) & 0xFFFF;
+}
+
+}
+
+SearchColumn::SearchColumn(bool folded) : folded(folded), valid(!folded) {
+}
+
+void SearchColumn::rebuild(const vector<Task>& tasks) {
+    size_t bytes = 0;
+    for (const auto& task : tasks) bytes += task.title.size() + task.date.size() + 2;
+
+    data.clear();
+    data.reserve(bytes);
+    offsets.assign(1, 0);
+    offsets.reserve(tasks.size() + 1);
+    blooms.clear();
+    blooms.reserve((tasks.size() + blockRecords - 1) / blockRecords * bloomWords);
+    valid = true;
+    for (const auto& task : tasks) append(task);
+}
+
+void SearchColumn::append(const Task& task) {
+    if (recordCount() % blockRecords == 0) blooms.resize(blooms.size() + bloomWords);
+    const size_t start = data.size();
+    if (folded) {
+        appendFolded(data, task.title);
+        data += '\0';
+        appendFolded(data, task.date);
+    } else {
+        data += task.title;
+        data += '\0';
+        data += task.date;
+    }
+    data += '\0';
+    offsets.push_back(data.size());
+    addTrigrams(start, data.size());
+}
+
+void SearchColumn::invalidate() {
+    valid = false;
+}
+
+bool SearchColumn::isValid() const {
+    return valid;
+}
+
+size_t SearchColumn::recordCount() const {
+    return offsets.size() - 1;
+}
+
+string_view SearchColumn::record(size_t index) const {
+    return string_view(data.data() + offsets[index], offsets[index + 1] - offsets[index]);
+}
+
+string_view SearchColumn::title(size_t index) const {
+    const auto whole = record(index);
+    return whole.substr(0, whole.find('\0'));
+}
+
+size_t SearchColumn::scan(const string& keyword, size_t first, size_t last, vector<size_t>& out, size_t limit) const {
+    if (keyword.size() < 3) return scanRecords(keyword, first, last, out, limit);
+
+    const auto bits = trigramProbe({ keyword });
+
+    size_t scannedBlocks = 0;
+    size_t skippedBlocks = 0;
+    size_t position = first;
+    while (position < last && limit > 0) {
+        const size_t block = position / blockRecords;
+        const size_t blockEnd = min(last, (block + 1) * blockRecords);
+        if (!blockMayContain(block, bits)) {
+            ++skippedBlocks;
+            position = blockEnd;
+            continue;
+        }
+        ++scannedBlocks;
+        const size_t before = out.size();
+        position = scanRecords(keyword, position, blockEnd, out, limit);
+        limit -= out.size() - before;
+    }
+    skipCounters.record(scannedBlocks, skippedBlocks);
+    return position < last ? position : last;
+}
+
+void SearchColumn::scanRegex(const Regex& regex, size_t first, size_t last, vector<size_t>& out) const {
+    Regex::Matcher matcher(regex);
+    const auto bits = trigramProbe(regex.requiredLiterals());
+    // Anchored prefixes are checked in place; otherwise the longest required literal
+    // picks the candidates through the search kernel.
+    const string prefix = regex.anchoredPrefix() ? regex.literalPrefix() : "";
+    string literal;
+    for (const auto& required : regex.requiredLiterals()) {
+        if (required.size() > literal.size()) literal = required;
+    }
+    const auto test = [&](size_t record) {
+        const auto text = title(record);
+        if (matcher.search(text.data(), text.size())) out.push_back(record);
+    };
+
+    size_t scannedBlocks = 0;
+    size_t skippedBlocks = 0;
+    vector<size_t> candidates;
+    for (size_t position = first; position < last;) {
+        const size_t block = position / blockRecords;
+        const size_t blockEnd = min(last, (block + 1) * blockRecords);
+        if (!blockMayContain(block, bits)) {
+            ++skippedBlocks;
+            position = blockEnd;
+            continue;
+        }
+        ++scannedBlocks;
+
+        if (prefix.empty() && !literal.empty()) {
+            candidates.clear();
+            scanRecords(literal, position, blockEnd, candidates, SIZE_MAX);
+            for (const size_t record : candidates) test(record);
+        } else {
+            for (size_t index = position; index < blockEnd; ++index) {
+                // The prefix has no '\0', so comparing the raw record never runs past the title.
+                if (prefix.empty() || record(index).compare(0, prefix.size(), prefix) == 0) test(index);
+            }
+        }
+        position = blockEnd;
+    }
+    skipCounters.record(scannedBlocks, skippedBlocks);
+}
+
+BlockSkipStats SearchColumn::blockSkipStats() const {
+    return skipCounters.stats();
+}
+
+vector<uint32_t> SearchColumn::trigramProbe(const vector<string>& literals) {
+    vector<uint32_t> bits;
+    for (const auto& literal : literals) {
+        for (size_t i = 0; i + 3 <= literal.size(); ++i) {
+            uint32_t first, second;
+            trigramBits(literal.data() + i, first, second);
+            bits.push_back(first);
+            bits.push_back(second);
+        }
+    }
+    return bits;
+}
+
+void SearchColumn::addTrigrams(size_t from, size_t to) {
+    uint64_t* bloom = blooms.data() + (recordCount() - 1) / blockRecords * bloomWords;
+    // The keyword of a column scan never contains '\0', so trigrams crossing the
+    // title/date separator are not needed.
+    for (size_t i = from; i + 3 <= to; ++i) {
+        if (data[i] == '\0' || data[i + 1] == '\0' || data[i + 2] == '\0') continue;
+        uint32_t first, second;
+        trigramBits(data.data() + i, first, second);
+        bloom[first / 64] |= uint64_t(1) << (first % 64);
+        bloom[second / 64] |= uint64_t(1) << (second % 64);
+    }
+}
+
+bool SearchColumn::blockMayContain(size_t block, const vector<uint32_t>& bits) const {
+    const uint64_t* bloom = blooms.data() + block * bloomWords;
+    for (const uint32_t bit : bits) {
+        if (!((bloom[bit / 64] >> (bit % 64)) & 1)) return false;
+    }
+    return true;
+}
+
+size_t SearchColumn::scanRecords(const string& keyword, size_t first, size_t last, vector<size_t>& out, size_t limit) const {
+    if (keyword.empty()) {
+        const size_t stop = first + min(limit, last - first);
+        for (size_t i = first; i < stop; ++i) out.push_back(i);
+        return stop;
+    }
+
+    // The caller guarantees the keyword has no '\0', so a hit can never span the
+    // title/date separator and always belongs to exactly one record.
+    size_t pos = offsets[first];
+    const size_t end = offsets[last];
+    auto record = offsets.begin() + first;
+    for (size_t found = 0; found < limit && pos < end; ++found) {
+        const size_t hit = findSubstring(data.data() + pos, end - pos, keyword.data(), keyword.size());
+        if (hit == string::npos) return last;
+
+        record = upper_bound(record, offsets.begin() + last, pos + hit) - 1;
+        out.push_back(static_cast<size_t>(record - offsets.begin()));
+        ++record;
+        pos = *record;
+    }
+    return pos < end ? static_cast<size_t>(record - offsets.begin()) : last;
+}
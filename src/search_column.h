@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include "block_skip_stats.h"
+
+using namespace std;
+
+struct Task;
+class Regex;
+
+// Titles and dates of all tasks packed into one buffer as "title\0date\0" records,
+// so that a keyword search is a single pass of the search kernel over memory. A folded
+// column stores the records case-folded (see foldCase) for case-insensitive search;
+// it starts out invalid so that it is only built once somebody searches it.
+//
+// Every block of blockRecords records has a Bloom filter of the byte trigrams of its
+// titles and dates; keyword scans skip blocks that cannot contain all trigrams of the
+// keyword. The filters take 8 KB per block, about 2 bytes per task.
+class SearchColumn {
+public:
+    static constexpr size_t blockRecords = 4096;
+
+    explicit SearchColumn(bool folded = false);
+
+    void rebuild(const vector<Task>& tasks);
+    void append(const Task& task);
+    void invalidate();
+    bool isValid() const;
+    size_t recordCount() const;
+    string_view record(size_t index) const;
+    string_view title(size_t index) const;
+    // Appends records of [first, last) containing the keyword to out, stopping after
+    // limit matches; returns the record to resume from.
+    size_t scan(const string& keyword, size_t first, size_t last, vector<size_t>& out, size_t limit = SIZE_MAX) const;
+    // Appends records of [first, last) whose title matches the regex. Blocks missing a
+    // required literal of the pattern are skipped, and the DFA only looks at titles that
+    // start with the anchored literal prefix or contain the longest required literal.
+    void scanRegex(const Regex& regex, size_t first, size_t last, vector<size_t>& out) const;
+    BlockSkipStats blockSkipStats() const;
+
+    static constexpr size_t bloomBytesPerBlock = 8192;
+
+private:
+    static constexpr size_t bloomWords = bloomBytesPerBlock / sizeof(uint64_t);
+
+    static vector<uint32_t> trigramProbe(const vector<string>& literals);
+    void addTrigrams(size_t from, size_t to);
+    bool blockMayContain(size_t block, const vector<uint32_t>& bits) const;
+    size_t scanRecords(const string& keyword, size_t first, size_t last, vector<size_t>& out, size_t limit) const;
+
+    string data;
+    vector<size_t> offsets{ 0 };
+    vector<uint64_t> blooms;
+    mutable BlockSkipCounters skipCounters;
+    bool folded;
+    bool valid;
+};
@@ -0,0 +1,51 @@
+﻿#include "search_cursor.h"
+#include "task_manager.h"
+#include <stdexcept>
+
+using namespace std;
+
+SearchCursor::SearchCursor(const TaskManager& manager, const string& expressionText, bool ignoreCase,
+    size_t position, uint64_t epoch)
+    : manager(&manager), expressionText(expressionText), ignoreCase(ignoreCase),
+    expression(KeywordExpression::parse(expressionText, ignoreCase)),
+    automaton(expression.isSingleKeyword() ? vector<string>() : expression.keywords()),
+    position(position), epoch(epoch) {
+    checkFresh();
+}
+
+vector<size_t> SearchCursor::next(size_t limit) {
+    checkFresh();
+    vector<size_t> matches;
+    const size_t end = manager->tasks.size();
+    if (limit == 0 || position >= end) return matches;
+
+    const auto& column = manager->searchColumnView(ignoreCase);
+    if (expression.isSingleKeyword()) {
+        position = manager->scanKeyword(expression.keywords()[0], position, end, matches, ignoreCase, limit);
+        return matches;
+    }
+    for (; position < end && matches.size() < limit; ++position) {
+        const auto record = column.record(position);
+        if (expression.evaluate(automaton.match(record.data(), record.size()))) matches.push_back(position);
+    }
+    return matches;
+}
+
+size_t SearchCursor::skip(size_t offset) {
+    const size_t batch = 4096;
+    size_t skipped = 0;
+    while (skipped < offset && !done()) skipped += next(min(batch, offset - skipped)).size();
+    return skipped;
+}
+
+bool SearchCursor::done() const {
+    return position >= manager->tasks.size();
+}
+
+string SearchCursor::token() const {
+    return to_string(epoch) + ":" + to_string(position) + ":" + (ignoreCase ? "i" : "c") + ":" + expressionText;
+}
+
+void SearchCursor::checkFresh() const {
+    if (manager->lastRewriteEpoch > epoch) throw invalid_argument("stale search: tasks were changed since it started");
+}
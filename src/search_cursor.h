@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "aho_corasick.h"
+#include "keyword_expression.h"
+
+using namespace std;
+
+class TaskManager;
+
+// Lazy walk over the matches of a keyword expression in task order. Each call scans
+// only as far as the requested matches, so the first page of a query that matches
+// millions of tasks costs as much as finding those few matches. A cursor survives
+// appended tasks but not edits, deletes or reordering: using it then throws
+// invalid_argument, like resuming from a stale token().
+class SearchCursor {
+public:
+    // Up to limit next matches; fewer only when the scan reached the last task.
+    vector<size_t> next(size_t limit);
+    // Skips up to offset matches and returns how many were skipped.
+    size_t skip(size_t offset);
+    bool done() const;
+    // Opaque continuation token for TaskManager::resumeSearch().
+    string token() const;
+
+private:
+    friend class TaskManager;
+
+    SearchCursor(const TaskManager& manager, const string& expression, bool ignoreCase, size_t position, uint64_t epoch);
+    void checkFresh() const;
+
+    const TaskManager* manager;
+    string expressionText;
+    bool ignoreCase;
+    KeywordExpression expression;
+    AhoCorasick automaton;
+    size_t position;
+    uint64_t epoch;
+};
@@ -0,0 +1,134 @@
+﻿#include "search_kernel.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SEARCH_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+using Kernel = size_t(*)(const char*, size_t, const char*, size_t);
+
+inline unsigned countTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return bit;
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+size_t findScalar(const char* haystack, size_t n, const char* needle, size_t m) {
+    if (m == 0) return 0;
+    if (m > n) return string::npos;
+
+    const char* last = haystack + (n - m);
+    const char* pos = haystack;
+    while (pos <= last) {
+        pos = static_cast<const char*>(memchr(pos, needle[0], static_cast<size_t>(last - pos) + 1));
+        if (!pos) return string::npos;
+        if (memcmp(pos + 1, needle + 1, m - 1) == 0) return static_cast<size_t>(pos - haystack);
+        ++pos;
+    }
+    return string::npos;
+}
+
+#ifdef SEARCH_KERNEL_X86
+
+// Both kernels compare the first and the last byte of the needle at every position
+// of a block and run memcmp only for the positions where both of them match.
+
+size_t findSse2(const char* haystack, size_t n, const char* needle, size_t m) {
+    if (m < 2 || m > n) return findScalar(haystack, n, needle, m);
+
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+
+        while (mask != 0) {
+            const unsigned bit = countTrailingZeros(mask);
+            if (memcmp(haystack + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    const size_t tail = findScalar(haystack + i, n - i, needle, m);
+    return tail == string::npos ? tail : i + tail;
+}
+
+#if defined(__GNUC__)
+#define SEARCH_KERNEL_AVX2 1
+
+__attribute__((target("avx2")))
+size_t findAvx2(const char* haystack, size_t n, const char* needle, size_t m) {
+    if (m < 2 || m > n) return findScalar(haystack, n, needle, m);
+
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+
+        while (mask != 0) {
+            const unsigned bit = countTrailingZeros(mask);
+            if (memcmp(haystack + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    const size_t tail = findSse2(haystack + i, n - i, needle, m);
+    return tail == string::npos ? tail : i + tail;
+}
+#endif
+
+#endif
+
+struct KernelChoice {
+    Kernel kernel;
+    const char* name;
+};
+
+KernelChoice selectKernel() {
+#ifdef SEARCH_KERNEL_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return { findAvx2, "avx2" };
+#endif
+#ifdef SEARCH_KERNEL_X86
+    return { findSse2, "sse2" };
+#else
+    return { findScalar, "scalar" };
+#endif
+}
+
+const KernelChoice& activeKernel() {
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+}
+
+size_t findSubstring(const char* haystack, size_t haystackSize, const char* needle, size_t needleSize) {
+    return activeKernel().kernel(haystack, haystackSize, needle, needleSize);
+}
+
+const char* searchKernelName() {
+    return activeKernel().name;
+}
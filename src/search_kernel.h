@@ -0,0 +1,10 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// Returns the offset of the first occurrence of needle in haystack, or string::npos.
+// The implementation (AVX2, SSE2 or scalar) is selected once from the running CPU.
+size_t findSubstring(const char* haystack, size_t haystackSize, const char* needle, size_t needleSize);
+const char* searchKernelName();
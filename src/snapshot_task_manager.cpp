@@ -0,0 +1,119 @@
+﻿#include "snapshot_task_manager.h"
+#include "tim_sort.h"
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+SnapshotTaskManager::Snapshot::Snapshot(EpochDomain::Guard guard, const TaskVersion* current)
+    : guard(move(guard)), current(current) {}
+
+size_t SnapshotTaskManager::Snapshot::getTaskCount() const {
+    return current->tasks.size();
+}
+
+const Task& SnapshotTaskManager::Snapshot::getTask(size_t index) const {
+    if (index >= current->tasks.size()) throw out_of_range("task index out of range");
+    return current->tasks[index];
+}
+
+const PersistentTaskList& SnapshotTaskManager::Snapshot::tasks() const {
+    return current->tasks;
+}
+
+uint64_t SnapshotTaskManager::Snapshot::version() const {
+    return current->number;
+}
+
+vector<size_t> SnapshotTaskManager::Snapshot::findTaskIndices(const string& keyword, bool ignoreCase) const {
+    return current->tasks.findTaskIndices(keyword, ignoreCase);
+}
+
+SnapshotTaskManager::SnapshotTaskManager() : owned(make_unique<TaskVersion>()), current(owned.get()) {}
+
+SnapshotTaskManager::Snapshot SnapshotTaskManager::snapshot() const {
+    // Pin before loading the pointer: a version replaced after the pin is not deleted
+    // until the guard is released.
+    auto guard = epochs.pin();
+    return Snapshot(move(guard), current.load());
+}
+
+size_t SnapshotTaskManager::getTaskCount() const {
+    return snapshot().getTaskCount();
+}
+
+void SnapshotTaskManager::addTask(const string& title, const string& date, int priority) {
+    update([&](PersistentTaskList& tasks) { tasks.pushBack({ title, date, priority, false }); });
+}
+
+bool SnapshotTaskManager::editTask(size_t index, const string& newTitle, const string& newDate, int newPriority) {
+    lock_guard<mutex> lock(writerMutex);
+    if (index >= owned->tasks.size()) return false;
+    auto next = make_unique<TaskVersion>(*owned);
+    Task task = next->tasks[index];
+    if (!newTitle.empty()) task.title = newTitle;
+    if (!newDate.empty()) task.date = newDate;
+    if (newPriority != -1) task.priority = newPriority;
+    next->tasks.set(index, move(task));
+    publish(move(next));
+    return true;
+}
+
+bool SnapshotTaskManager::deleteTask(size_t index) {
+    lock_guard<mutex> lock(writerMutex);
+    if (index >= owned->tasks.size()) return false;
+    auto next = make_unique<TaskVersion>(*owned);
+    next->tasks.erase(index);
+    publish(move(next));
+    return true;
+}
+
+bool SnapshotTaskManager::markCompleted(size_t index) {
+    lock_guard<mutex> lock(writerMutex);
+    if (index >= owned->tasks.size()) return false;
+    auto next = make_unique<TaskVersion>(*owned);
+    Task task = next->tasks[index];
+    task.completed = true;
+    next->tasks.set(index, move(task));
+    publish(move(next));
+    return true;
+}
+
+void SnapshotTaskManager::sortTasks(const vector<SortKey>& keys) {
+    update([&](PersistentTaskList& tasks) {
+        auto sorted = tasks.toVector();
+        timSort(sorted.begin(), sorted.end(), CompositeOrder{ keys });
+        tasks.assign(move(sorted));
+    });
+}
+
+void SnapshotTaskManager::loadFromFile(const string& filename) {
+    ifstream file(filename);
+    if (!file) return;
+
+    vector<Task> loaded;
+    string line;
+    while (getline(file, line)) {
+        if (auto task = parseTaskLine(line)) loaded.push_back(move(*task));
+    }
+    update([&](PersistentTaskList& tasks) { tasks.assign(move(loaded)); });
+}
+
+void SnapshotTaskManager::saveToFile(const string& filename) const {
+    const auto view = snapshot();
+    ofstream file(filename);
+    view.tasks().forEach([&](size_t, const Task& task) { file << formatTaskLine(task) << "\n"; });
+}
+
+size_t SnapshotTaskManager::pendingVersions() const {
+    lock_guard<mutex> lock(writerMutex);
+    return epochs.collect();
+}
+
+void SnapshotTaskManager::publish(unique_ptr<TaskVersion> next) {
+    next->number = owned->number + 1;
+    current.store(next.get());
+    shared_ptr<const TaskVersion> replaced = exchange(owned, move(next));
+    epochs.retire(move(replaced));
+    epochs.collect();
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "epoch_reclamation.h"
+#include "persistent_task_list.h"
+#include "task_manager.h"
+
+using namespace std;
+
+// One published state of a SnapshotTaskManager; never changed once published.
+struct TaskVersion {
+    PersistentTaskList tasks;
+    uint64_t number = 0;
+};
+
+// Task list for read-mostly sharing between threads, RCU style: a writer copies the
+// current version (sharing its unchanged chunks), changes the copy and publishes it with
+// one atomic pointer store. Readers take a snapshot without locks, never wait for writers
+// and see one version throughout; writers only wait for each other. Replaced versions
+// are deleted once no snapshot can hold them, so snapshots should be short-lived: one
+// held open keeps every version published after it alive too.
+class SnapshotTaskManager {
+public:
+    // Consistent read-only view of one version. Must not outlive its manager.
+    class Snapshot {
+    public:
+        size_t getTaskCount() const;
+        const Task& getTask(size_t index) const;
+        const PersistentTaskList& tasks() const;
+        // Number of the version seen, counting publications from 0.
+        uint64_t version() const;
+        // Tasks whose title or date contains keyword, as TaskManager::findTaskIndices.
+        vector<size_t> findTaskIndices(const string& keyword, bool ignoreCase = false) const;
+
+    private:
+        friend class SnapshotTaskManager;
+        Snapshot(EpochDomain::Guard guard, const TaskVersion* current);
+
+        EpochDomain::Guard guard;
+        const TaskVersion* current;
+    };
+
+    SnapshotTaskManager();
+    SnapshotTaskManager(const SnapshotTaskManager&) = delete;
+    SnapshotTaskManager& operator=(const SnapshotTaskManager&) = delete;
+
+    Snapshot snapshot() const;
+    size_t getTaskCount() const;
+
+    void addTask(const string& title, const string& date, int priority);
+    bool editTask(size_t index, const string& newTitle = "", const string& newDate = "", int newPriority = -1);
+    bool deleteTask(size_t index);
+    bool markCompleted(size_t index);
+    // Stable, as TaskManager::sortTasks(keys).
+    void sortTasks(const vector<SortKey>& keys);
+    void loadFromFile(const string& filename);
+    void saveToFile(const string& filename) const;
+
+    // Applies edit(PersistentTaskList&) to a copy of the current tasks and publishes the
+    // result as one version, e.g. for a bulk import. Returns what edit returns.
+    template <class Edit>
+    auto update(Edit&& edit) {
+        lock_guard<mutex> lock(writerMutex);
+        auto next = make_unique<TaskVersion>(*owned);
+        if constexpr (is_void_v<decltype(edit(next->tasks))>) {
+            edit(next->tasks);
+            publish(move(next));
+        }
+        else {
+            auto result = edit(next->tasks);
+            publish(move(next));
+            return result;
+        }
+    }
+
+    // Replaced versions not yet deleted because a snapshot may still hold them. Versions
+    // are collected on every publication; this collects too, for a manager gone idle.
+    size_t pendingVersions() const;
+
+private:
+    void publish(unique_ptr<TaskVersion> next);
+
+    // Declared first so that it outlives the versions it may still delete.
+    mutable EpochDomain epochs;
+    mutable mutex writerMutex;
+    // The current version: owned by the writers, read by everyone through current.
+    unique_ptr<const TaskVersion> owned;
+    atomic<const TaskVersion*> current;
+};
@@ -0,0 +1,120 @@
+﻿#include "task_journal.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const string commitLine = "commit";
+
+}
+
+bool flushToDisk(FILE* file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+TaskJournal::TaskJournal(const string& filename) : filename(filename) {
+    // Keep complete records only; anything after the last commit line never committed.
+    size_t validBytes = 0;
+    {
+        ifstream in(filename, ios::binary);
+        string line, record;
+        size_t offset = 0;
+        while (getline(in, line)) {
+            offset += line.size();
+            if (in.eof()) break;
+            ++offset;
+            if (line == commitLine) {
+                recovered.push_back(move(record));
+                record.clear();
+                validBytes = offset;
+            }
+            else {
+                record += line + "\n";
+            }
+        }
+    }
+    error_code error;
+    if (filesystem::exists(filename, error) && filesystem::file_size(filename, error) != validBytes) {
+        filesystem::resize_file(filename, validBytes, error);
+        if (error) throw runtime_error("cannot truncate task journal " + filename + ": " + error.message());
+    }
+
+    file = fopen(filename.c_str(), "ab");
+    if (!file) throw runtime_error("cannot open task journal " + filename);
+}
+
+TaskJournal::~TaskJournal() {
+    unique_lock<mutex> lock(stateMutex);
+    batchSynced.wait(lock, [&] { return !syncing; });
+    if (!pending.empty() && !failed) writeBatch(pending);
+    if (file) fclose(file);
+}
+
+const vector<string>& TaskJournal::recoveredRecords() const {
+    return recovered;
+}
+
+void TaskJournal::restart(const string& firstRecord) {
+    unique_lock<mutex> lock(stateMutex);
+    batchSynced.wait(lock, [&] { return !syncing; });
+    pending.clear();
+    file = freopen(filename.c_str(), "wb", file);
+    failed = !file || !writeBatch(firstRecord + commitLine + "\n");
+    durable = queued;
+    batchSynced.notify_all();
+    if (failed) throw runtime_error("cannot restart task journal " + filename);
+}
+
+uint64_t TaskJournal::enqueue(const string& record) {
+    lock_guard<mutex> lock(stateMutex);
+    pending += record;
+    pending += commitLine + "\n";
+    return ++queued;
+}
+
+void TaskJournal::waitDurable(uint64_t sequence) {
+    unique_lock<mutex> lock(stateMutex);
+    while (durable < sequence && !failed) {
+        if (syncing) {
+            batchSynced.wait(lock);
+            continue;
+        }
+        // Become the leader: take everything queued so far, including other threads'
+        // records, and sync it without holding the lock so that more can queue up.
+        syncing = true;
+        const string batch = move(pending);
+        pending.clear();
+        const uint64_t through = queued;
+        lock.unlock();
+        const bool written = writeBatch(batch);
+        lock.lock();
+        syncing = false;
+        ++syncs;
+        if (written) durable = through;
+        else failed = true;
+        batchSynced.notify_all();
+    }
+    if (durable < sequence) throw runtime_error("task journal write failed");
+}
+
+size_t TaskJournal::syncCount() const {
+    lock_guard<mutex> lock(stateMutex);
+    return syncs;
+}
+
+bool TaskJournal::writeBatch(const string& batch) {
+    return file && fwrite(batch.data(), 1, batch.size(), file) == batch.size() && flushToDisk(file);
+}
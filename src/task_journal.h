@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Flushes the file and syncs it to disk; false on failure.
+bool flushToDisk(FILE* file);
+
+// Append-only file of committed transactions. Each record is followed by a "commit" line
+// and is on disk (fsync) by the time waitDurable returns for it. Records queued while a
+// sync is running are written and synced together by the next one (group commit), so
+// concurrent committers share one fsync instead of paying for one each.
+class TaskJournal {
+public:
+    // Opens or creates the file. Complete records already in it are kept for
+    // recoveredRecords(); a torn last record, left by a crash mid-write, is cut off.
+    // Throws runtime_error if the file cannot be opened.
+    explicit TaskJournal(const string& filename);
+    TaskJournal(const TaskJournal&) = delete;
+    TaskJournal& operator=(const TaskJournal&) = delete;
+    // Syncs whatever is still queued.
+    ~TaskJournal();
+
+    const vector<string>& recoveredRecords() const;
+    // Empties the file down to firstRecord, once the records in it are safely stored
+    // elsewhere (a checkpoint). Records still queued count as durable. Throws
+    // runtime_error if the file cannot be rewritten.
+    void restart(const string& firstRecord);
+
+    // Queues a record (lines ending in '\n', none of them just "commit") and returns its
+    // sequence number; records reach the file in the order they were queued.
+    uint64_t enqueue(const string& record);
+    // Returns once records up to this sequence number are on disk. Throws runtime_error
+    // if writing or syncing failed.
+    void waitDurable(uint64_t sequence);
+    size_t syncCount() const;
+
+private:
+    // Writes and syncs a batch; false on failure.
+    bool writeBatch(const string& batch);
+
+    string filename;
+    FILE* file = nullptr;
+    vector<string> recovered;
+
+    mutable mutex stateMutex;
+    condition_variable batchSynced;
+    string pending;
+    uint64_t queued = 0;
+    uint64_t durable = 0;
+    bool syncing = false;
+    bool failed = false;
+    size_t syncs = 0;
+};
@@ -1,11 +1,54 @@
 ﻿#include "task_manager.h"
+#include "aho_corasick.h"
+#include "keyword_expression.h"
+#include "fuzzy_search.h"
+#include "date_key.h"
+#include "query_planner.h"
+#include "case_fold.h"
+#include "regex.h"
+#include "radix_sort.h"
+#include "collation.h"
+#include <sstream>
+#include <stdexcept>
 #include <fstream>
 #include <iostream>
 
 using namespace std;
 
+string formatTaskLine(const Task& task) {
+    return task.title + "," + task.date + "," + to_string(task.priority) + "," + (task.completed ? "1" : "0");
+}
+
+optional<Task> parseTaskLine(const string& line) {
+    size_t pos1 = line.find(',');
+    size_t pos2 = line.find(',', pos1 + 1);
+    size_t pos3 = line.find(',', pos2 + 1);
+
+    if (pos1 == string::npos || pos2 == string::npos || pos3 == string::npos)
+        return nullopt;
+
+    Task task;
+    task.title = line.substr(0, pos1);
+    task.date = line.substr(pos1 + 1, pos2 - pos1 - 1);
+    task.priority = stoi(line.substr(pos2 + 1, pos3 - pos2 - 1));
+    task.completed = (line.substr(pos3 + 1) == "1");
+    return task;
+}
+
 void TaskManager::addTask(const string& title, const string& date, int priority) {
     tasks.push_back({ title, date, priority, false });
+    if (searchColumn.isValid()) searchColumn.append(tasks.back());
+    if (foldedColumn.isValid()) foldedColumn.append(tasks.back());
+    zoneMaps.append(tasks.size() - 1, tasks.back());
+    dateIndex.insert(tasks.size() - 1, dateKey(date));
+    priorityIndex.insert(tasks.size() - 1, priority);
+    titleOrder.insert(tasks.size() - 1);
+    if (collationKeys.isValid()) collationKeys.append(tasks.back());
+    checkSortedAround(tasks.size() - 1);
+    completion.append(false);
+    termStatistics.addTitle(title);
+    titleTrie.insert(title);
+    ++mutationEpoch;
 }
 
 void TaskManager::showTasks() const {
@@ -14,23 +57,35 @@ void TaskManager::showTasks() const {
         return;
     }
 
-    for (size_t i = 0; i < tasks.size(); ++i) {
-        const auto& task = tasks[i];
-        cout << i + 1 << ". " << (task.completed ? "[x] " : "[ ] ") << task.title << " (" << task.date << ", priority: " << task.priority << ")\n";
+    for (size_t i = 0; i < tasks.size(); ++i) showTask(i);
+}
+
+void TaskManager::showTasks(SortOrder order) const {
+    if (tasks.empty()) {
+        cout << "Task list is empty.\n";
+        return;
     }
+
+    forEachInOrder(order, [&](size_t index) { showTask(index); });
+}
+
+void TaskManager::showTask(size_t index) const {
+    const auto& task = tasks[index];
+    cout << index + 1 << ". " << (task.completed ? "[x] " : "[ ] ") << task.title << " (" << task.date << ", priority: " << task.priority << ")\n";
 }
 
 bool TaskManager::markCompleted(size_t index) {
     if (index >= tasks.size()) return false;
     tasks[index].completed = true;
+    completion.set(index);
+    zoneMaps.markDirty(index);
+    markRewritten();
     return true;
 }
 
 void TaskManager::saveToFile(const string& filename) const {
     ofstream file(filename);
-    for (const auto& task : tasks) {
-        file << task.title << "," << task.date << "," << task.priority << "," << task.completed << "\n";
-    }
+    for (const auto& task : tasks) file << formatTaskLine(task) << "\n";
 }
 
 void TaskManager::loadFromFile(const string& filename) {
@@ -40,57 +95,514 @@ void TaskManager::loadFromFile(const string& filename) {
     tasks.clear();
     string line;
     while (getline(file, line)) {
-        size_t pos1 = line.find(',');
-        size_t pos2 = line.find(',', pos1 + 1);
-        size_t pos3 = line.find(',', pos2 + 1);
+        if (auto task = parseTaskLine(line)) tasks.push_back(move(*task));
+    }
+    collationKeys.invalidate();
+    rebuildIndexes();
+    rebuildTitleIndexes();
+}
+
+vector<size_t> TaskManager::findTaskIndices(const string& keyword, bool ignoreCase) const {
+    const string pattern = ignoreCase ? foldCase(keyword) : keyword;
+    searchColumnView(ignoreCase);
+    const auto scanRange = [&](size_t first, size_t last, vector<size_t>& out) {
+        scanKeyword(pattern, first, last, out, ignoreCase);
+    };
+    return cachedSearch((ignoreCase ? "folded keyword:" : "keyword:") + pattern, [&] { return scanTasks(scanRange); }, scanRange);
+}
+
+vector<size_t> TaskManager::findTaskIndicesMatching(const string& expression, bool ignoreCase) const {
+    // Keywords come out of the parser already folded.
+    const auto parsed = KeywordExpression::parse(expression, ignoreCase);
+    if (parsed.isSingleKeyword()) return findTaskIndices(parsed.keywords()[0], ignoreCase);
+
+    const AhoCorasick automaton(parsed.keywords());
+    const auto& column = searchColumnView(ignoreCase);
+    const auto scanRange = [&](size_t first, size_t last, vector<size_t>& out) {
+        for (size_t i = first; i < last; ++i) {
+            const auto record = column.record(i);
+            if (parsed.evaluate(automaton.match(record.data(), record.size()))) out.push_back(i);
+        }
+    };
+    return cachedSearch((ignoreCase ? "folded expression:" : "expression:") + parsed.toString(), [&] { return scanTasks(scanRange); }, scanRange);
+}
+
+vector<size_t> TaskManager::findTasksByRegex(const string& pattern) const {
+    const Regex regex(pattern);
+    const auto& column = searchColumnView();
+    const auto scanRange = [&](size_t first, size_t last, vector<size_t>& out) {
+        column.scanRegex(regex, first, last, out);
+    };
+    return cachedSearch("regex:" + pattern, [&] { return scanTasks(scanRange); }, scanRange);
+}
 
-        if (pos1 == string::npos || pos2 == string::npos || pos3 == string::npos)
-            continue;
+SearchCursor TaskManager::searchCursor(const string& expression, bool ignoreCase) const {
+    return SearchCursor(*this, expression, ignoreCase, 0, mutationEpoch);
+}
+
+SearchCursor TaskManager::resumeSearch(const string& token) const {
+    // "<epoch>:<position>:<c|i>:<expression>"
+    const size_t first = token.find(':');
+    const size_t second = first == string::npos ? string::npos : token.find(':', first + 1);
+    const size_t third = second == string::npos ? string::npos : token.find(':', second + 1);
+    if (third != second + 2 || (token[second + 1] != 'c' && token[second + 1] != 'i'))
+        throw invalid_argument("malformed search token");
 
-        Task task;
-        task.title = line.substr(0, pos1);
-        task.date = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        task.priority = stoi(line.substr(pos2 + 1, pos3 - pos2 - 1));
-        task.completed = (line.substr(pos3 + 1) == "1");
-        tasks.push_back(task);
+    uint64_t epoch;
+    size_t position;
+    try {
+        size_t used;
+        epoch = stoull(token.substr(0, first), &used);
+        if (used != first) throw invalid_argument("");
+        position = stoull(token.substr(first + 1, second - first - 1), &used);
+        if (used != second - first - 1) throw invalid_argument("");
+    }
+    catch (const exception&) {
+        throw invalid_argument("malformed search token");
     }
+    if (epoch > mutationEpoch || position > tasks.size()) throw invalid_argument("malformed search token");
+    return SearchCursor(*this, token.substr(third + 1), token[second + 1] == 'i', position, epoch);
 }
 
-vector<size_t> TaskManager::findTaskIndices(const string& keyword) const {
-    vector<size_t> indices;
-    for (size_t i = 0; i < tasks.size(); ++i) {
-        if (tasks[i].title.find(keyword) != string::npos || tasks[i].date.find(keyword) != string::npos) {
-            indices.push_back(i);
+vector<FuzzyMatch> TaskManager::findTasksFuzzy(const string& keyword, int maxDistance) const {
+    const FuzzyPattern pattern(keyword);
+    const auto& column = searchColumnView();
+    auto matches = scanTasks<FuzzyMatch>([&](size_t first, size_t last, vector<FuzzyMatch>& out) {
+        for (size_t i = first; i < last; ++i) {
+            const auto title = column.title(i);
+            const int distance = pattern.distance(title.data(), title.size());
+            if (distance <= maxDistance) out.push_back({ i, distance });
+        }
+    });
+
+    stable_sort(matches.begin(), matches.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+        return a.distance < b.distance;
+    });
+    return matches;
+}
+
+vector<size_t> TaskManager::findTasksInRange(const string& from, const string& to) const {
+    const int fromKey = dateKey(from);
+    const int toKey = dateKey(to);
+    if (fromKey == 0 || toKey == 0) throw invalid_argument("dates must be valid DD.MM.YYYY");
+    return dateIndex.range(fromKey, toKey);
+}
+
+namespace {
+
+bool rankedBefore(const RankedMatch& a, const RankedMatch& b) {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+}
+
+// Keeps the k best matches in a heap whose top is the worst of them.
+void keepTop(vector<RankedMatch>& heap, const RankedMatch& match, size_t k) {
+    if (heap.size() < k) {
+        heap.push_back(match);
+        push_heap(heap.begin(), heap.end(), rankedBefore);
+    }
+    else if (rankedBefore(match, heap.front())) {
+        pop_heap(heap.begin(), heap.end(), rankedBefore);
+        heap.back() = match;
+        push_heap(heap.begin(), heap.end(), rankedBefore);
+    }
+}
+
+}
+
+vector<RankedMatch> TaskManager::findTopTasks(const string& query, size_t k, const RankingOptions& options) const {
+    const Bm25Scorer scorer(query, termStatistics);
+    if (k == 0 || scorer.empty()) return {};
+
+    const int today = options.todayKey != 0 ? options.todayKey : todayDateKey();
+    const int todayDays = daysFromDateKey(today);
+    auto chunkTops = scanTasks<RankedMatch>([&](size_t first, size_t last, vector<RankedMatch>& out) {
+        vector<RankedMatch> heap;
+        heap.reserve(k);
+        for (size_t i = first; i < last; ++i) {
+            double score = scorer.score(tasks[i].title);
+            if (score == 0) continue;
+
+            score *= 1 + options.priorityWeight * max(0, tasks[i].priority - 1);
+            const int due = dateKey(tasks[i].date);
+            if (due != 0) score *= 1 + options.dueWeight / (1 + max(0, daysFromDateKey(due) - todayDays));
+            keepTop(heap, { i, score }, k);
         }
+        out.insert(out.end(), heap.begin(), heap.end());
+    });
+
+    vector<RankedMatch> top;
+    top.reserve(k);
+    for (const auto& match : chunkTops) keepTop(top, match, k);
+    sort_heap(top.begin(), top.end(), rankedBefore);
+    return top;
+}
+
+vector<size_t> TaskManager::findTasksByQuery(const string& query) const {
+    const auto parsed = TaskQuery::parse(query);
+    const QueryPlanner planner(*this);
+    return cachedSearch("query:" + parsed.toString(),
+        [&] { return planner.execute(parsed, planner.plan(parsed)).indices; },
+        [&](size_t first, size_t last, vector<size_t>& out) {
+            for (size_t i = first; i < last; ++i) {
+                if (parsed.matches(tasks[i])) out.push_back(i);
+            }
+        });
+}
+
+string TaskManager::explainQuery(const string& query) const {
+    const auto parsed = TaskQuery::parse(query);
+    const QueryPlanner planner(*this);
+    const auto plan = planner.plan(parsed);
+    const auto execution = planner.execute(parsed, plan);
+
+    ostringstream text;
+    text << "Query: " << parsed.toString() << "\n";
+    text << "Plan: " << QueryPlanner::describe(plan.driver) << (plan.needsFilter ? " -> filter" : "") << "\n";
+    text << "Cost: " << plan.driver.cost << " (full scan " << plan.fullScanCost << ")\n";
+    text << "Candidate rows: estimated " << static_cast<size_t>(plan.driver.estimatedRows + 0.5)
+        << ", actual " << execution.candidateRows << "\n";
+    text << "Result rows: estimated " << static_cast<size_t>(plan.estimatedResultRows + 0.5)
+        << ", actual " << execution.indices.size() << "\n";
+    if (plan.driver.access == QueryPlanner::Access::FullScan) {
+        text << "Blocks decided by zone maps: " << execution.blocks.skipped << " of "
+            << execution.blocks.scanned + execution.blocks.skipped << "\n";
     }
+    return text.str();
+}
+
+namespace {
+
+// Flipping the sign bit maps int order onto unsigned order.
+uint32_t priorityKey(const Task& task) {
+    return static_cast<uint32_t>(task.priority) ^ 0x80000000u;
+}
+
+uint32_t dateSortKey(const Task& task) {
+    return static_cast<uint32_t>(dateKey(task.date));
+}
+
+vector<SortKey> sortKeysOf(SortOrder order) {
+    switch (order) {
+    case SortOrder::PriorityAscending: return { { SortField::Priority } };
+    case SortOrder::PriorityDescending: return { { SortField::Priority, true } };
+    case SortOrder::DateAscending: return { { SortField::Date } };
+    case SortOrder::DateDescending: return { { SortField::Date, true } };
+    case SortOrder::Title: break;
+    case SortOrder::CollatedTitle: break;
+    }
+    return { { SortField::Title } };
+}
+
+}
+
+void TaskManager::sortTasks(SortOrder order) {
+    if (order == SortOrder::CollatedTitle) {
+        reorderTasks(collatedOrder());
+        return;
+    }
+
+    auto keys = sortKeysOf(order);
+    if (sortIfNearlySorted(keys)) return;
+    switch (order) {
+    case SortOrder::PriorityAscending: sortByKey(priorityKey, false); break;
+    case SortOrder::PriorityDescending: sortByKey(priorityKey, true); break;
+    case SortOrder::DateAscending: sortByKey(dateSortKey, false); break;
+    case SortOrder::DateDescending: sortByKey(dateSortKey, true); break;
+    case SortOrder::Title: sortTasks(keys); break;
+    case SortOrder::CollatedTitle: break;
+    }
+    sortedBy = move(keys);
+}
+
+void TaskManager::sortTasks(const vector<SortKey>& keys) {
+    if (sortIfNearlySorted(keys)) return;
+    const CompositeKey composite(tasks, keys);
+    vector<uint64_t> packed(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) packed[i] = composite.pack(tasks[i]);
+    auto order = radixSortOrder(packed, &packed);
+
+    if (!composite.isExact()) {
+        const vector<SortKey> remainingKeys(keys.begin() + composite.exactKeys(), keys.end());
+        const CompositeOrder remainingOrder{ remainingKeys };
+        const auto byTask = [&](uint32_t a, uint32_t b) { return remainingOrder(tasks[a], tasks[b]); };
+        for (size_t run = 0; run < order.size();) {
+            size_t runEnd = run + 1;
+            while (runEnd < order.size() && packed[runEnd] == packed[run]) ++runEnd;
+            if (runEnd - run > 1) stable_sort(order.begin() + run, order.begin() + runEnd, byTask);
+            run = runEnd;
+        }
+    }
+    reorderTasks(move(order));
+    sortedBy = keys;
+}
+
+bool TaskManager::isSortedBy(const vector<SortKey>& keys) const {
+    return sortedBy && *sortedBy == keys;
+}
+
+bool TaskManager::sortIfNearlySorted(const vector<SortKey>& keys) {
+    if (isSortedBy(keys)) return true;
+
+    // Count descents, giving up as soon as there are too many for timSort to win.
+    const CompositeOrder order{ keys };
+    const size_t maxDescents = tasks.size() / nearlySortedRatio;
+    size_t descents = 0;
+    for (size_t i = 1; i < tasks.size() && descents <= maxDescents; ++i) descents += order(tasks[i], tasks[i - 1]);
+    if (descents > maxDescents) return false;
+
+    if (descents) comparisonSort(order);
+    sortedBy = keys;
+    return true;
+}
+
+void TaskManager::checkSortedAround(size_t index) {
+    if (!sortedBy) return;
+    const CompositeOrder order{ *sortedBy };
+    if ((index > 0 && order(tasks[index], tasks[index - 1]))
+        || (index + 1 < tasks.size() && order(tasks[index + 1], tasks[index]))) {
+        sortedBy.reset();
+    }
+}
+
+vector<size_t> TaskManager::topTasks(size_t n, const vector<SortKey>& order, bool includeCompleted) const {
+    const CompositeKey composite(tasks, order);
+    vector<pair<uint64_t, uint32_t>> entries;
+    entries.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        if (includeCompleted || !tasks[i].completed) entries.emplace_back(composite.pack(tasks[i]), static_cast<uint32_t>(i));
+    }
+
+    n = min(n, entries.size());
+    if (n == 0) return {};
+
+    // Select by packed key alone, then keep the tasks tied with the n-th key: the full
+    // comparison below decides which of them make the cut.
+    auto candidatesEnd = entries.end();
+    if (n < entries.size()) {
+        const auto byKey = [](const pair<uint64_t, uint32_t>& a, const pair<uint64_t, uint32_t>& b) { return a.first < b.first; };
+        nth_element(entries.begin(), entries.begin() + n - 1, entries.end(), byKey);
+        const uint64_t boundary = entries[n - 1].first;
+        candidatesEnd = partition(entries.begin() + n, entries.end(), [&](const pair<uint64_t, uint32_t>& entry) { return entry.first == boundary; });
+    }
+
+    // Ties on the packed key go to the keys not packed whole and then to the index,
+    // which makes the order total and equal to a stable sort.
+    const vector<SortKey> remainingKeys(order.begin() + composite.exactKeys(), order.end());
+    const CompositeOrder remainingOrder{ remainingKeys };
+    const auto before = [&](const pair<uint64_t, uint32_t>& a, const pair<uint64_t, uint32_t>& b) {
+        if (a.first != b.first) return a.first < b.first;
+        if (remainingOrder(tasks[a.second], tasks[b.second])) return true;
+        if (remainingOrder(tasks[b.second], tasks[a.second])) return false;
+        return a.second < b.second;
+    };
+    partial_sort(entries.begin(), entries.begin() + n, candidatesEnd, before);
+
+    vector<size_t> indices(n);
+    for (size_t i = 0; i < n; ++i) indices[i] = entries[i].second;
     return indices;
 }
 
+vector<uint32_t> TaskManager::collatedOrder() const {
+    const auto& keys = collationKeyView();
+    vector<string_view> views(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) views[i] = keys.key(i);
+    return radixSortOrder(views);
+}
+
+void TaskManager::reorderTasks(vector<uint32_t> order) {
+    if (collationKeys.isValid()) collationKeys.reorder(order);
+    applyPermutation(tasks, move(order));
+    rebuildIndexes();
+}
+
+void TaskManager::sortByKey(uint32_t (*keyOf)(const Task&), bool descending) {
+    // Complemented keys sort descending while equal keys stay in task order.
+    const uint32_t flip = descending ? 0xFFFFFFFFu : 0;
+    vector<uint32_t> keys(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) keys[i] = keyOf(tasks[i]) ^ flip;
+    reorderTasks(radixSortOrder(keys));
+}
+
 void TaskManager::sortTasks(function<bool(const Task&, const Task&)> comparator) {
-    sort(tasks.begin(), tasks.end(), comparator);
+    comparisonSort(comparator);
 }
 
 bool TaskManager::editTask(size_t index, const string& newTitle,
     const string& newDate, int newPriority) {
     if (index >= tasks.size()) return false;
 
-    if (!newTitle.empty()) tasks[index].title = newTitle;
-    if (!newDate.empty()) tasks[index].date = newDate;
-    if (newPriority != -1) tasks[index].priority = newPriority;
+    if (!newTitle.empty()) {
+        termStatistics.removeTitle(tasks[index].title);
+        termStatistics.addTitle(newTitle);
+        titleTrie.erase(tasks[index].title);
+        titleTrie.insert(newTitle);
+        titleOrder.remove(tasks, index);
+        tasks[index].title = newTitle;
+        titleOrder.insert(index);
+        if (collationKeys.isValid()) collationKeys.update(index, tasks[index]);
+    }
+    if (!newDate.empty()) {
+        dateIndex.update(index, dateKey(tasks[index].date), dateKey(newDate));
+        tasks[index].date = newDate;
+    }
+    if (newPriority != -1) {
+        priorityIndex.update(index, tasks[index].priority, newPriority);
+        tasks[index].priority = newPriority;
+    }
+    if (!newDate.empty() || newPriority != -1) zoneMaps.markDirty(index);
+    checkSortedAround(index);
+    markRewritten();
+    if (!newTitle.empty() || !newDate.empty()) {
+        searchColumn.invalidate();
+        foldedColumn.invalidate();
+    }
 
     return true;
 }
 
 bool TaskManager::deleteTask(size_t index) {
     if (index >= tasks.size()) return false;
+    dateIndex.erase(index, dateKey(tasks[index].date));
+    priorityIndex.erase(index, tasks[index].priority);
+    titleOrder.erase(tasks, index);
+    if (collationKeys.isValid()) collationKeys.erase(index);
+    completion.erase(index);
+    zoneMaps.markDirtyFrom(index);
+    termStatistics.removeTitle(tasks[index].title);
+    titleTrie.erase(tasks[index].title);
+    markRewritten();
     tasks.erase(tasks.begin() + index);
+    searchColumn.invalidate();
+    foldedColumn.invalidate();
     return true;
 }
 
+void TaskManager::setResultCacheCapacity(size_t capacity) {
+    resultCache.setCapacity(capacity);
+}
+
+ResultCacheStats TaskManager::resultCacheStats() const {
+    lock_guard<mutex> lock(lazyStateMutex);
+    return resultCache.stats();
+}
+
+BlockSkipStats TaskManager::blockSkipStats() const {
+    BlockSkipStats total;
+    for (const auto& stats : { searchColumn.blockSkipStats(), foldedColumn.blockSkipStats(), zoneMaps.blockSkipStats() }) {
+        total.scanned += stats.scanned;
+        total.skipped += stats.skipped;
+    }
+    return total;
+}
+
+vector<string> TaskManager::suggestTitles(const string& prefix, size_t limit) const {
+    return titleTrie.complete(prefix, limit);
+}
+
 size_t TaskManager::getTaskCount() const {
     return tasks.size();
 }
 
 const Task& TaskManager::getTask(size_t index) const {
     return tasks.at(index);
+}
+
+const SearchColumn& TaskManager::searchColumnView(bool folded) const {
+    lock_guard<mutex> lock(lazyStateMutex);
+    auto& column = folded ? foldedColumn : searchColumn;
+    if (!column.isValid()) column.rebuild(tasks);
+    return column;
+}
+
+const CollationKeys& TaskManager::collationKeyView() const {
+    lock_guard<mutex> lock(lazyStateMutex);
+    if (!collationKeys.isValid()) collationKeys.rebuild(tasks);
+    return collationKeys;
+}
+
+const ZoneMaps& TaskManager::zoneMapView() const {
+    lock_guard<mutex> lock(lazyStateMutex);
+    zoneMaps.refresh(tasks);
+    return zoneMaps;
+}
+
+const vector<uint32_t>& TaskManager::titleOrderView() const {
+    lock_guard<mutex> lock(lazyStateMutex);
+    return titleOrder.indices(tasks);
+}
+
+void TaskManager::rebuildIndexes() {
+    markRewritten();
+    sortedBy.reset();
+    searchColumn.invalidate();
+    foldedColumn.invalidate();
+    zoneMaps.invalidate();
+    dateIndex.rebuild(tasks, [](const Task& task) { return dateKey(task.date); });
+    priorityIndex.rebuild(tasks, [](const Task& task) { return task.priority; });
+    titleOrder.rebuild(tasks);
+
+    vector<bool> completed(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) completed[i] = tasks[i].completed;
+    completion.rebuild(completed);
+}
+
+void TaskManager::rebuildTitleIndexes() {
+    termStatistics.clear();
+    titleTrie.clear();
+    for (const auto& task : tasks) {
+        termStatistics.addTitle(task.title);
+        titleTrie.insert(task.title);
+    }
+}
+
+void TaskManager::markRewritten() {
+    lastRewriteEpoch = ++mutationEpoch;
+}
+
+vector<size_t> TaskManager::cachedSearch(const string& key, const function<vector<size_t>()>& compute,
+    const function<void(size_t, size_t, vector<size_t>&)>& scanRange) const {
+    {
+        lock_guard<mutex> lock(lazyStateMutex);
+        auto* entry = resultCache.find(key);
+        if (entry && entry->epoch == mutationEpoch) {
+            ++resultCache.stats().hits;
+            return entry->indices;
+        }
+
+        // Only appends happened since the entry was computed: scan just the new tasks.
+        // The patch scans only read built views, so they may run under the lock.
+        if (entry && entry->epoch >= lastRewriteEpoch) {
+            ++resultCache.stats().patches;
+            scanRange(entry->taskCount, tasks.size(), entry->indices);
+            entry->epoch = mutationEpoch;
+            entry->taskCount = tasks.size();
+            return entry->indices;
+        }
+        ++resultCache.stats().misses;
+    }
+
+    // Computing may build views, which takes the lock again.
+    auto indices = compute();
+    lock_guard<mutex> lock(lazyStateMutex);
+    resultCache.store(key, { indices, mutationEpoch, tasks.size() });
+    return indices;
+}
+
+size_t TaskManager::scanKeyword(const string& keyword, size_t first, size_t last, vector<size_t>& out,
+    bool folded, size_t limit) const {
+    if (keyword.find('\0') == string::npos) {
+        return (folded ? foldedColumn : searchColumn).scan(keyword, first, last, out, limit);
+    }
+    size_t found = 0;
+    for (size_t i = first; i < last; ++i) {
+        if (found == limit) return i;
+        const auto contains = [&](const string& text) {
+            return (folded ? foldCase(text) : text).find(keyword) != string::npos;
+        };
+        if (contains(tasks[i].title) || contains(tasks[i].date)) {
+            out.push_back(i);
+            ++found;
+        }
+    }
+    return last;
 }
\ No newline at end of file
@@ -2,7 +2,23 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <type_traits>
 #include <algorithm>
+#include <mutex>
+#include <optional>
+#include "search_column.h"
+#include "key_index.h"
+#include "completion_bitmap.h"
+#include "result_cache.h"
+#include "ranking.h"
+#include "title_trie.h"
+#include "thread_pool.h"
+#include "search_cursor.h"
+#include "zone_map.h"
+#include "date_key.h"
+#include "title_order.h"
+#include "composite_key.h"
+#include "collation.h"
 
 using namespace std;
 
@@ -12,20 +28,245 @@ struct Task {
     int priority;   
     bool completed; 
 };
+
+struct FuzzyMatch {
+    size_t index;
+    int distance;
+};
+
+struct RankedMatch {
+    size_t index;
+    double score;
+};
+
+// BM25 score of a title is multiplied by (1 + priorityWeight * (priority - 1)) and by
+// (1 + dueWeight / (1 + days until due)); overdue tasks count as due today.
+struct RankingOptions {
+    double priorityWeight = 0.25;
+    double dueWeight = 1.0;
+    // Date key of "today"; 0 means the current date.
+    int todayKey = 0;
+};
+
+// Named sort orders for sortTasks. They are stateless functors, so sort() inlines the
+// comparison instead of calling through std::function; dates compare chronologically.
+struct ByPriorityAscending {
+    bool operator()(const Task& a, const Task& b) const { return a.priority < b.priority; }
+};
+
+struct ByPriorityDescending {
+    bool operator()(const Task& a, const Task& b) const { return a.priority > b.priority; }
+};
+
+struct ByDateAscending {
+    bool operator()(const Task& a, const Task& b) const { return dateKey(a.date) < dateKey(b.date); }
+};
+
+struct ByDateDescending {
+    bool operator()(const Task& a, const Task& b) const { return dateKey(a.date) > dateKey(b.date); }
+};
+
+struct ByTitle {
+    bool operator()(const Task& a, const Task& b) const { return a.title < b.title; }
+};
+
+// "What to do next": highest priority first, then the earliest due date.
+inline const vector<SortKey> mostUrgentFirst = { { SortField::Priority, true }, { SortField::Date } };
+
+// Title compares bytes; CollatedTitle is alphabetical order for Russian text, see
+// collationKey.
+enum class SortOrder { PriorityAscending, PriorityDescending, DateAscending, DateDescending, Title, CollatedTitle };
+
+// One line of the task file: "title,date,priority,completed". A line with fewer fields
+// parses to nullopt.
+string formatTaskLine(const Task& task);
+optional<Task> parseTaskLine(const string& line);
+
 class TaskManager {
 public:
     void addTask(const string& title, const string& date, int priority);
     void showTasks() const;   
+    // Lists tasks in the given order, numbered by their index as showTasks does.
+    void showTasks(SortOrder order) const;
     bool markCompleted(size_t index);    
     void saveToFile(const string& filename) const;    
     void loadFromFile(const string& filename);    
-    vector<size_t> findTaskIndices(const string& keyword) const;
-    void sortTasks(function<bool(const Task&, const Task&)> comparator);    
+    // With ignoreCase titles and dates are matched case-insensitively (see foldCase)
+    // against a case-folded copy of the column, at the speed of the exact search.
+    vector<size_t> findTaskIndices(const string& keyword, bool ignoreCase = false) const;
+    vector<size_t> findTaskIndicesMatching(const string& expression, bool ignoreCase = false) const;
+    // Lazy, resumable version of findTaskIndicesMatching for showing results page by
+    // page; skip(offset) and next(limit) give limit/offset paging.
+    SearchCursor searchCursor(const string& expression, bool ignoreCase = false) const;
+    // Continues a search from SearchCursor::token(); throws invalid_argument if the
+    // token is malformed or tasks were edited, deleted or reordered since.
+    SearchCursor resumeSearch(const string& token) const;
+    // Tasks whose title matches the regular expression (see Regex); throws
+    // invalid_argument on syntax errors.
+    vector<size_t> findTasksByRegex(const string& pattern) const;
+    vector<FuzzyMatch> findTasksFuzzy(const string& keyword, int maxDistance) const;
+    // Tasks due between two "DD.MM.YYYY" dates inclusive, in date order.
+    vector<size_t> findTasksInRange(const string& from, const string& to) const;
+    // The k best matches by BM25 relevance of title terms with priority and due date
+    // boosts, best first; runs in O(n log k).
+    vector<RankedMatch> findTopTasks(const string& query, size_t k, const RankingOptions& options = RankingOptions()) const;
+    // Structured query, see TaskQuery; throws invalid_argument on syntax errors.
+    vector<size_t> findTasksByQuery(const string& query) const;
+    // Runs the query and describes the chosen plan with estimated and actual row counts.
+    string explainQuery(const string& query) const;
+    // Existing titles starting with the prefix (case-insensitive), most used first.
+    vector<string> suggestTitles(const string& prefix, size_t limit = 5) const;
+    // All orders are stable: tasks that compare equal keep their relative order. Priority
+    // and date orders run as an O(n) radix sort on integer keys, title order as the
+    // packed-key sort of sortTasks(vector<SortKey>); either way tasks are then moved once
+    // each. Custom comparators use an adaptive merge sort (see timSort), close to O(n) on
+    // nearly sorted lists and parallel above parallelSortThreshold; so do key orders when
+    // only a few tasks are out of place. Sorting again by the order already in effect
+    // returns at once, see isSortedBy.
+    void sortTasks(SortOrder order);
+    // Multi-field order, e.g. { { SortField::Priority, true }, { SortField::Date }, { SortField::Title } }.
+    // Radix sorts one packed 64-bit key per task (see CompositeKey) and compares full
+    // titles only among tasks whose packed keys tie, so it costs about as much as one
+    // integer sort. Stable, like the other orders.
+    void sortTasks(const vector<SortKey>& keys);
+    // Lambdas and the By* functors are inlined into the sort; prefer this overload. The
+    // By* functors are dispatched to the key sorts of sortTasks(SortOrder).
+    template <class Compare, class = enable_if_t<is_invocable_r_v<bool, Compare&, const Task&, const Task&>>>
+    void sortTasks(Compare&& comparator) {
+        using Order = decay_t<Compare>;
+        if constexpr (is_same_v<Order, ByPriorityAscending>) sortTasks(SortOrder::PriorityAscending);
+        else if constexpr (is_same_v<Order, ByPriorityDescending>) sortTasks(SortOrder::PriorityDescending);
+        else if constexpr (is_same_v<Order, ByDateAscending>) sortTasks(SortOrder::DateAscending);
+        else if constexpr (is_same_v<Order, ByDateDescending>) sortTasks(SortOrder::DateDescending);
+        else if constexpr (is_same_v<Order, ByTitle>) sortTasks(SortOrder::Title);
+        else comparisonSort(comparator);
+    }
+    // Kept for callers that store comparators type-erased; every comparison is an
+    // indirect call.
+    void sortTasks(function<bool(const Task&, const Task&)> comparator);
+    // O(1): true while the tasks are still in the order of the last sortTasks by these
+    // keys or the matching SortOrder. addTask and editTask compare the changed task with
+    // its neighbours and drop the flag only when it lands out of place.
+    bool isSortedBy(const vector<SortKey>& keys) const;
+    // Indices of the first n tasks in the order, first first, with the storage order left
+    // alone: nth_element over packed keys (see CompositeKey), then a sort of just those n
+    // and the tasks tied with the last of them, so O(size + n log n) unless ties are
+    // many. Ties keep index order as in sortTasks. Completed tasks are
+    // left out unless includeCompleted.
+    vector<size_t> topTasks(size_t n, const vector<SortKey>& order = mostUrgentFirst, bool includeCompleted = false) const;
+    // Calls visit(index) for every task in the given order without moving any task, so
+    // indices stay valid. The orders are kept up to date by addTask, editTask and
+    // deleteTask, so switching between them runs no sort, except that CollatedTitle sorts
+    // indices by the cached collation keys. Orders are stable: equal keys come in index
+    // order.
+    template <class Visit>
+    void forEachInOrder(SortOrder order, Visit&& visit) const {
+        switch (order) {
+        case SortOrder::PriorityAscending: priorityIndex.forEach(false, visit); break;
+        case SortOrder::PriorityDescending: priorityIndex.forEach(true, visit); break;
+        case SortOrder::DateAscending: dateIndex.forEach(false, visit); break;
+        case SortOrder::DateDescending: dateIndex.forEach(true, visit); break;
+        case SortOrder::Title:
+            for (const uint32_t index : titleOrderView()) visit(index);
+            break;
+        case SortOrder::CollatedTitle:
+            for (const uint32_t index : collatedOrder()) visit(index);
+            break;
+        }
+    }
     bool editTask(size_t index, const string& newTitle = "", const string& newDate = "", int newPriority = -1);    
     bool deleteTask(size_t index);
+    // Keyword, expression and structured query results are cached per normalized query
+    // and reused until a mutation other than addTask happens.
+    void setResultCacheCapacity(size_t capacity);
+    ResultCacheStats resultCacheStats() const;
+    // Blocks of tasks scanned and skipped so far by keyword scans (trigram Bloom
+    // filters) and full query scans (zone maps).
+    BlockSkipStats blockSkipStats() const;
     size_t getTaskCount() const;
     const Task& getTask(size_t index) const;
 
 private:
+    friend class QueryPlanner;
+    friend class SearchCursor;
+
+    static constexpr size_t parallelScanThreshold = 1 << 15;
+    static constexpr size_t parallelSortThreshold = 1 << 16;
+    static constexpr size_t nearlySortedRatio = 1024;
+
+    void showTask(size_t index) const;
+    const SearchColumn& searchColumnView(bool folded = false) const;
+    const ZoneMaps& zoneMapView() const;
+    const CollationKeys& collationKeyView() const;
+    const vector<uint32_t>& titleOrderView() const;
+    // Task indices in CollatedTitle order, a radix sort of the cached collation keys.
+    vector<uint32_t> collatedOrder() const;
+    // Expects searchColumnView(folded) to have been called since the last mutation and
+    // a folded keyword when folded is set. Stops after limit matches and returns the
+    // task to resume from.
+    size_t scanKeyword(const string& keyword, size_t first, size_t last, vector<size_t>& out,
+        bool folded = false, size_t limit = SIZE_MAX) const;
+    // Positional indexes; rebuildTitleIndexes() covers the order-independent ones.
+    void rebuildIndexes();
+    // Stable sort; timSort and the parallel merge sort give the same order as
+    // stable_sort. Custom comparators sort the tasks themselves: sorting indices instead
+    // makes every comparison dereference two random tasks, which costs more than the
+    // moves it saves.
+    template <class Compare>
+    void comparisonSort(Compare& comparator) {
+        if (tasks.size() < parallelSortThreshold) timSort(tasks.begin(), tasks.end(), comparator);
+        else ThreadPool::shared().stableSort(tasks.begin(), tasks.end(), comparator);
+        collationKeys.invalidate();
+        rebuildIndexes();
+    }
+    // Moves tasks, and collation keys if built, into the order given as old indices (see
+    // applyPermutation), then rebuilds the indexes.
+    void reorderTasks(vector<uint32_t> order);
+    // Stable sort by integer key (see radixSortOrder), reversed order for descending.
+    void sortByKey(uint32_t (*keyOf)(const Task&), bool descending);
+    // Handles the cases where a key sort would not pay off: the list is still sorted by
+    // the keys, or out of order in at most one place per nearlySortedRatio tasks, which
+    // timSort merges in about linear time. Returns false if the list needs a full sort.
+    bool sortIfNearlySorted(const vector<SortKey>& keys);
+    // Forgets sortedBy if the task at index is out of order with its neighbours.
+    void checkSortedAround(size_t index);
+    void rebuildTitleIndexes();
+    void markRewritten();
+    vector<size_t> cachedSearch(const string& key, const function<vector<size_t>()>& compute,
+        const function<void(size_t, size_t, vector<size_t>&)>& scanRange) const;
+
+    // Runs scanRange(first, last, out) over all tasks; lists above parallelScanThreshold
+    // are split across the shared thread pool with the serial order preserved.
+    template <class Result = size_t, class ScanRange>
+    vector<Result> scanTasks(ScanRange&& scanRange) const {
+        if (tasks.size() < parallelScanThreshold) {
+            vector<Result> results;
+            scanRange(0, tasks.size(), results);
+            return results;
+        }
+        return ThreadPool::shared().scanChunks<Result>(tasks.size(), scanRange);
+    }
+
     vector<Task> tasks; 
+    mutable SearchColumn searchColumn;
+    mutable SearchColumn foldedColumn{ true };
+    mutable ZoneMaps zoneMaps;
+    // Positional like the indexes, but moved along by reorderTasks rather than rebuilt.
+    mutable CollationKeys collationKeys;
+    KeyIndex dateIndex;
+    KeyIndex priorityIndex;
+    TitleOrder titleOrder;
+    // Keys of the last key sort while the tasks are still in that order.
+    optional<vector<SortKey>> sortedBy;
+    CompletionBitmap completion;
+    mutable ResultCache resultCache;
+    TermStatistics termStatistics;
+    TitleTrie titleTrie;
+    uint64_t mutationEpoch = 0;
+    uint64_t lastRewriteEpoch = 0;
+    // Guards what const calls build or update lazily (the search columns, zone maps,
+    // collation keys, pending title order and result cache), so that const calls may run
+    // concurrently as long as no mutation does; see ConcurrentTaskManager. The *View()
+    // accessors take it; once built, a view is only read until the next mutation.
+    mutable mutex lazyStateMutex;
 };
\ No newline at end of file
@@ -0,0 +1,273 @@
+﻿#include "task_query.h"
+#include "date_key.h"
+#include "task_manager.h"
+#include <stdexcept>
+
+using namespace std;
+
+class TaskQuery::Parser {
+public:
+    Parser(const string& text, TaskQuery& query) : query(query) {
+        tokenize(text);
+    }
+
+    size_t parseAll() {
+        if (tokens.empty()) throw invalid_argument("empty query");
+        const size_t node = parseOr();
+        if (position != tokens.size()) throw invalid_argument("unexpected '" + tokens[position].text + "'");
+        return node;
+    }
+
+private:
+    struct Token {
+        string text;
+        bool quoted;
+    };
+
+    static bool isSeparator(char c) {
+        return c == ' ' || c == '\t' || c == '(' || c == ')';
+    }
+
+    // A token runs up to the next space or parenthesis outside quotes; quotes are
+    // removed, so `text:"buy milk"` becomes the single token `text:buy milk`.
+    void tokenize(const string& text) {
+        size_t i = 0;
+        while (i < text.size()) {
+            if (text[i] == ' ' || text[i] == '\t') {
+                ++i;
+                continue;
+            }
+            if (text[i] == '(' || text[i] == ')') {
+                tokens.push_back({ string(1, text[i++]), false });
+                continue;
+            }
+
+            Token token{ "", false };
+            while (i < text.size() && !isSeparator(text[i])) {
+                if (text[i] == '"') {
+                    const size_t close = text.find('"', i + 1);
+                    if (close == string::npos) throw invalid_argument("unterminated quote");
+                    token.text.append(text, i + 1, close - i - 1);
+                    token.quoted = true;
+                    i = close + 1;
+                }
+                else {
+                    token.text += text[i++];
+                }
+            }
+            tokens.push_back(token);
+        }
+    }
+
+    bool isOperator(const char* name) const {
+        return position < tokens.size() && !tokens[position].quoted && tokens[position].text == name;
+    }
+
+    bool startsOperand() const {
+        return position < tokens.size() && !isOperator("OR") && !isOperator("AND") && !isOperator(")");
+    }
+
+    size_t addNode(Kind kind, Predicate predicate, vector<size_t> children) {
+        query.nodes.push_back({ kind, move(predicate), move(children) });
+        return query.nodes.size() - 1;
+    }
+
+    size_t combine(Kind kind, size_t left, size_t right) {
+        if (query.nodes[left].kind != kind) left = addNode(kind, {}, { left });
+        query.nodes[left].children.push_back(right);
+        return left;
+    }
+
+    size_t parseOr() {
+        size_t node = parseAnd();
+        while (isOperator("OR")) {
+            ++position;
+            node = combine(Kind::Or, node, parseAnd());
+        }
+        return node;
+    }
+
+    size_t parseAnd() {
+        size_t node = parseUnary();
+        while (true) {
+            if (isOperator("AND")) ++position;
+            else if (!startsOperand()) return node;
+            node = combine(Kind::And, node, parseUnary());
+        }
+    }
+
+    size_t parseUnary() {
+        if (position == tokens.size()) throw invalid_argument("query ends unexpectedly");
+        if (isOperator("NOT")) {
+            ++position;
+            const size_t operand = parseUnary();
+            return addNode(Kind::Not, {}, { operand });
+        }
+        if (isOperator("(")) {
+            ++position;
+            const size_t node = parseOr();
+            if (!isOperator(")")) throw invalid_argument("missing ')'");
+            ++position;
+            return node;
+        }
+        if (isOperator(")") || isOperator("AND") || isOperator("OR")) {
+            throw invalid_argument("unexpected '" + tokens[position].text + "'");
+        }
+        return addNode(Kind::Predicate, parsePredicate(tokens[position++]), {});
+    }
+
+    static Predicate parsePredicate(const Token& token) {
+        const string& text = token.text;
+        const size_t nameEnd = text.find_first_of(":=!<>");
+        const string name = nameEnd == string::npos ? "" : text.substr(0, nameEnd);
+
+        Field field;
+        if (name == "priority") field = Field::Priority;
+        else if (name == "due") field = Field::Due;
+        else if (name == "completed") field = Field::Completed;
+        else if (name == "text" && text[nameEnd] == ':') return { Field::Text, Op::Equal, 0, text.substr(nameEnd + 1) };
+        else return { Field::Text, Op::Equal, 0, text };
+
+        size_t valueStart = nameEnd + 1;
+        Op op;
+        switch (text[nameEnd]) {
+        case ':': op = Op::Equal; break;
+        case '=': op = Op::Equal; break;
+        case '!':
+            if (text.compare(nameEnd, 2, "!=") != 0) throw invalid_argument("bad operator in '" + text + "'");
+            op = Op::NotEqual;
+            ++valueStart;
+            break;
+        case '<':
+            op = text.compare(nameEnd, 2, "<=") == 0 ? Op::LessEqual : Op::Less;
+            if (op == Op::LessEqual) ++valueStart;
+            break;
+        default:
+            op = text.compare(nameEnd, 2, ">=") == 0 ? Op::GreaterEqual : Op::Greater;
+            if (op == Op::GreaterEqual) ++valueStart;
+            break;
+        }
+        const string value = text.substr(valueStart);
+
+        if (field == Field::Completed) {
+            if (op != Op::Equal) throw invalid_argument("completed only supports ':'");
+            if (value == "yes" || value == "true" || value == "1") return { field, op, 1, "" };
+            if (value == "no" || value == "false" || value == "0") return { field, op, 0, "" };
+            throw invalid_argument("completed must be yes or no");
+        }
+        if (field == Field::Due) {
+            const int key = dateKey(value);
+            if (key == 0) throw invalid_argument("bad date '" + value + "', expected DD.MM.YYYY");
+            return { field, op, key, "" };
+        }
+
+        size_t parsed = 0;
+        int number = 0;
+        try {
+            number = stoi(value, &parsed);
+        }
+        catch (const exception&) {
+            parsed = 0;
+        }
+        if (value.empty() || parsed != value.size()) throw invalid_argument("bad priority '" + value + "'");
+        return { field, op, number, "" };
+    }
+
+    TaskQuery& query;
+    vector<Token> tokens;
+    size_t position = 0;
+};
+
+TaskQuery TaskQuery::parse(const string& text) {
+    TaskQuery query;
+    Parser parser(text, query);
+    query.rootNode = parser.parseAll();
+    return query;
+}
+
+bool TaskQuery::matches(const Task& task) const {
+    return matches(rootNode, task);
+}
+
+bool TaskQuery::matches(const Predicate& predicate, const Task& task) {
+    int actual;
+    switch (predicate.field) {
+    case Field::Text:
+        return task.title.find(predicate.text) != string::npos || task.date.find(predicate.text) != string::npos;
+    case Field::Completed:
+        return task.completed == (predicate.value != 0);
+    case Field::Due:
+        actual = dateKey(task.date);
+        if (actual == 0) return false;
+        break;
+    default:
+        actual = task.priority;
+        break;
+    }
+
+    switch (predicate.op) {
+    case Op::Equal: return actual == predicate.value;
+    case Op::NotEqual: return actual != predicate.value;
+    case Op::Less: return actual < predicate.value;
+    case Op::LessEqual: return actual <= predicate.value;
+    case Op::Greater: return actual > predicate.value;
+    case Op::GreaterEqual: return actual >= predicate.value;
+    }
+    return false;
+}
+
+size_t TaskQuery::root() const {
+    return rootNode;
+}
+
+const TaskQuery::Node& TaskQuery::node(size_t index) const {
+    return nodes[index];
+}
+
+string TaskQuery::toString() const {
+    return toString(rootNode);
+}
+
+string TaskQuery::toString(const Predicate& predicate) {
+    static const char* const operators[] = { "=", "!=", "<", "<=", ">", ">=" };
+    switch (predicate.field) {
+    case Field::Text: return "text:\"" + predicate.text + "\"";
+    case Field::Completed: return predicate.value ? "completed:yes" : "completed:no";
+    case Field::Due: return string("due") + operators[static_cast<int>(predicate.op)] + formatDateKey(predicate.value);
+    default: return string("priority") + operators[static_cast<int>(predicate.op)] + to_string(predicate.value);
+    }
+}
+
+bool TaskQuery::matches(size_t node, const Task& task) const {
+    const Node& current = nodes[node];
+    switch (current.kind) {
+    case Kind::Predicate:
+        return matches(current.predicate, task);
+    case Kind::Not:
+        return !matches(current.children[0], task);
+    case Kind::And:
+        for (size_t child : current.children) {
+            if (!matches(child, task)) return false;
+        }
+        return true;
+    case Kind::Or:
+        for (size_t child : current.children) {
+            if (matches(child, task)) return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+string TaskQuery::toString(size_t node) const {
+    const Node& current = nodes[node];
+    if (current.kind == Kind::Predicate) return toString(current.predicate);
+    if (current.kind == Kind::Not) return "NOT " + toString(current.children[0]);
+
+    string text = "(";
+    for (size_t i = 0; i < current.children.size(); ++i) {
+        if (i) text += current.kind == Kind::And ? " AND " : " OR ";
+        text += toString(current.children[i]);
+    }
+    return text + ")";
+}
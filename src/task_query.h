@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Task;
+
+// Structured task query, e.g. `priority>=2 completed:no due<01.05.2025 text:"milk"`.
+// Predicates: priority and due with = : != < <= > >=, completed:yes/no, text:<keyword>;
+// a bare word or "quoted phrase" is a text predicate. Predicates are combined with
+// AND (also implicit), OR, NOT and parentheses, like keyword expressions.
+class TaskQuery {
+public:
+    enum class Field { Priority, Due, Completed, Text };
+    enum class Op { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+    enum class Kind { Predicate, Not, And, Or };
+
+    struct Predicate {
+        Field field;
+        Op op;
+        int value;
+        string text;
+    };
+
+    struct Node {
+        Kind kind;
+        Predicate predicate;
+        vector<size_t> children;
+    };
+
+    // Throws invalid_argument on syntax errors.
+    static TaskQuery parse(const string& text);
+
+    bool matches(const Task& task) const;
+    static bool matches(const Predicate& predicate, const Task& task);
+
+    size_t root() const;
+    const Node& node(size_t index) const;
+    // Normalized form: predicates in canonical spelling, fully parenthesized.
+    string toString() const;
+    static string toString(const Predicate& predicate);
+
+private:
+    class Parser;
+
+    bool matches(size_t node, const Task& task) const;
+    string toString(size_t node) const;
+
+    vector<Node> nodes;
+    size_t rootNode = 0;
+};
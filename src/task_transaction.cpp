@@ -0,0 +1,216 @@
+﻿#include "task_transaction.h"
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+// Splits a line into exactly `count` comma-separated fields.
+vector<string> splitFields(const string& line, size_t count) {
+    vector<string> parts;
+    size_t start = 0;
+    for (size_t comma; (comma = line.find(',', start)) != string::npos; start = comma + 1) {
+        parts.push_back(line.substr(start, comma - start));
+    }
+    parts.push_back(line.substr(start));
+    if (parts.size() != count) throw invalid_argument("malformed transaction line: " + line);
+    return parts;
+}
+
+// Text fields are percent-encoded where they would break the record: the field separator,
+// line breaks (a line of its own could pass for the journal's commit line) and '%' itself.
+string escapeField(const string& text) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text) {
+        if (c == ',' || c == '\n' || c == '\r' || c == '%') {
+            escaped += '%';
+            escaped += hexDigits[static_cast<unsigned char>(c) >> 4];
+            escaped += hexDigits[c & 15];
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+string unescapeField(const string& field) {
+    const auto hexValue = [&](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        throw invalid_argument("malformed escape in transaction field: " + field);
+    };
+    string text;
+    text.reserve(field.size());
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] != '%') {
+            text += field[i];
+            continue;
+        }
+        if (i + 2 >= field.size()) throw invalid_argument("malformed escape in transaction field: " + field);
+        text += static_cast<char>(hexValue(field[i + 1]) * 16 + hexValue(field[i + 2]));
+        i += 2;
+    }
+    return text;
+}
+
+size_t parseIndex(const string& text) {
+    if (text.empty() || text.find_first_not_of("0123456789") != string::npos) {
+        throw invalid_argument("malformed task index: " + text);
+    }
+    return stoull(text);
+}
+
+}
+
+void TaskTransaction::addTask(const string& title, const string& date, int priority) {
+    auto& change = push(Kind::Add);
+    change.title = title;
+    change.date = date;
+    change.priority = priority;
+}
+
+void TaskTransaction::editTask(size_t index, const string& newTitle, const string& newDate, int newPriority) {
+    auto& change = push(Kind::Edit, index);
+    change.title = newTitle;
+    change.date = newDate;
+    change.priority = newPriority;
+}
+
+void TaskTransaction::deleteTask(size_t index) {
+    push(Kind::Delete, index);
+}
+
+void TaskTransaction::markCompleted(size_t index) {
+    push(Kind::Complete, index);
+}
+
+void TaskTransaction::sortTasks(SortOrder order) {
+    push(Kind::Sort).order = order;
+}
+
+void TaskTransaction::sortTasks(const vector<SortKey>& keys) {
+    push(Kind::SortByKeys).keys = keys;
+}
+
+size_t TaskTransaction::size() const {
+    return changes.size();
+}
+
+bool TaskTransaction::empty() const {
+    return changes.empty();
+}
+
+void TaskTransaction::clear() {
+    changes.clear();
+}
+
+bool TaskTransaction::validFor(size_t taskCount) const {
+    for (const auto& change : changes) {
+        switch (change.kind) {
+        case Kind::Add: ++taskCount; break;
+        case Kind::Delete:
+            if (change.index >= taskCount) return false;
+            --taskCount;
+            break;
+        case Kind::Edit:
+        case Kind::Complete:
+            if (change.index >= taskCount) return false;
+            break;
+        case Kind::Sort:
+        case Kind::SortByKeys: break;
+        }
+    }
+    return true;
+}
+
+void TaskTransaction::applyTo(TaskManager& manager) const {
+    for (const auto& change : changes) {
+        switch (change.kind) {
+        case Kind::Add: manager.addTask(change.title, change.date, change.priority); break;
+        case Kind::Edit: manager.editTask(change.index, change.title, change.date, change.priority); break;
+        case Kind::Delete: manager.deleteTask(change.index); break;
+        case Kind::Complete: manager.markCompleted(change.index); break;
+        case Kind::Sort: manager.sortTasks(change.order); break;
+        case Kind::SortByKeys: manager.sortTasks(change.keys); break;
+        }
+    }
+}
+
+string TaskTransaction::serialize() const {
+    ostringstream out;
+    for (const auto& change : changes) {
+        switch (change.kind) {
+        case Kind::Add:
+            out << "add," << change.priority << "," << escapeField(change.date) << "," << escapeField(change.title);
+            break;
+        case Kind::Edit:
+            out << "edit," << change.index << "," << change.priority << "," << escapeField(change.date) << ","
+                << escapeField(change.title);
+            break;
+        case Kind::Delete: out << "delete," << change.index; break;
+        case Kind::Complete: out << "complete," << change.index; break;
+        case Kind::Sort: out << "sort," << static_cast<int>(change.order); break;
+        case Kind::SortByKeys:
+            out << "sortby";
+            for (const auto& key : change.keys) out << "," << static_cast<int>(key.field) << (key.descending ? '-' : '+');
+            break;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+TaskTransaction::Change& TaskTransaction::push(Kind kind, size_t index) {
+    changes.emplace_back();
+    changes.back().kind = kind;
+    changes.back().index = index;
+    return changes.back();
+}
+
+TaskTransaction TaskTransaction::parse(const string& record) {
+    TaskTransaction transaction;
+    istringstream in(record);
+    string line;
+    while (getline(in, line)) {
+        const string kind = line.substr(0, line.find(','));
+        if (kind == "add") {
+            const auto fields = splitFields(line, 4);
+            transaction.addTask(unescapeField(fields[3]), unescapeField(fields[2]), stoi(fields[1]));
+        }
+        else if (kind == "edit") {
+            const auto fields = splitFields(line, 5);
+            transaction.editTask(parseIndex(fields[1]), unescapeField(fields[4]), unescapeField(fields[3]), stoi(fields[2]));
+        }
+        else if (kind == "delete") {
+            transaction.deleteTask(parseIndex(splitFields(line, 2)[1]));
+        }
+        else if (kind == "complete") {
+            transaction.markCompleted(parseIndex(splitFields(line, 2)[1]));
+        }
+        else if (kind == "sort") {
+            const int order = stoi(splitFields(line, 2)[1]);
+            if (order < 0 || order > static_cast<int>(SortOrder::CollatedTitle)) throw invalid_argument("unknown sort order: " + line);
+            transaction.sortTasks(static_cast<SortOrder>(order));
+        }
+        else if (kind == "sortby") {
+            vector<SortKey> keys;
+            istringstream fields(line.substr(kind.size()));
+            string field;
+            while (getline(fields, field, ',')) {
+                if (field.empty()) continue;
+                const bool known = field.size() == 2 && field[0] >= '0' && field[0] <= '2' && (field[1] == '+' || field[1] == '-');
+                if (!known) throw invalid_argument("malformed sort key: " + line);
+                keys.push_back({ static_cast<SortField>(field[0] - '0'), field[1] == '-' });
+            }
+            transaction.sortTasks(keys);
+        }
+        else {
+            throw invalid_argument("unknown transaction line: " + line);
+        }
+    }
+    return transaction;
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "task_manager.h"
+
+using namespace std;
+
+// Changes to a task list buffered to be applied together. Indices refer to the list as
+// the earlier changes of the same transaction leave it; a transaction either fits a list
+// as a whole (validFor) or is not applied at all.
+class TaskTransaction {
+public:
+    void addTask(const string& title, const string& date, int priority);
+    void editTask(size_t index, const string& newTitle = "", const string& newDate = "", int newPriority = -1);
+    void deleteTask(size_t index);
+    void markCompleted(size_t index);
+    void sortTasks(SortOrder order);
+    void sortTasks(const vector<SortKey>& keys);
+
+    size_t size() const;
+    bool empty() const;
+    void clear();
+
+    // True if every index is in range, in order, for a list of taskCount tasks.
+    bool validFor(size_t taskCount) const;
+    // Applies the changes in order; check validFor first, an index out of range is skipped.
+    void applyTo(TaskManager& manager) const;
+
+    // One line per change, e.g. "edit,3,-1,,New title". Commas, line breaks and '%' in
+    // dates and titles are percent-encoded, e.g. "Pay bills%2C rent".
+    string serialize() const;
+    // Inverse of serialize; throws invalid_argument on a malformed line.
+    static TaskTransaction parse(const string& record);
+
+private:
+    enum class Kind { Add, Edit, Delete, Complete, Sort, SortByKeys };
+
+    struct Change {
+        Kind kind = Kind::Add;
+        size_t index = 0;
+        string title;
+        string date;
+        int priority = -1;
+        SortOrder order = SortOrder::PriorityAscending;
+        vector<SortKey> keys;
+    };
+
+    Change& push(Kind kind, size_t index = 0);
+
+    vector<Change> changes;
+};
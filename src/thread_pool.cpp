@@ -0,0 +1,98 @@
+﻿#include "thread_pool.h"
+
+using namespace std;
+
+namespace {
+thread_local bool insidePoolJob = false;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = 1;
+    for (size_t i = 1; i < threadCount; ++i) workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopping = true;
+    }
+    batchReady.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+size_t ThreadPool::size() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::run(size_t jobCount, const function<void(size_t)>& job) {
+    if (jobCount == 0) return;
+    if (insidePoolJob || workers.empty() || jobCount == 1) {
+        for (size_t i = 0; i < jobCount; ++i) job(i);
+        return;
+    }
+
+    Batch batch(job, jobCount);
+    {
+        lock_guard<mutex> lock(stateMutex);
+        queue.push_back(&batch);
+    }
+    batchReady.notify_all();
+
+    while (true) {
+        size_t index;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            if (batch.next == batch.total) break;
+            index = claim(batch);
+        }
+        execute(batch, index);
+    }
+
+    unique_lock<mutex> lock(stateMutex);
+    batchDone.wait(lock, [&] { return batch.finished == batch.total; });
+    if (batch.failure) rethrow_exception(batch.failure);
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        Batch* batch;
+        size_t index;
+        {
+            unique_lock<mutex> lock(stateMutex);
+            batchReady.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            batch = queue.front();
+            index = claim(*batch);
+        }
+        execute(*batch, index);
+    }
+}
+
+size_t ThreadPool::claim(Batch& batch) {
+    const size_t index = batch.next++;
+    if (batch.next == batch.total) queue.erase(find(queue.begin(), queue.end(), &batch));
+    return index;
+}
+
+void ThreadPool::execute(Batch& batch, size_t index) {
+    exception_ptr error;
+    insidePoolJob = true;
+    try {
+        (*batch.job)(index);
+    }
+    catch (...) {
+        error = current_exception();
+    }
+    insidePoolJob = false;
+
+    // Notified under the lock: once the owner sees the batch finished it may return and
+    // destroy it, so nothing here may touch the batch after the lock is released.
+    lock_guard<mutex> lock(stateMutex);
+    if (error && !batch.failure) batch.failure = error;
+    if (++batch.finished == batch.total) batchDone.notify_all();
+}
@@ -0,0 +1,165 @@
+﻿#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "tim_sort.h"
+
+using namespace std;
+
+// Fixed set of worker threads that execute batches of indexed jobs.
+// run() blocks until every job of the batch is finished; the calling thread
+// takes jobs as well, and a run() issued from inside a job executes inline.
+// Batches from different threads are queued and run side by side: each caller works
+// through its own batch while idle workers help the oldest one, so one caller never
+// waits for another's batch to finish. The first exception thrown by a job is rethrown
+// from run().
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+    void run(size_t jobCount, const function<void(size_t)>& job);
+
+    // Splits [0, count) into chunks, lets scanRange(first, last, out) fill one vector
+    // per chunk and concatenates them in order, so the result equals a serial scan.
+    template <class Result, class ScanRange>
+    vector<Result> scanChunks(size_t count, ScanRange&& scanRange);
+
+    // Stable merge sort of a contiguous range: one run per thread is sorted with
+    // timSort, then runs are merged pairwise, each merge split across the threads at
+    // merge-path split points. The result equals stable_sort(first, last, compare).
+    // Elements must be default constructible and movable.
+    template <class Iterator, class Compare>
+    void stableSort(Iterator first, Iterator last, Compare compare);
+
+    static ThreadPool& shared();
+
+private:
+    // One run() call; lives on the caller's stack until all its jobs are finished.
+    struct Batch {
+        Batch(const function<void(size_t)>& job, size_t total) : job(&job), total(total) {}
+
+        const function<void(size_t)>* job;
+        size_t total;
+        size_t next = 0;
+        size_t finished = 0;
+        exception_ptr failure;
+    };
+
+    void workerLoop();
+    // Claims the next job of the batch under stateMutex, taking the batch off the queue
+    // once every job is claimed.
+    size_t claim(Batch& batch);
+    void execute(Batch& batch, size_t index);
+
+    vector<thread> workers;
+    mutex stateMutex;
+    condition_variable batchReady;
+    condition_variable batchDone;
+    // Batches with unclaimed jobs, oldest first.
+    deque<Batch*> queue;
+    bool stopping = false;
+};
+
+template <class Result, class ScanRange>
+vector<Result> ThreadPool::scanChunks(size_t count, ScanRange&& scanRange) {
+    const size_t chunkCount = size() == 1 ? 1 : size() * 4;
+    vector<vector<Result>> chunks(chunkCount);
+    run(chunkCount, [&](size_t chunk) {
+        scanRange(count * chunk / chunkCount, count * (chunk + 1) / chunkCount, chunks[chunk]);
+    });
+    if (chunkCount == 1) return move(chunks[0]);
+
+    size_t total = 0;
+    for (const auto& chunk : chunks) total += chunk.size();
+    vector<Result> results;
+    results.reserve(total);
+    for (auto& chunk : chunks) results.insert(results.end(), make_move_iterator(chunk.begin()), make_move_iterator(chunk.end()));
+    return results;
+}
+
+template <class Iterator, class Compare>
+void ThreadPool::stableSort(Iterator first, Iterator last, Compare compare) {
+    using Value = typename iterator_traits<Iterator>::value_type;
+    const size_t count = last - first;
+    const size_t runCount = min(size(), count / 1024);
+    if (runCount < 2) {
+        timSort(first, last, compare);
+        return;
+    }
+
+    vector<size_t> bounds(runCount + 1);
+    for (size_t i = 0; i <= runCount; ++i) bounds[i] = count * i / runCount;
+    Value* source = &*first;
+    run(runCount, [&](size_t i) { timSort(source + bounds[i], source + bounds[i + 1], compare); });
+
+    // One merge job writes output [outFirst, outLast) of merging left [left, middle)
+    // with right [middle, right); ties take the left element, as stable_sort does.
+    struct Piece {
+        size_t left, middle, right, outFirst, outLast;
+    };
+    // Index into the left run of the first output element at position `rank` of a merge.
+    const auto coRank = [&](const Value* data, const Piece& merge, size_t rank) {
+        const size_t leftSize = merge.middle - merge.left;
+        const size_t rightSize = merge.right - merge.middle;
+        size_t low = rank > rightSize ? rank - rightSize : 0;
+        size_t high = min(rank, leftSize);
+        while (low < high) {
+            const size_t mid = (low + high) / 2;
+            if (!compare(data[merge.middle + rank - mid - 1], data[merge.left + mid])) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    };
+
+    vector<Value> buffer(count);
+    Value* target = buffer.data();
+    while (bounds.size() > 2) {
+        vector<Piece> pieces;
+        vector<size_t> merged;
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+            // An odd run out is merged with an empty right run, which just moves it.
+            const Piece pair{ bounds[i], bounds[i + 1], i + 2 < bounds.size() ? bounds[i + 2] : bounds[i + 1], 0, 0 };
+            const size_t length = pair.right - pair.left;
+            const size_t pieceCount = max<size_t>(1, (length * size() + count - 1) / count);
+            for (size_t piece = 0; piece < pieceCount; ++piece) {
+                pieces.push_back(pair);
+                pieces.back().outFirst = length * piece / pieceCount;
+                pieces.back().outLast = length * (piece + 1) / pieceCount;
+            }
+        }
+        merged.push_back(count);
+
+        run(pieces.size(), [&](size_t index) {
+            const Piece& piece = pieces[index];
+            const size_t leftFirst = piece.left + coRank(source, piece, piece.outFirst);
+            const size_t leftLast = piece.left + coRank(source, piece, piece.outLast);
+            const size_t rightFirst = piece.middle + piece.outFirst - (leftFirst - piece.left);
+            const size_t rightLast = piece.middle + piece.outLast - (leftLast - piece.left);
+            merge(make_move_iterator(source + leftFirst), make_move_iterator(source + leftLast),
+                make_move_iterator(source + rightFirst), make_move_iterator(source + rightLast),
+                target + piece.left + piece.outFirst, compare);
+        });
+        bounds.swap(merged);
+        swap(source, target);
+    }
+
+    if (source != &*first) {
+        Value* destination = &*first;
+        const size_t chunkCount = size();
+        run(chunkCount, [&](size_t chunk) {
+            move(source + count * chunk / chunkCount, source + count * (chunk + 1) / chunkCount, destination + count * chunk / chunkCount);
+        });
+    }
+}
@@ -0,0 +1,315 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Stable adaptive merge sort after Tim Peters' listsort: the input is cut into natural
+// runs (strictly descending ones are reversed), short runs are extended to a minimum
+// length by binary insertion, and runs are merged under the usual stack invariants.
+// Merges gallop once one side keeps winning, so nearly sorted input costs close to
+// O(n) comparisons and moves, random input O(n log n). Same result as stable_sort.
+template <class Iterator, class Compare>
+class TimSort {
+public:
+    TimSort(Iterator first, Compare compare) : base(first), compare(compare) {}
+
+    void sort(size_t count) {
+        if (count < 2) return;
+        if (count < minMerge) {
+            binaryInsertionSort(0, count, countRun(0, count));
+            return;
+        }
+
+        const size_t minRun = minRunLength(count);
+        for (size_t low = 0; low < count;) {
+            size_t length = countRun(low, count);
+            if (length < minRun) {
+                const size_t forced = min(minRun, count - low);
+                binaryInsertionSort(low, low + forced, low + length);
+                length = forced;
+            }
+            runs.push_back({ low, length });
+            mergeCollapse();
+            low += length;
+        }
+        while (runs.size() > 1) {
+            size_t n = runs.size() - 2;
+            if (n > 0 && runs[n - 1].length < runs[n + 1].length) --n;
+            mergeAt(n);
+        }
+    }
+
+private:
+    using Value = typename iterator_traits<Iterator>::value_type;
+
+    struct Run {
+        size_t start;
+        size_t length;
+    };
+
+    static constexpr size_t minMerge = 32;
+    static constexpr size_t initialMinGallop = 7;
+
+    static size_t minRunLength(size_t count) {
+        size_t carry = 0;
+        while (count >= minMerge) {
+            carry |= count & 1;
+            count >>= 1;
+        }
+        return count + carry;
+    }
+
+    // Length of the run starting at low; a strictly descending run is reversed in place.
+    size_t countRun(size_t low, size_t high) {
+        size_t end = low + 1;
+        if (end == high) return 1;
+        if (compare(base[end], base[low])) {
+            while (++end < high && compare(base[end], base[end - 1])) {}
+            reverse(base + low, base + end);
+        }
+        else {
+            while (++end < high && !compare(base[end], base[end - 1])) {}
+        }
+        return end - low;
+    }
+
+    // Sorts [low, high) given that [low, start) is sorted; equal elements go after.
+    void binaryInsertionSort(size_t low, size_t high, size_t start) {
+        for (; start < high; ++start) {
+            Value pivot = move(base[start]);
+            const Iterator slot = upper_bound(base + low, base + start, pivot, compare);
+            move_backward(slot, base + start, base + start + 1);
+            *slot = move(pivot);
+        }
+    }
+
+    void mergeCollapse() {
+        while (runs.size() > 1) {
+            size_t n = runs.size() - 2;
+            if ((n > 0 && runs[n - 1].length <= runs[n].length + runs[n + 1].length)
+                || (n > 1 && runs[n - 2].length <= runs[n - 1].length + runs[n].length)) {
+                if (runs[n - 1].length < runs[n + 1].length) --n;
+            }
+            else if (runs[n].length > runs[n + 1].length) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+    void mergeAt(size_t i) {
+        size_t start1 = runs[i].start, length1 = runs[i].length;
+        const size_t start2 = runs[i + 1].start;
+        size_t length2 = runs[i + 1].length;
+        runs[i].length = length1 + length2;
+        runs.erase(runs.begin() + i + 1);
+
+        // Elements of run 1 not greater than run 2's first, and of run 2 not less than
+        // run 1's last, are already in place.
+        const size_t skipped = gallopRight(base[start2], base + start1, length1, 0);
+        start1 += skipped;
+        length1 -= skipped;
+        if (length1 == 0) return;
+        length2 = gallopLeft(base[start1 + length1 - 1], base + start2, length2, length2 - 1);
+        if (length2 == 0) return;
+
+        if (length1 <= length2) mergeLow(start1, length1, start2, length2);
+        else mergeHigh(start1, length1, start2, length2);
+    }
+
+    // First position in a[0, length) whose element is not less than key, galloping
+    // outward from hint before a binary search.
+    template <class RangeIterator>
+    size_t gallopLeft(const Value& key, RangeIterator a, size_t length, size_t hint) {
+        size_t lastOffset = 0, offset = 1;
+        if (compare(a[hint], key)) {
+            const size_t maxOffset = length - hint;
+            while (offset < maxOffset && compare(a[hint + offset], key)) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            offset = min(offset, maxOffset);
+            return lower_bound(a + hint + lastOffset + 1, a + hint + offset, key, compare) - a;
+        }
+        const size_t maxOffset = hint + 1;
+        while (offset < maxOffset && !compare(a[hint - offset], key)) {
+            lastOffset = offset;
+            offset = offset * 2 + 1;
+        }
+        offset = min(offset, maxOffset);
+        return lower_bound(a + (hint + 1 - offset), a + (hint - lastOffset), key, compare) - a;
+    }
+
+    // First position in a[0, length) whose element is greater than key.
+    template <class RangeIterator>
+    size_t gallopRight(const Value& key, RangeIterator a, size_t length, size_t hint) {
+        size_t lastOffset = 0, offset = 1;
+        if (compare(key, a[hint])) {
+            const size_t maxOffset = hint + 1;
+            while (offset < maxOffset && compare(key, a[hint - offset])) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            offset = min(offset, maxOffset);
+            return upper_bound(a + (hint + 1 - offset), a + (hint - lastOffset), key, compare) - a;
+        }
+        const size_t maxOffset = length - hint;
+        while (offset < maxOffset && !compare(key, a[hint + offset])) {
+            lastOffset = offset;
+            offset = offset * 2 + 1;
+        }
+        offset = min(offset, maxOffset);
+        return upper_bound(a + hint + lastOffset + 1, a + hint + offset, key, compare) - a;
+    }
+
+    // Merges left to right with run 1 (the shorter) in the buffer. As set up by mergeAt,
+    // run 2 starts with an element less than run 1's first, and run 1 ends with an
+    // element greater than all of run 2.
+    void mergeLow(size_t start1, size_t length1, size_t start2, size_t length2) {
+        buffer.assign(make_move_iterator(base + start1), make_move_iterator(base + start1 + length1));
+        auto cursor1 = buffer.begin();
+        Iterator cursor2 = base + start2;
+        Iterator dest = base + start1;
+
+        *dest++ = move(*cursor2++);
+        --length2;
+        const auto merge = [&] {
+            if (length2 == 0 || length1 == 1) return;
+            while (true) {
+                size_t wins1 = 0, wins2 = 0;
+                do {
+                    if (compare(*cursor2, *cursor1)) {
+                        *dest++ = move(*cursor2++);
+                        ++wins2;
+                        wins1 = 0;
+                        if (--length2 == 0) return;
+                    }
+                    else {
+                        *dest++ = move(*cursor1++);
+                        ++wins1;
+                        wins2 = 0;
+                        if (--length1 == 1) return;
+                    }
+                } while ((wins1 | wins2) < minGallop);
+
+                do {
+                    wins1 = gallopRight(*cursor2, cursor1, length1, 0);
+                    if (wins1) {
+                        dest = move(cursor1, cursor1 + wins1, dest);
+                        cursor1 += wins1;
+                        length1 -= wins1;
+                        if (length1 <= 1) return;
+                    }
+                    *dest++ = move(*cursor2++);
+                    if (--length2 == 0) return;
+
+                    wins2 = gallopLeft(*cursor1, cursor2, length2, 0);
+                    if (wins2) {
+                        dest = move(cursor2, cursor2 + wins2, dest);
+                        cursor2 += wins2;
+                        length2 -= wins2;
+                        if (length2 == 0) return;
+                    }
+                    *dest++ = move(*cursor1++);
+                    if (--length1 == 1) return;
+                    if (minGallop > 1) --minGallop;
+                } while (wins1 >= initialMinGallop || wins2 >= initialMinGallop);
+                minGallop += 2;
+            }
+        };
+        merge();
+
+        if (length2 == 0) {
+            move(cursor1, cursor1 + length1, dest);
+        }
+        else {
+            dest = move(cursor2, cursor2 + length2, dest);
+            if (length1) *dest = move(*cursor1);
+        }
+    }
+
+    // Mirror of mergeLow, right to left with run 2 (the shorter) in the buffer. Positions
+    // are signed, since cursors step to one before their run.
+    void mergeHigh(size_t start1, size_t length1, size_t start2, size_t length2) {
+        buffer.assign(make_move_iterator(base + start2), make_move_iterator(base + start2 + length2));
+        const Iterator run1 = base + start1;
+        ptrdiff_t cursor1 = static_cast<ptrdiff_t>(length1) - 1;
+        ptrdiff_t cursor2 = static_cast<ptrdiff_t>(length2) - 1;
+        ptrdiff_t dest = static_cast<ptrdiff_t>(length1 + length2) - 1;
+
+        run1[dest--] = move(run1[cursor1--]);
+        --length1;
+        const auto merge = [&] {
+            if (length1 == 0 || length2 == 1) return;
+            while (true) {
+                size_t wins1 = 0, wins2 = 0;
+                do {
+                    if (compare(buffer[cursor2], run1[cursor1])) {
+                        run1[dest--] = move(run1[cursor1--]);
+                        ++wins1;
+                        wins2 = 0;
+                        if (--length1 == 0) return;
+                    }
+                    else {
+                        run1[dest--] = move(buffer[cursor2--]);
+                        ++wins2;
+                        wins1 = 0;
+                        if (--length2 == 1) return;
+                    }
+                } while ((wins1 | wins2) < minGallop);
+
+                do {
+                    wins1 = length1 - gallopRight(buffer[cursor2], run1, length1, length1 - 1);
+                    if (wins1) {
+                        dest -= static_cast<ptrdiff_t>(wins1);
+                        cursor1 -= static_cast<ptrdiff_t>(wins1);
+                        move_backward(run1 + (cursor1 + 1), run1 + (cursor1 + 1) + wins1, run1 + (dest + 1) + wins1);
+                        length1 -= wins1;
+                        if (length1 == 0) return;
+                    }
+                    run1[dest--] = move(buffer[cursor2--]);
+                    if (--length2 == 1) return;
+
+                    wins2 = length2 - gallopLeft(run1[cursor1], buffer.begin(), length2, length2 - 1);
+                    if (wins2) {
+                        dest -= static_cast<ptrdiff_t>(wins2);
+                        cursor2 -= static_cast<ptrdiff_t>(wins2);
+                        move(buffer.begin() + (cursor2 + 1), buffer.begin() + (cursor2 + 1) + wins2, run1 + (dest + 1));
+                        length2 -= wins2;
+                        if (length2 <= 1) return;
+                    }
+                    run1[dest--] = move(run1[cursor1--]);
+                    if (--length1 == 0) return;
+                    if (minGallop > 1) --minGallop;
+                } while (wins1 >= initialMinGallop || wins2 >= initialMinGallop);
+                minGallop += 2;
+            }
+        };
+        merge();
+
+        if (length1 == 0) {
+            move(buffer.begin(), buffer.begin() + length2, run1 + (dest + 1 - static_cast<ptrdiff_t>(length2)));
+        }
+        else {
+            dest -= static_cast<ptrdiff_t>(length1);
+            cursor1 -= static_cast<ptrdiff_t>(length1);
+            move_backward(run1 + (cursor1 + 1), run1 + (cursor1 + 1) + length1, run1 + (dest + 1) + length1);
+            if (length2) run1[dest] = move(buffer[cursor2]);
+        }
+    }
+
+    Iterator base;
+    Compare compare;
+    vector<Run> runs;
+    vector<Value> buffer;
+    size_t minGallop = initialMinGallop;
+};
+
+template <class Iterator, class Compare>
+void timSort(Iterator first, Iterator last, Compare compare) {
+    TimSort<Iterator, Compare>(first, compare).sort(last - first);
+}
@@ -0,0 +1,57 @@
+﻿#include "title_order.h"
+#include "task_manager.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+struct TitleBefore {
+    const vector<Task>& tasks;
+
+    bool operator()(uint32_t a, uint32_t b) const {
+        const int order = tasks[a].title.compare(tasks[b].title);
+        return order < 0 || (order == 0 && a < b);
+    }
+};
+
+}
+
+void TitleOrder::rebuild(const vector<Task>& tasks) {
+    sorted.clear();
+    pending.resize(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) pending[i] = static_cast<uint32_t>(i);
+}
+
+void TitleOrder::insert(size_t index) {
+    pending.push_back(static_cast<uint32_t>(index));
+}
+
+void TitleOrder::remove(const vector<Task>& tasks, size_t index) {
+    const auto entry = static_cast<uint32_t>(index);
+    const auto waiting = find(pending.begin(), pending.end(), entry);
+    if (waiting != pending.end()) {
+        pending.erase(waiting);
+        return;
+    }
+    sorted.erase(lower_bound(sorted.begin(), sorted.end(), entry, TitleBefore{ tasks }));
+}
+
+void TitleOrder::erase(const vector<Task>& tasks, size_t index) {
+    remove(tasks, index);
+    for (auto* entries : { &sorted, &pending }) {
+        for (auto& entry : *entries) entry -= entry > index;
+    }
+}
+
+const vector<uint32_t>& TitleOrder::indices(const vector<Task>& tasks) const {
+    if (pending.empty()) return sorted;
+
+    const TitleBefore before{ tasks };
+    sort(pending.begin(), pending.end(), before);
+    const size_t middle = sorted.size();
+    sorted.insert(sorted.end(), pending.begin(), pending.end());
+    inplace_merge(sorted.begin(), sorted.begin() + middle, sorted.end(), before);
+    pending.clear();
+    return sorted;
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+struct Task;
+
+// Task indices ordered by title, equal titles in index order, as one sorted array of
+// 32-bit indices. Added and edited tasks wait in a pending list that the next read
+// sorts and merges in, so a burst of additions costs one sort instead of one array
+// insertion each. Every call takes the current task list, since titles are read from it.
+class TitleOrder {
+public:
+    void rebuild(const vector<Task>& tasks);
+    void insert(size_t index);
+    // Call while tasks[index] still has the title the order was built with.
+    void remove(const vector<Task>& tasks, size_t index);
+    // Removes a task about to be deleted and renumbers the tasks that follow it.
+    void erase(const vector<Task>& tasks, size_t index);
+
+    const vector<uint32_t>& indices(const vector<Task>& tasks) const;
+
+private:
+    mutable vector<uint32_t> sorted;
+    mutable vector<uint32_t> pending;
+};
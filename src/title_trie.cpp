@@ -0,0 +1,262 @@
+﻿#include "title_trie.h"
+#include "case_fold.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+}
+
+string normalizeTitle(string_view title) {
+    string normalized;
+    normalized.reserve(title.size());
+    bool pendingSpace = false;
+    for (const char c : title) {
+        if (isSpace(c)) {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) normalized += ' ';
+        pendingSpace = false;
+        normalized += c;
+    }
+    return foldCase(normalized);
+}
+
+TitleTrie::TitleTrie(size_t suggestionLimit) : suggestionLimit(suggestionLimit) {
+    clear();
+}
+
+void TitleTrie::insert(string_view title) {
+    const string key = normalizeTitle(title);
+    if (key.empty()) return;
+    const auto fits = [&] { return labels.size() + key.size() <= none && titles.size() + title.size() <= none; };
+    if (!fits()) compact();
+    if (!fits()) throw length_error("title trie arenas are full");
+
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        const uint32_t child = findChild(node, key[pos]);
+        if (child == none) {
+            const uint32_t leaf = newNode(static_cast<uint32_t>(labels.size()), static_cast<uint32_t>(key.size() - pos));
+            labels.append(key, pos, string::npos);
+            linkChild(node, leaf);
+            node = leaf;
+            break;
+        }
+        const string_view label(labels.data() + nodes[child].labelOffset, nodes[child].labelLength);
+        size_t common = 0;
+        while (common < label.size() && pos + common < key.size() && label[common] == key[pos + common]) ++common;
+        node = common < label.size() ? splitEdge(child, static_cast<uint32_t>(common)) : child;
+        pos += common;
+    }
+
+    Node& terminal = nodes[node];
+    if (terminal.uses++ == 0) {
+        const size_t start = title.find_first_not_of(" \t");
+        const string_view trimmed = title.substr(start, title.find_last_not_of(" \t") - start + 1);
+        terminal.titleOffset = static_cast<uint32_t>(titles.size());
+        terminal.titleLength = static_cast<uint32_t>(trimmed.size());
+        titles.append(trimmed);
+        ++distinctTitles;
+    }
+    promote(node);
+}
+
+void TitleTrie::erase(string_view title) {
+    uint32_t matched = 0;
+    uint32_t node = descend(normalizeTitle(title), matched);
+    if (node == none || node == 0 || matched != nodes[node].labelLength || nodes[node].uses == 0) return;
+
+    const uint32_t terminal = node;
+    if (--nodes[node].uses == 0) {
+        deadBytes += nodes[node].titleLength;
+        nodes[node].titleLength = 0;
+        --distinctTitles;
+    }
+    while (node != 0 && nodes[node].uses == 0 && nodes[node].children.empty()) {
+        const uint32_t parent = nodes[node].parent;
+        unlinkChild(parent, node);
+        nodes[node].best.clear();
+        deadBytes += nodes[node].labelLength;
+        freeNodes.push_back(node);
+        node = parent;
+    }
+    refreshPath(node, terminal);
+    if (deadBytes > labels.size() + titles.size() - deadBytes) compact();
+}
+
+void TitleTrie::clear() {
+    nodes.assign(1, Node());
+    freeNodes.clear();
+    labels.clear();
+    titles.clear();
+    deadBytes = 0;
+    distinctTitles = 0;
+}
+
+vector<string> TitleTrie::complete(string_view prefix, size_t limit) const {
+    string key = normalizeTitle(prefix);
+    if (!key.empty() && isSpace(prefix.back())) key += ' ';
+
+    uint32_t matched = 0;
+    const uint32_t node = descend(key, matched);
+    vector<string> completions;
+    if (node == none) return completions;
+    const auto& best = nodes[node].best;
+    for (size_t i = 0; i < best.size() && i < limit; ++i) completions.emplace_back(titleOf(best[i]));
+    return completions;
+}
+
+size_t TitleTrie::titleCount() const {
+    return distinctTitles;
+}
+
+size_t TitleTrie::memoryUsage() const {
+    size_t bytes = nodes.capacity() * sizeof(Node) + freeNodes.capacity() * sizeof(uint32_t)
+        + labels.capacity() + titles.capacity();
+    for (const auto& node : nodes) bytes += node.best.capacity() * sizeof(uint32_t) + node.children.capacity() * sizeof(Edge);
+    return bytes;
+}
+
+char TitleTrie::firstByte(uint32_t node) const {
+    return labels[nodes[node].labelOffset];
+}
+
+string_view TitleTrie::titleOf(uint32_t node) const {
+    return string_view(titles.data() + nodes[node].titleOffset, nodes[node].titleLength);
+}
+
+bool TitleTrie::ranksBefore(uint32_t a, uint32_t b) const {
+    if (nodes[a].uses != nodes[b].uses) return nodes[a].uses > nodes[b].uses;
+    return titleOf(a) < titleOf(b);
+}
+
+uint32_t TitleTrie::findChild(uint32_t node, char c) const {
+    const auto& children = nodes[node].children;
+    const auto it = lower_bound(children.begin(), children.end(), Edge{ static_cast<unsigned char>(c), 0 },
+        [](const Edge& a, const Edge& b) { return a.first < b.first; });
+    return it != children.end() && it->first == static_cast<unsigned char>(c) ? it->node : none;
+}
+
+void TitleTrie::linkChild(uint32_t node, uint32_t child) {
+    const Edge edge{ static_cast<unsigned char>(firstByte(child)), child };
+    auto& children = nodes[node].children;
+    children.insert(upper_bound(children.begin(), children.end(), edge,
+        [](const Edge& a, const Edge& b) { return a.first < b.first; }), edge);
+    nodes[child].parent = node;
+}
+
+void TitleTrie::unlinkChild(uint32_t node, uint32_t child) {
+    auto& children = nodes[node].children;
+    children.erase(find_if(children.begin(), children.end(), [child](const Edge& edge) { return edge.node == child; }));
+}
+
+uint32_t TitleTrie::newNode(uint32_t labelOffset, uint32_t labelLength) {
+    uint32_t node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[node] = Node();
+    } else {
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[node].labelOffset = labelOffset;
+    nodes[node].labelLength = labelLength;
+    return node;
+}
+
+uint32_t TitleTrie::splitEdge(uint32_t node, uint32_t at) {
+    const uint32_t middle = newNode(nodes[node].labelOffset, at);
+    const uint32_t parent = nodes[node].parent;
+    unlinkChild(parent, node);
+    linkChild(parent, middle);
+    nodes[node].labelOffset += at;
+    nodes[node].labelLength -= at;
+    linkChild(middle, node);
+    nodes[middle].best = nodes[node].best;
+    return middle;
+}
+
+uint32_t TitleTrie::descend(string_view key, uint32_t& matched) const {
+    uint32_t node = 0;
+    size_t pos = 0;
+    matched = 0;
+    while (pos < key.size()) {
+        node = findChild(node, key[pos]);
+        if (node == none) return none;
+        const string_view label(labels.data() + nodes[node].labelOffset, nodes[node].labelLength);
+        const size_t length = min(label.size(), key.size() - pos);
+        if (label.compare(0, length, key.substr(pos, length)) != 0) return none;
+        matched = static_cast<uint32_t>(length);
+        pos += length;
+    }
+    return node;
+}
+
+void TitleTrie::promote(uint32_t title) {
+    for (uint32_t node = title; node != none; node = nodes[node].parent) {
+        auto& best = nodes[node].best;
+        auto it = find(best.begin(), best.end(), title);
+        if (it == best.end()) {
+            if (best.size() < suggestionLimit) {
+                best.push_back(title);
+            } else if (!best.empty() && ranksBefore(title, best.back())) {
+                best.back() = title;
+            } else {
+                // Not among the best here, so not among the best of any ancestor either.
+                return;
+            }
+            it = best.end() - 1;
+        }
+        for (; it != best.begin() && ranksBefore(title, *(it - 1)); --it) swap(*it, *(it - 1));
+    }
+}
+
+void TitleTrie::refreshPath(uint32_t node, uint32_t title) {
+    vector<uint32_t> candidates;
+    const auto byRank = [this](uint32_t a, uint32_t b) { return ranksBefore(a, b); };
+    for (; node != none; node = nodes[node].parent) {
+        auto& best = nodes[node].best;
+        if (node != title && find(best.begin(), best.end(), title) == best.end()) return;
+
+        candidates.clear();
+        if (nodes[node].uses) candidates.push_back(node);
+        for (const auto& edge : nodes[node].children)
+            candidates.insert(candidates.end(), nodes[edge.node].best.begin(), nodes[edge.node].best.end());
+
+        const size_t keep = min(candidates.size(), suggestionLimit);
+        partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), byRank);
+        nodes[node].best.assign(candidates.begin(), candidates.begin() + keep);
+    }
+}
+
+void TitleTrie::compact() {
+    string liveLabels, liveTitles;
+    liveLabels.reserve(labels.size() - min(deadBytes, labels.size()));
+    vector<uint32_t> pending = { 0 };
+    while (!pending.empty()) {
+        Node& node = nodes[pending.back()];
+        pending.pop_back();
+        const uint32_t labelOffset = static_cast<uint32_t>(liveLabels.size());
+        liveLabels.append(labels, node.labelOffset, node.labelLength);
+        node.labelOffset = labelOffset;
+        if (node.titleLength) {
+            const uint32_t titleOffset = static_cast<uint32_t>(liveTitles.size());
+            liveTitles.append(titles, node.titleOffset, node.titleLength);
+            node.titleOffset = titleOffset;
+        }
+        for (const auto& edge : node.children) pending.push_back(edge.node);
+    }
+    labels = move(liveLabels);
+    titles = move(liveTitles);
+    deadBytes = 0;
+}
@@ -0,0 +1,82 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Case-folds the title (see foldCase), trims it and collapses runs of spaces; titles
+// that normalize to the same string are one completion.
+string normalizeTitle(string_view title);
+
+// Radix tree over normalized titles counting how many tasks use each title. Every node
+// keeps its best completions (most used first, then alphabetical) so that complete()
+// is O(prefix length + limit). The lists are updated bottom-up along the changed
+// path on insert and erase. Edge labels and titles are slices of two byte arenas; once
+// erased titles leave more dead bytes in them than live ones, they are compacted.
+class TitleTrie {
+public:
+    explicit TitleTrie(size_t suggestionLimit = 8);
+
+    // Throws length_error if the arenas would outgrow 32-bit offsets.
+    void insert(string_view title);
+    // Drops one use of the title; unknown titles are ignored.
+    void erase(string_view title);
+    void clear();
+
+    // Up to limit (capped by suggestionLimit) titles starting with the normalized
+    // prefix. A title is returned as it was first inserted.
+    vector<string> complete(string_view prefix, size_t limit) const;
+    size_t titleCount() const;
+    // Bytes owned by the tree, including the label and title arenas.
+    size_t memoryUsage() const;
+
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    struct Edge {
+        unsigned char first;
+        uint32_t node;
+    };
+
+    struct Node {
+        uint32_t labelOffset = 0;
+        uint32_t labelLength = 0;
+        uint32_t parent = none;
+        uint32_t uses = 0;
+        uint32_t titleOffset = 0;
+        uint32_t titleLength = 0;
+        // Children ordered by the first byte of their label.
+        vector<Edge> children;
+        vector<uint32_t> best;
+    };
+
+    char firstByte(uint32_t node) const;
+    string_view titleOf(uint32_t node) const;
+    bool ranksBefore(uint32_t a, uint32_t b) const;
+    uint32_t findChild(uint32_t node, char c) const;
+    void linkChild(uint32_t node, uint32_t child);
+    void unlinkChild(uint32_t node, uint32_t child);
+    uint32_t newNode(uint32_t labelOffset, uint32_t labelLength);
+    uint32_t splitEdge(uint32_t node, uint32_t at);
+    // Walks the key; returns the node it ends at (or none) and, in matched, how many
+    // bytes of that node's label were consumed.
+    uint32_t descend(string_view key, uint32_t& matched) const;
+    // Moves a title whose use count grew up the best lists from its node to the root.
+    void promote(uint32_t title);
+    // Recomputes the best lists from node up to the root after a title lost a use;
+    // stops at the first list that did not contain it.
+    void refreshPath(uint32_t node, uint32_t title);
+    // Copies the labels and titles of live nodes into fresh arenas.
+    void compact();
+
+    size_t suggestionLimit;
+    vector<Node> nodes;
+    vector<uint32_t> freeNodes;
+    string labels;
+    string titles;
+    // Arena bytes no live node refers to.
+    size_t deadBytes = 0;
+    size_t distinctTitles = 0;
+};
@@ -0,0 +1,80 @@
+﻿#include "zone_map.h"
+#include "task_manager.h"
+#include "date_key.h"
+#include <algorithm>
+
+using namespace std;
+
+void ZoneMaps::append(size_t index, const Task& task) {
+    if (!valid) return;
+    const size_t block = index / blockTasks;
+    if (block >= zones.size()) {
+        zones.resize(block + 1);
+        dirty.resize(block + 1, false);
+    }
+    // Dirty zones (and stale ones past the end after a delete) are rebuilt anyway.
+    if (!dirty[block]) add(zones[block], task);
+}
+
+void ZoneMaps::markDirty(size_t index) {
+    if (valid && index / blockTasks < dirty.size()) dirty[index / blockTasks] = true;
+}
+
+void ZoneMaps::markDirtyFrom(size_t index) {
+    if (!valid) return;
+    for (size_t i = index / blockTasks; i < dirty.size(); ++i) dirty[i] = true;
+}
+
+void ZoneMaps::invalidate() {
+    valid = false;
+}
+
+void ZoneMaps::refresh(const vector<Task>& tasks) {
+    const size_t count = (tasks.size() + blockTasks - 1) / blockTasks;
+    if (!valid) {
+        zones.assign(count, Zone());
+        dirty.assign(count, true);
+        valid = true;
+    } else {
+        zones.resize(count);
+        dirty.resize(count, true);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!dirty[i]) continue;
+        zones[i] = Zone();
+        const size_t end = min(tasks.size(), (i + 1) * blockTasks);
+        for (size_t j = i * blockTasks; j < end; ++j) add(zones[i], tasks[j]);
+        dirty[i] = false;
+    }
+}
+
+size_t ZoneMaps::zoneCount() const {
+    return zones.size();
+}
+
+const ZoneMaps::Zone& ZoneMaps::zone(size_t index) const {
+    return zones[index];
+}
+
+void ZoneMaps::recordSkips(size_t scanned, size_t skipped) const {
+    skipCounters.record(scanned, skipped);
+}
+
+BlockSkipStats ZoneMaps::blockSkipStats() const {
+    return skipCounters.stats();
+}
+
+void ZoneMaps::add(Zone& zone, const Task& task) {
+    ++zone.taskCount;
+    const int key = dateKey(task.date);
+    if (key != 0) {
+        ++zone.datedCount;
+        zone.minDate = min(zone.minDate, key);
+        zone.maxDate = max(zone.maxDate, key);
+    }
+    zone.minPriority = min(zone.minPriority, task.priority);
+    zone.maxPriority = max(zone.maxPriority, task.priority);
+    ++zone.priorityCounts[task.priority >= 1 && task.priority <= 3 ? task.priority : 0];
+    if (task.completed) ++zone.completedCount;
+}
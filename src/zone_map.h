@@ -0,0 +1,55 @@
+﻿#pragma once
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "block_skip_stats.h"
+
+using namespace std;
+
+struct Task;
+
+// Summaries of fixed blocks of tasks: date range, priority histogram and completed
+// count. A full scan can skip a block the summary proves has no match, or take the
+// whole block when it proves every task matches. Zones are built on first use,
+// extended on append and rebuilt block by block after in-place changes.
+class ZoneMaps {
+public:
+    static constexpr size_t blockTasks = 4096;
+
+    struct Zone {
+        size_t taskCount = 0;
+        // Tasks with a valid date; the date range covers only those.
+        size_t datedCount = 0;
+        int minDate = INT_MAX;
+        int maxDate = INT_MIN;
+        int minPriority = INT_MAX;
+        int maxPriority = INT_MIN;
+        // Index p counts priority p for 1..3, index 0 counts all other priorities.
+        array<uint32_t, 4> priorityCounts{};
+        size_t completedCount = 0;
+    };
+
+    // The task was appended at index.
+    void append(size_t index, const Task& task);
+    // The task at index changed in place.
+    void markDirty(size_t index);
+    // Tasks from index on moved (a task before them was deleted).
+    void markDirtyFrom(size_t index);
+    void invalidate();
+    // Brings the zones in line with tasks; only dirty blocks are rebuilt.
+    void refresh(const vector<Task>& tasks);
+
+    size_t zoneCount() const;
+    const Zone& zone(size_t index) const;
+    void recordSkips(size_t scanned, size_t skipped) const;
+    BlockSkipStats blockSkipStats() const;
+
+private:
+    static void add(Zone& zone, const Task& task);
+
+    vector<Zone> zones;
+    vector<bool> dirty;
+    bool valid = false;
+    mutable BlockSkipCounters skipCounters;
+};
@@ -0,0 +1,38 @@
+#include "doctest.h"
+#include "../src/case_fold.h"
+
+TEST_CASE("Case folding") {
+    SUBCASE("Latin") {
+        CHECK(foldCase("Buy MILK 42!") == "buy milk 42!");
+        CHECK(foldCase("ÀÉÎÕÜ × ß Ÿ") == "àéîõü × ß ÿ");
+        CHECK(foldCase("ŁÓDŹ ĞÜŞ") == "łódź ğüş");
+    }
+
+    SUBCASE("Dotted İ is left alone, long ſ folds to s") {
+        CHECK(foldCase("İı") == "İı");
+        CHECK(foldCase("İ") != foldCase("ı"));
+        CHECK(foldCodePoint(0x130) == 0x130);
+        CHECK(foldCodePoint(0x131) == 0x131);
+        CHECK(foldCase("Maſs ſ") == "mass s");
+        CHECK(foldCodePoint(0x17F) == 's');
+    }
+
+    SUBCASE("Cyrillic and Greek") {
+        CHECK(foldCase("КУПИТЬ Молоко") == "купить молоко");
+        CHECK(foldCase("ЁЖИК ЇЖАК Ґ") == "ёжик їжак ґ");
+        CHECK(foldCase("ΑΘΗΝΑ Άρης ς") == "αθηνα άρησ σ");
+    }
+
+    SUBCASE("Decomposed letters are composed") {
+        CHECK(foldCase("ЁЛКА") == "ёлка");
+        CHECK(foldCase("ЙОГУРТ") == "йогурт");
+        CHECK(foldCase("ä") == "ä");
+    }
+
+    SUBCASE("Other text is copied") {
+        CHECK(foldCase("日本語 😀") == "日本語 😀");
+        CHECK(foldCase(string("A\xD0\0B", 4)) == string("a\xD0\0b", 4));
+        CHECK(foldCase("\xC0\x81") == "\xC0\x81");
+        CHECK(foldCase("") == "");
+    }
+}
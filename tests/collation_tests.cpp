@@ -0,0 +1,78 @@
+#include "doctest.h"
+#include "../src/collation.h"
+#include "../src/task_manager.h"
+
+namespace {
+
+bool collatesBefore(const string& a, const string& b) {
+    return collationKey(a) < collationKey(b);
+}
+
+}
+
+TEST_CASE("Collation keys") {
+    SUBCASE("Russian alphabet regardless of case") {
+        CHECK(collatesBefore("апельсин", "Яблоко"));
+        CHECK(collatesBefore("Арбуз", "банан"));
+        CHECK(collatesBefore("ель", "йогурт"));
+        CHECK(collatesBefore("йогурт", "кефир"));
+        CHECK(collatesBefore("Купить", "купить молоко"));
+    }
+
+    SUBCASE("Ё sorts as Е, before it only on a tie") {
+        CHECK(collatesBefore("еж", "ёж"));
+        CHECK(collatesBefore("ёж", "ель"));
+        CHECK(collatesBefore("Ёлка", "ель"));
+    }
+
+    SUBCASE("Lower case first, then bytes") {
+        CHECK(collatesBefore("молоко", "Молоко"));
+        CHECK(collatesBefore("Молоко", "МОЛОКО"));
+        CHECK(collationKey("молоко") == collationKey("молоко"));
+    }
+
+    SUBCASE("Scripts and symbols") {
+        CHECK(collatesBefore("- план", "2 задачи"));
+        CHECK(collatesBefore("2 задачи", "Задачи"));
+        CHECK(collatesBefore("яблоко", "apple"));
+        CHECK(collatesBefore("Zoo", "日本"));
+    }
+
+    SUBCASE("Decomposed letters collate as composed ones") {
+        const string decomposedIo = "е\xCC\x88ж";
+        const string decomposedShortI = "и\xCC\x86од";
+        CHECK(collatesBefore("еж", decomposedIo));
+        CHECK(collatesBefore(decomposedIo, "ель"));
+        CHECK(collationKey(decomposedIo).compare(0, 8, collationKey("ёж"), 0, 8) == 0);
+        CHECK(collatesBefore("ищу", decomposedShortI));
+        CHECK(collatesBefore(decomposedShortI, "кот"));
+    }
+
+    SUBCASE("Invalid bytes") {
+        CHECK(collatesBefore("a", "a\xFF"));
+        CHECK(collatesBefore("a\xFF", "b\xFF"));
+    }
+}
+
+TEST_CASE("Cached collation keys") {
+    vector<Task> tasks = { { "Яблоко", "", 1, false }, { "арбуз", "", 1, false } };
+    CollationKeys keys;
+    CHECK_FALSE(keys.isValid());
+    keys.rebuild(tasks);
+    CHECK(keys.isValid());
+    CHECK(keys.key(0) == collationKey("Яблоко"));
+
+    tasks.push_back({ "Банан", "", 1, false });
+    keys.append(tasks.back());
+    tasks[0].title = "Вишня";
+    keys.update(0, tasks[0]);
+    keys.reorder({ 1, 2, 0 });
+    CHECK(keys.key(0) == collationKey("арбуз"));
+    CHECK(keys.key(1) == collationKey("Банан"));
+    CHECK(keys.key(2) == collationKey("Вишня"));
+
+    keys.erase(0);
+    CHECK(keys.key(0) == collationKey("Банан"));
+    keys.invalidate();
+    CHECK_FALSE(keys.isValid());
+}
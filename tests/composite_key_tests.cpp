@@ -0,0 +1,103 @@
+#include "doctest.h"
+#include "../src/composite_key.h"
+#include "../src/task_manager.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+namespace {
+
+vector<Task> randomTasks(size_t count, mt19937& rng, int prioritySpread) {
+    const char* const titles[] = { "Buy milk", "Buy milk and bread", "Buy", "Call mom", "Call mom today", "", "Report" };
+    const char* const dates[] = { "01.01.2025", "31.12.2024", "15.06.2025", "", "30.02.2025", "01.01.2030" };
+    vector<Task> tasks(count);
+    for (auto& task : tasks) {
+        task.title = titles[rng() % 7];
+        task.date = dates[rng() % 6];
+        task.priority = static_cast<int>(static_cast<int64_t>(rng() % 3) * prioritySpread - prioritySpread);
+    }
+    return tasks;
+}
+
+}
+
+TEST_CASE("Composite sort keys") {
+    SUBCASE("Packed keys never contradict the full order") {
+        mt19937 rng(5);
+        const auto tasks = randomTasks(300, rng, 1);
+        const vector<SortKey> keys = { { SortField::Priority, true }, { SortField::Date }, { SortField::Title } };
+        const CompositeKey composite(tasks, keys);
+        const CompositeOrder order{ keys };
+        CHECK_FALSE(composite.isExact());
+        for (const auto& a : tasks) {
+            for (const auto& b : tasks) {
+                if (composite.pack(a) < composite.pack(b)) CHECK_FALSE(order(b, a));
+            }
+        }
+    }
+
+    SUBCASE("Integer keys alone pack exactly") {
+        mt19937 rng(6);
+        const auto tasks = randomTasks(50, rng, 1);
+        CHECK(CompositeKey(tasks, { { SortField::Date, true }, { SortField::Priority } }).isExact());
+        CHECK_FALSE(CompositeKey(tasks, { { SortField::Title }, { SortField::Priority } }).isExact());
+    }
+
+    SUBCASE("sortTasks matches stable_sort with the full comparison") {
+        mt19937 rng(7);
+        const vector<vector<SortKey>> orders = {
+            { { SortField::Priority, true }, { SortField::Date }, { SortField::Title } },
+            { { SortField::Title, true }, { SortField::Priority } },
+            { { SortField::Date, true } },
+            { { SortField::Date }, { SortField::Title, true }, { SortField::Priority, true } },
+        };
+        // A wide priority spread (31 bits) leaves only a short title prefix in the packed key.
+        for (const int spread : { 1, 1 << 29 }) {
+            for (const auto& keys : orders) {
+                const auto tasks = randomTasks(500, rng, spread);
+                TaskManager manager;
+                for (const auto& task : tasks) manager.addTask(task.title, task.date, task.priority);
+                auto expected = tasks;
+                stable_sort(expected.begin(), expected.end(), CompositeOrder{ keys });
+                manager.sortTasks(keys);
+                bool same = true;
+                for (size_t i = 0; i < tasks.size(); ++i) {
+                    const auto& task = manager.getTask(i);
+                    same = same && task.title == expected[i].title && task.date == expected[i].date && task.priority == expected[i].priority;
+                }
+                CHECK(same);
+            }
+        }
+    }
+}
+
+TEST_CASE("Top tasks") {
+    mt19937 rng(8);
+    const auto tasks = randomTasks(2000, rng, 1);
+    TaskManager manager;
+    for (const auto& task : tasks) manager.addTask(task.title, task.date, task.priority);
+    for (size_t i = 0; i < tasks.size(); i += 3) manager.markCompleted(i);
+
+    const auto expectedTop = [&](const vector<SortKey>& keys, size_t n, bool includeCompleted) {
+        vector<size_t> indices;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (includeCompleted || i % 3 != 0) indices.push_back(i);
+        }
+        stable_sort(indices.begin(), indices.end(), [&](size_t a, size_t b) { return CompositeOrder{ keys }(tasks[a], tasks[b]); });
+        indices.resize(min(n, indices.size()));
+        return indices;
+    };
+
+    SUBCASE("Matches the head of a stable sort") {
+        CHECK(manager.topTasks(10) == expectedTop(mostUrgentFirst, 10, false));
+        const vector<SortKey> byTitle = { { SortField::Title }, { SortField::Date, true } };
+        CHECK(manager.topTasks(25, byTitle, true) == expectedTop(byTitle, 25, true));
+        CHECK(manager.topTasks(5000).size() == 1333);
+        CHECK(manager.topTasks(0).empty());
+    }
+
+    SUBCASE("Storage order is untouched") {
+        manager.topTasks(10);
+        for (size_t i = 0; i < tasks.size(); ++i) CHECK(manager.getTask(i).title == tasks[i].title);
+    }
+}
@@ -0,0 +1,88 @@
+#include "doctest.h"
+#include "../src/concurrent_task_manager.h"
+#include <atomic>
+#include <thread>
+
+TEST_CASE("Concurrent task manager") {
+    ConcurrentTaskManager manager;
+    manager.addTask("Buy milk", "10.12.2024", 2);
+    manager.addTask("Call mom", "20.01.2026", 1);
+
+    SUBCASE("Tasks come back as copies") {
+        const auto task = manager.getTask(0);
+        REQUIRE(task);
+        CHECK(task->title == "Buy milk");
+        manager.editTask(0, "Buy bread");
+        CHECK(task->title == "Buy milk");
+        CHECK_FALSE(manager.getTask(2));
+
+        const auto tasks = manager.snapshot();
+        REQUIRE(tasks.size() == 2);
+        CHECK(tasks[0].title == "Buy bread");
+    }
+
+    SUBCASE("Found tasks carry their indices") {
+        const auto found = manager.findTasks("mom");
+        REQUIRE(found.size() == 1);
+        CHECK(found[0].index == 1);
+        CHECK(found[0].task.title == "Call mom");
+        CHECK(manager.findTaskIndices("CALL", true) == vector<size_t>{ 1 });
+    }
+
+    SUBCASE("Escape hatches run under the locks") {
+        manager.write([](TaskManager& tasks) {
+            tasks.addTask("Pay bills", "01.02.2025", 3);
+            tasks.markCompleted(0);
+        });
+        const size_t completed = manager.read([](const TaskManager& tasks) {
+            size_t count = 0;
+            for (size_t i = 0; i < tasks.getTaskCount(); ++i) count += tasks.getTask(i).completed;
+            return count;
+        });
+        CHECK(completed == 1);
+        CHECK(manager.topTasks(1) == vector<size_t>{ 2 });
+    }
+}
+
+TEST_CASE("Concurrent readers and a writer") {
+    const size_t initial = 2000;
+    ConcurrentTaskManager manager;
+    for (size_t i = 0; i < initial; ++i) manager.addTask("Task " + to_string(i), "01.01.2025", 1 + static_cast<int>(i % 3));
+
+    // Every title starts with "Task", so each read can check itself against the count
+    // it saw under the same lock.
+    atomic<bool> writing{ true };
+    atomic<size_t> failures{ 0 };
+    const auto reader = [&](size_t seed) {
+        size_t reads = 0;
+        while (writing || reads < 50) {
+            ++reads;
+            const auto task = manager.getTask((seed * 7919 + reads * 104729) % (initial + 100));
+            if (task && task->title.compare(0, 4, "Task") != 0) ++failures;
+
+            const bool consistent = manager.read([&](const TaskManager& tasks) {
+                const size_t count = tasks.getTaskCount();
+                size_t visited = 0;
+                tasks.forEachInOrder(reads % 2 ? SortOrder::Title : SortOrder::CollatedTitle, [&](size_t) { ++visited; });
+                return tasks.findTaskIndices("Task").size() == count && tasks.findTaskIndices("task", true).size() == count
+                    && tasks.findTasksByQuery("priority>=1").size() == count && visited == count;
+            });
+            if (!consistent) ++failures;
+        }
+    };
+
+    vector<thread> readers;
+    for (size_t i = 0; i < 4; ++i) readers.emplace_back(reader, i);
+    for (size_t i = 0; i < 200; ++i) {
+        manager.addTask("Task added " + to_string(i), "02.01.2025", 2);
+        manager.editTask(i * 7, "Task edited " + to_string(i));
+        if (i % 2 == 0) manager.deleteTask(i * 3);
+        if (i % 50 == 0) manager.sortTasks(SortOrder::DateDescending);
+    }
+    writing = false;
+    for (auto& thread : readers) thread.join();
+
+    CHECK(failures.load() == 0);
+    CHECK(manager.getTaskCount() == initial + 100);
+    CHECK(manager.findTaskIndices("Task").size() == initial + 100);
+}
@@ -0,0 +1,39 @@
+#include "doctest.h"
+#include "../src/date_key.h"
+
+TEST_CASE("Date keys") {
+    SUBCASE("Parsing") {
+        CHECK(dateKey("01.05.2025") == 20250501);
+        CHECK(dateKey("29.02.2024") == 20240229);
+        CHECK(dateKey("29.02.2025") == 0);
+        CHECK(dateKey("32.01.2025") == 0);
+        CHECK(dateKey("1.5.2025") == 0);
+        CHECK(dateKey("ab.cd.efgh") == 0);
+        CHECK(dateKey("") == 0);
+    }
+
+    SUBCASE("Chronological order") {
+        CHECK(dateKey("31.12.2024") < dateKey("01.01.2025"));
+        CHECK(dateKey("02.01.2025") < dateKey("01.02.2025"));
+    }
+
+    SUBCASE("Formatting") {
+        CHECK(formatDateKey(20250501) == "01.05.2025");
+    }
+
+    SUBCASE("Day arithmetic") {
+        CHECK(daysFromDateKey(19700101) == 0);
+        CHECK(dateKeyFromDays(0) == 19700101);
+        CHECK(addDays(20241231, 1) == 20250101);
+        CHECK(addDays(20240228, 1) == 20240229);
+        CHECK(addDays(20250301, -1) == 20250228);
+        for (int days = -1000; days < 20000; days += 37) CHECK(daysFromDateKey(dateKeyFromDays(days)) == days);
+    }
+
+    SUBCASE("Calendar helpers") {
+        CHECK(weekdayOfDateKey(20250101) == 2);
+        CHECK(weekdayOfDateKey(20250105) == 6);
+        CHECK(lastDayOfMonthKey(20240210) == 20240229);
+        CHECK(lastDayOfMonthKey(20251115) == 20251130);
+    }
+}
@@ -0,0 +1,61 @@
+#include "doctest.h"
+#include "../src/fuzzy_search.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+static int referenceDistance(const string& pattern, const string& text) {
+    vector<int> previous(pattern.size() + 1), current(pattern.size() + 1);
+    for (size_t i = 0; i <= pattern.size(); ++i) previous[i] = static_cast<int>(i);
+    int best = previous.back();
+    for (char c : text) {
+        current[0] = 0;
+        for (size_t i = 1; i <= pattern.size(); ++i) {
+            current[i] = min({ previous[i] + 1, current[i - 1] + 1, previous[i - 1] + (pattern[i - 1] == c ? 0 : 1) });
+        }
+        swap(previous, current);
+        best = min(best, previous.back());
+    }
+    return best;
+}
+
+static int fuzzyDistance(const string& pattern, const string& text) {
+    return FuzzyPattern(pattern).distance(text.data(), text.size());
+}
+
+TEST_CASE("Fuzzy pattern distance") {
+    SUBCASE("Exact and approximate substrings") {
+        CHECK(fuzzyDistance("homework", "Finish homework") == 0);
+        CHECK(fuzzyDistance("homwork", "Finish homework") == 1);
+        CHECK(fuzzyDistance("hoemwork", "Finish homework") == 2);
+        CHECK(fuzzyDistance("xyz", "") == 3);
+        CHECK(fuzzyDistance("", "anything") == 0);
+    }
+
+    SUBCASE("Cyrillic letters count as one character") {
+        CHECK(fuzzyDistance("малоко", "Купить молоко") == 1);
+        CHECK(fuzzyDistance("молоко", "Купить молоко") == 0);
+        // Many distinct letters, from both ends of the pattern's code point range.
+        CHECK(fuzzyDistance("домашнее задание", "Сделать домашнее задание") == 0);
+        CHECK(fuzzyDistance("дамашнее зодание", "Сделать домашнее задание") == 2);
+        CHECK(fuzzyDistance("ёжик я", "Ёжик в тумане") == 2);
+        CHECK(fuzzyDistance("щюя", "абв") == 3);
+    }
+
+    SUBCASE("Full 64-character pattern") {
+        const string pattern(64, 'a');
+        CHECK(fuzzyDistance(pattern, string(64, 'a')) == 0);
+        CHECK(fuzzyDistance(pattern, string(63, 'a')) == 1);
+        CHECK_THROWS_AS(FuzzyPattern(string(65, 'a')), invalid_argument);
+    }
+
+    SUBCASE("Agrees with dynamic programming") {
+        mt19937 rng(7);
+        for (int round = 0; round < 1000; ++round) {
+            string pattern(1 + rng() % 10, ' '), text(rng() % 30, ' ');
+            for (auto& c : pattern) c = static_cast<char>('a' + rng() % 3);
+            for (auto& c : text) c = static_cast<char>('a' + rng() % 3);
+            CHECK(fuzzyDistance(pattern, text) == referenceDistance(pattern, text));
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "doctest.h"
+#include "../src/aho_corasick.h"
+#include "../src/keyword_expression.h"
+#include <stdexcept>
+
+TEST_CASE("Aho-Corasick matching") {
+    const AhoCorasick automaton({ "he", "she", "his", "hers" });
+
+    SUBCASE("Reports every pattern found") {
+        const string text = "ushers";
+        CHECK(automaton.match(text.data(), text.size()) == 0b1011);
+    }
+
+    SUBCASE("Zero byte restarts matching") {
+        const string text("s\0he", 4);
+        CHECK(automaton.match(text.data(), text.size()) == 0b0001);
+    }
+
+    SUBCASE("No match") {
+        const string text = "xyz";
+        CHECK(automaton.match(text.data(), text.size()) == 0);
+    }
+
+    SUBCASE("Too many patterns") {
+        vector<string> patterns(AhoCorasick::maxPatterns + 1, "a");
+        CHECK_THROWS_AS(AhoCorasick{ patterns }, invalid_argument);
+    }
+}
+
+TEST_CASE("Keyword expressions") {
+    SUBCASE("Precedence and implicit AND") {
+        const auto expression = KeywordExpression::parse("a b OR NOT c");
+        REQUIRE(expression.keywords().size() == 3);
+        CHECK(expression.toString() == "((\"a\" AND \"b\") OR NOT \"c\")");
+        CHECK(expression.evaluate(0b011));
+        CHECK(expression.evaluate(0b000));
+        CHECK_FALSE(expression.evaluate(0b101));
+    }
+
+    SUBCASE("Quotes and parentheses") {
+        const auto expression = KeywordExpression::parse("\"buy milk\" AND (tea OR \"OR\")");
+        CHECK(expression.keywords() == vector<string>{ "buy milk", "tea", "OR" });
+    }
+
+    SUBCASE("Repeated keywords share a bit") {
+        const auto expression = KeywordExpression::parse("milk OR milk");
+        CHECK(expression.keywords().size() == 1);
+        CHECK(expression.evaluate(1));
+    }
+
+    SUBCASE("Single keyword") {
+        CHECK(KeywordExpression::parse("milk").isSingleKeyword());
+        CHECK_FALSE(KeywordExpression::parse("NOT milk").isSingleKeyword());
+    }
+
+    SUBCASE("Syntax errors") {
+        CHECK_THROWS_AS(KeywordExpression::parse(""), invalid_argument);
+        CHECK_THROWS_AS(KeywordExpression::parse("milk AND"), invalid_argument);
+        CHECK_THROWS_AS(KeywordExpression::parse("(milk"), invalid_argument);
+        CHECK_THROWS_AS(KeywordExpression::parse("milk)"), invalid_argument);
+        CHECK_THROWS_AS(KeywordExpression::parse("\"milk"), invalid_argument);
+    }
+}
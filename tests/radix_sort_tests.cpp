@@ -0,0 +1,108 @@
+#include "doctest.h"
+#include "../src/radix_sort.h"
+#include <algorithm>
+#include <random>
+#include <string>
+
+TEST_CASE("Radix sort") {
+    SUBCASE("Empty and single") {
+        CHECK(radixSortOrder(vector<uint32_t>()).empty());
+        CHECK(radixSortOrder(vector<uint32_t>{ 7 }) == vector<uint32_t>{ 0 });
+    }
+
+    SUBCASE("Equal keys keep their order") {
+        CHECK(radixSortOrder(vector<uint32_t>{ 3, 1, 3, 2, 1 }) == vector<uint32_t>{ 1, 4, 3, 0, 2 });
+        CHECK(radixSortOrder(vector<uint32_t>{ 5, 5, 5 }) == vector<uint32_t>{ 0, 1, 2 });
+    }
+
+    SUBCASE("Matches stable_sort across all digits") {
+        mt19937 rng(7);
+        for (const uint32_t range : { 3u, 5000u, 20251231u, 0xFFFFFFFFu }) {
+            vector<uint32_t> keys(3000);
+            for (auto& key : keys) key = range == 0xFFFFFFFFu ? rng() : rng() % range;
+            vector<uint32_t> expected(keys.size());
+            for (size_t i = 0; i < expected.size(); ++i) expected[i] = static_cast<uint32_t>(i);
+            stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+            CHECK(radixSortOrder(keys) == expected);
+        }
+    }
+
+    SUBCASE("64-bit keys") {
+        mt19937_64 rng(9);
+        vector<uint64_t> keys(3000);
+        for (auto& key : keys) key = rng() >> (rng() % 64);
+        for (size_t i = 0; i < 100; ++i) keys[i * 30] = keys[i];
+        vector<uint32_t> expected(keys.size());
+        for (size_t i = 0; i < expected.size(); ++i) expected[i] = static_cast<uint32_t>(i);
+        stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        CHECK(radixSortOrder(keys) == expected);
+    }
+
+    SUBCASE("Byte strings") {
+        const vector<string> strings = { "b", "", "ab", string("ab\0", 3), "ab", "\xFF", "a" };
+        const vector<string_view> views(strings.begin(), strings.end());
+        CHECK(radixSortOrder(views) == vector<uint32_t>{ 1, 6, 2, 4, 3, 0, 5 });
+    }
+
+    SUBCASE("Long shared prefixes go through several passes") {
+        mt19937 rng(3);
+        vector<string> strings(5000);
+        for (auto& text : strings) {
+            text = string(rng() % 20, 'x');
+            for (int i = rng() % 4; i >= 0; --i) text += static_cast<char>(rng() % 3);
+        }
+        const vector<string_view> views(strings.begin(), strings.end());
+        vector<uint32_t> expected(strings.size());
+        for (size_t i = 0; i < expected.size(); ++i) expected[i] = static_cast<uint32_t>(i);
+        stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return strings[a] < strings[b]; });
+        CHECK(radixSortOrder(views) == expected);
+    }
+}
+
+namespace {
+
+// Counts moves, to check that applyPermutation moves each item once.
+struct Counted {
+    int value = 0;
+    static int moves;
+
+    Counted() = default;
+    explicit Counted(int value) : value(value) {}
+    Counted(Counted&& other) noexcept : value(other.value) { ++moves; }
+    Counted& operator=(Counted&& other) noexcept {
+        value = other.value;
+        ++moves;
+        return *this;
+    }
+};
+
+int Counted::moves = 0;
+
+}
+
+TEST_CASE("Applying a permutation") {
+    vector<Counted> items;
+    for (int i = 0; i < 1000; ++i) items.emplace_back(i);
+
+    SUBCASE("Every item lands where the order says") {
+        mt19937 rng(3);
+        vector<uint32_t> order(items.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+        shuffle(order.begin(), order.end(), rng);
+        applyPermutation(items, order);
+        bool placed = true;
+        for (size_t i = 0; i < items.size(); ++i) placed = placed && items[i].value == static_cast<int>(order[i]);
+        CHECK(placed);
+    }
+
+    SUBCASE("Each item moves once, plus one temporary per cycle") {
+        // Reversal: 500 cycles of two.
+        vector<uint32_t> order(items.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(order.size() - 1 - i);
+        Counted::moves = 0;
+        applyPermutation(items, order);
+        CHECK(items.front().value == 999);
+        CHECK(items.back().value == 0);
+        CHECK(Counted::moves == 1500);
+    }
+}
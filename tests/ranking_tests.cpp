@@ -0,0 +1,42 @@
+#include "doctest.h"
+#include "../src/ranking.h"
+
+TEST_CASE("Title terms") {
+    vector<string> terms;
+    forEachTerm("Buy MILK, bread & 2 eggs!", [&](string_view term) { terms.push_back(normalizeTerm(term)); });
+    CHECK(terms == vector<string>{ "buy", "milk", "bread", "2", "eggs" });
+    CHECK(termEquals("MiLk", "milk"));
+    CHECK_FALSE(termEquals("milky", "milk"));
+}
+
+TEST_CASE("Term statistics and BM25") {
+    TermStatistics statistics;
+    statistics.addTitle("Buy milk");
+    statistics.addTitle("Buy bread");
+    statistics.addTitle("Call mom about milk milk");
+
+    SUBCASE("Document frequencies count each title once") {
+        CHECK(statistics.documentFrequency("milk") == 2);
+        CHECK(statistics.documentFrequency("buy") == 2);
+        CHECK(statistics.documentFrequency("tea") == 0);
+        CHECK(statistics.documentCount() == 3);
+        CHECK(statistics.averageLength() == doctest::Approx(3.0));
+    }
+
+    SUBCASE("Removing a title") {
+        statistics.removeTitle("Buy milk");
+        CHECK(statistics.documentFrequency("milk") == 1);
+        CHECK(statistics.documentCount() == 2);
+    }
+
+    SUBCASE("Rare terms weigh more") {
+        const Bm25Scorer scorer("bread milk", statistics);
+        CHECK(scorer.score("Buy bread") > scorer.score("Buy milk"));
+        CHECK(scorer.score("Walk the dog") == 0);
+    }
+
+    SUBCASE("Shorter titles score higher for the same term") {
+        const Bm25Scorer scorer("milk", statistics);
+        CHECK(scorer.score("milk") > scorer.score("milk and some other long words"));
+    }
+}
@@ -0,0 +1,67 @@
+#include "doctest.h"
+#include "../src/regex.h"
+#include <regex>
+#include <stdexcept>
+
+namespace {
+
+bool matches(const string& pattern, const string& text) {
+    const Regex regex(pattern);
+    Regex::Matcher matcher(regex);
+    return matcher.search(text.data(), text.size());
+}
+
+}
+
+TEST_CASE("Regex matching") {
+    SUBCASE("Agrees with std::regex on ASCII patterns") {
+        const vector<string> patterns = { "milk", "^Buy (milk|bread)", "(ab|a)*c$", "^$", "a{2,3}b", "x?y+z*",
+            "[a-c]+d", "[^ ]+ [^ ]+$", "\\d{2}\\.\\d{2}", "^(a|b)*$", "b.d", "\\w+\\s\\w+", "(|x)y", "a{2}", "a{1,}b" };
+        const vector<string> texts = { "", "milk", "Buy milk", "Buy bread now", "buy milk", "abac", "ac", "aac",
+            "aab", "aaab", "ab", "xyz", "yyy", "abcd", "ccd", "one two", "one two three", "12.05", "1.2", "abab", "abd",
+            "bxd", "y", "aaaa", "hello world" };
+        for (const auto& pattern : patterns) {
+            const std::regex reference(pattern);
+            for (const auto& text : texts) {
+                INFO(pattern << " on \"" << text << "\"");
+                CHECK(matches(pattern, text) == std::regex_search(text, reference));
+            }
+        }
+    }
+
+    SUBCASE("UTF-8 code points") {
+        CHECK(matches("^Куп.ть", "Купить молоко"));
+        CHECK_FALSE(matches("^Куп.ть", "Куп ить"));
+        CHECK(matches("[а-я]+ хлеб", "купить хлеб"));
+        CHECK_FALSE(matches("^[а-я]+$", "Купить"));
+        CHECK(matches("^[А-Яа-яЁё]+$", "Ёжик"));
+        CHECK(matches("^[^а-я]$", "Ж"));
+        CHECK_FALSE(matches("^[^а-я]$", "ж"));
+        CHECK(matches("^\\w+$", "Привет"));
+        CHECK(matches("^.{3}$", "日本語"));
+        CHECK(matches("^.{2}$", "😀ж"));
+    }
+
+    SUBCASE("Syntax errors") {
+        for (const string pattern : { "(milk", "milk)", "*a", "[a-", "[z-a]", "a{3,2}", "\\q", "a\\", "^*" }) {
+            CHECK_THROWS_AS(Regex{ pattern }, invalid_argument);
+        }
+        CHECK_THROWS_AS(Regex{ "\xD0" }, invalid_argument);
+        CHECK(matches("a{", "a{"));
+    }
+}
+
+TEST_CASE("Regex literal analysis") {
+    const Regex anchored("^Buy (milk|bread)");
+    CHECK(anchored.literalPrefix() == "Buy ");
+    CHECK(anchored.anchoredPrefix());
+    CHECK(anchored.requiredLiterals() == vector<string>{ "Buy " });
+
+    const Regex unanchored("report.*with (team)+");
+    CHECK(unanchored.literalPrefix() == "report");
+    CHECK_FALSE(unanchored.anchoredPrefix());
+    CHECK(unanchored.requiredLiterals() == vector<string>{ "report", "with ", "team" });
+
+    CHECK(Regex("milk|bread").requiredLiterals().empty());
+    CHECK(Regex("a*b").literalPrefix().empty());
+}
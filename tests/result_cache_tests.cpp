@@ -0,0 +1,40 @@
+#include "doctest.h"
+#include "../src/result_cache.h"
+
+TEST_CASE("Result cache") {
+    ResultCache cache(2);
+
+    SUBCASE("Stores and finds entries") {
+        cache.store("a", { { 1, 2 }, 1, 3 });
+        auto* entry = cache.find("a");
+        REQUIRE(entry != nullptr);
+        CHECK(entry->indices == vector<size_t>{ 1, 2 });
+        CHECK(entry->epoch == 1);
+        CHECK(entry->taskCount == 3);
+        CHECK(cache.find("b") == nullptr);
+    }
+
+    SUBCASE("Evicts the least recently used entry") {
+        cache.store("a", { {}, 0, 0 });
+        cache.store("b", { {}, 0, 0 });
+        cache.find("a");
+        cache.store("c", { {}, 0, 0 });
+        CHECK(cache.find("a") != nullptr);
+        CHECK(cache.find("b") == nullptr);
+        CHECK(cache.find("c") != nullptr);
+        CHECK(cache.stats().evictions == 1);
+    }
+
+    SUBCASE("Zero capacity disables caching") {
+        cache.setCapacity(0);
+        cache.store("a", { {}, 0, 0 });
+        CHECK(cache.find("a") == nullptr);
+    }
+
+    SUBCASE("Hit rate") {
+        cache.stats().hits = 3;
+        cache.stats().patches = 1;
+        cache.stats().misses = 4;
+        CHECK(cache.stats().hitRate() == doctest::Approx(0.5));
+    }
+}
@@ -0,0 +1,42 @@
+#include "doctest.h"
+#include "../src/search_kernel.h"
+#include <random>
+
+static size_t referenceFind(const string& haystack, const string& needle) {
+    return haystack.find(needle);
+}
+
+TEST_CASE("Search kernel") {
+    SUBCASE("Simple matches") {
+        const string text = "Buy milk and bread";
+        CHECK(findSubstring(text.data(), text.size(), "milk", 4) == 4);
+        CHECK(findSubstring(text.data(), text.size(), "bread", 5) == 13);
+        CHECK(findSubstring(text.data(), text.size(), "B", 1) == 0);
+        CHECK(findSubstring(text.data(), text.size(), "", 0) == 0);
+        CHECK(findSubstring(text.data(), text.size(), "cheese", 6) == string::npos);
+    }
+
+    SUBCASE("Needle longer than haystack") {
+        CHECK(findSubstring("ab", 2, "abc", 3) == string::npos);
+    }
+
+    SUBCASE("Matches at block boundaries") {
+        for (size_t position = 0; position < 100; ++position) {
+            string text(100, 'a');
+            text.replace(position, min<size_t>(3, 100 - position), string("xyz").substr(0, 100 - position));
+            CHECK(findSubstring(text.data(), text.size(), "xyz", 3) == referenceFind(text, "xyz"));
+        }
+    }
+
+    SUBCASE("Agrees with std::string::find on random input") {
+        mt19937 rng(42);
+        uniform_int_distribution<int> letter('a', 'd');
+        for (int round = 0; round < 2000; ++round) {
+            string text(rng() % 200, ' ');
+            for (auto& c : text) c = static_cast<char>(letter(rng));
+            string needle(1 + rng() % 6, ' ');
+            for (auto& c : needle) c = static_cast<char>(letter(rng));
+            CHECK(findSubstring(text.data(), text.size(), needle.data(), needle.size()) == referenceFind(text, needle));
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#include "doctest.h"
+#include "../src/snapshot_task_manager.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+TEST_CASE("Persistent task list") {
+    PersistentTaskList tasks;
+    for (int i = 0; i < 1000; ++i) tasks.pushBack({ "Task " + to_string(i), "01.01.2025", 1, false });
+    CHECK(tasks.size() == 1000);
+    CHECK(tasks.chunkCount() == 4);
+
+    SUBCASE("Copies share the chunks they do not change") {
+        PersistentTaskList copy = tasks;
+        copy.set(300, { "Changed", "02.01.2025", 3, true });
+        CHECK(copy[300].title == "Changed");
+        CHECK(tasks[300].title == "Task 300");
+        CHECK(copy.sharedChunks(tasks) == 3);
+
+        copy.pushBack({ "Appended", "", 1, false });
+        CHECK(tasks.size() == 1000);
+        CHECK(copy[1000].title == "Appended");
+        CHECK(copy.sharedChunks(tasks) == 2);
+    }
+
+    SUBCASE("Erasing shifts later tasks and folds emptied chunks") {
+        PersistentTaskList copy = tasks;
+        for (int i = 0; i < 255; ++i) copy.erase(0);
+        CHECK(copy.size() == 745);
+        CHECK(copy[0].title == "Task 255");
+        CHECK(copy[744].title == "Task 999");
+        CHECK(copy.chunkCount() == 4);
+        copy.erase(0);
+        CHECK(copy.chunkCount() == 3);
+        CHECK(copy[0].title == "Task 256");
+        CHECK(tasks[0].title == "Task 0");
+
+        // The last two chunks fold together once they fit in one.
+        for (int i = 0; i < 232; ++i) copy.erase(256);
+        CHECK(copy.chunkCount() == 2);
+        CHECK(copy[256].title == "Task 744");
+
+        const auto all = copy.toVector();
+        REQUIRE(all.size() == 512);
+        CHECK(all[500].title == copy[500].title);
+    }
+
+    SUBCASE("Searches see every write to a chunk") {
+        CHECK(tasks.findTaskIndices("TASK 99", true) == vector<size_t>{ 99, 990, 991, 992, 993, 994, 995, 996, 997, 998, 999 });
+        CHECK(tasks.findTaskIndices("TASK 99", false).empty());
+        CHECK(tasks.findTaskIndices("", true).size() == 1000);
+
+        PersistentTaskList copy = tasks;
+        copy.set(300, { "Позвонить МАМЕ", "02.01.2025", 3, true });
+        copy.pushBack({ "ПОЗВОНИТЬ маме ещё раз", "", 1, false });
+        for (int i = 0; i < 500; ++i) copy.erase(400);
+        CHECK(copy.findTaskIndices("позвонить мам", true) == vector<size_t>{ 300, 500 });
+        CHECK(copy.findTaskIndices("МАМЕ", false) == vector<size_t>{ 300 });
+        CHECK(copy.findTaskIndices("task 90", true) == vector<size_t>{ 90, 400, 401, 402, 403, 404, 405, 406, 407, 408, 409 });
+        CHECK(tasks.findTaskIndices("мам", true).empty());
+
+        // Matches in the date and the last record of a chunk are found, and a keyword
+        // never matches across the title/date separator.
+        CHECK(copy.findTaskIndices("02.01", true) == vector<size_t>{ 300 });
+        CHECK(copy.findTaskIndices("task 255", true) == vector<size_t>{ 255 });
+        CHECK(copy.findTaskIndices("0101", true).empty());
+    }
+}
+
+TEST_CASE("Snapshot task manager") {
+    SnapshotTaskManager manager;
+    manager.addTask("Buy milk", "10.12.2024", 2);
+    manager.addTask("Call mom", "20.01.2026", 1);
+
+    SUBCASE("A snapshot keeps its version") {
+        const auto before = manager.snapshot();
+        manager.editTask(0, "Buy bread");
+        manager.deleteTask(1);
+        CHECK(before.getTaskCount() == 2);
+        CHECK(before.getTask(0).title == "Buy milk");
+        CHECK(before.version() == 2);
+
+        const auto after = manager.snapshot();
+        CHECK(after.getTaskCount() == 1);
+        CHECK(after.getTask(0).title == "Buy bread");
+        CHECK(after.version() == 4);
+        CHECK_THROWS_AS(after.getTask(1), out_of_range);
+        CHECK_FALSE(manager.editTask(5, "Nothing"));
+    }
+
+    SUBCASE("Queries, sorting and files") {
+        manager.markCompleted(1);
+        CHECK(manager.snapshot().findTaskIndices("MOM", true) == vector<size_t>{ 1 });
+        CHECK(manager.snapshot().findTaskIndices("2024") == vector<size_t>{ 0 });
+
+        manager.sortTasks({ { SortField::Priority } });
+        const auto sorted = manager.snapshot();
+        CHECK(sorted.getTask(0).title == "Call mom");
+        CHECK(sorted.getTask(0).completed);
+
+        manager.saveToFile("snapshot_tasks_test.txt");
+        SnapshotTaskManager loaded;
+        loaded.loadFromFile("snapshot_tasks_test.txt");
+        CHECK(loaded.getTaskCount() == 2);
+        CHECK(loaded.snapshot().getTask(1).title == "Buy milk");
+        remove("snapshot_tasks_test.txt");
+    }
+
+    SUBCASE("Replaced versions are deleted once no snapshot holds them") {
+        {
+            const auto held = manager.snapshot();
+            for (int i = 0; i < 10; ++i) manager.addTask("More", "", 1);
+            CHECK(manager.pendingVersions() == 10);
+            CHECK(held.getTaskCount() == 2);
+        }
+        manager.addTask("Last", "", 1);
+        CHECK(manager.pendingVersions() == 0);
+    }
+
+    SUBCASE("A bulk update publishes one version") {
+        const uint64_t version = manager.snapshot().version();
+        const size_t added = manager.update([](PersistentTaskList& tasks) {
+            for (int i = 0; i < 500; ++i) tasks.pushBack({ "Imported", "", 1, false });
+            return tasks.size();
+        });
+        CHECK(added == 502);
+        CHECK(manager.snapshot().version() == version + 1);
+    }
+}
+
+TEST_CASE("Snapshot readers and writers") {
+    SnapshotTaskManager manager;
+    manager.update([](PersistentTaskList& tasks) {
+        for (int i = 0; i < 2000; ++i) tasks.pushBack({ "Task", "01.01.2025", 1, false });
+    });
+
+    // Every version has all titles "Task" and one more task than its predecessor had
+    // tasks added, so a reader can check each snapshot against itself.
+    atomic<bool> writing{ true };
+    atomic<size_t> failures{ 0 };
+    const auto reader = [&] {
+        uint64_t lastVersion = 0;
+        size_t reads = 0;
+        while (writing || reads < 50) {
+            ++reads;
+            const auto view = manager.snapshot();
+            if (view.version() < lastVersion) ++failures;
+            lastVersion = view.version();
+            const size_t count = view.getTaskCount();
+            size_t titled = 0;
+            view.tasks().forEach([&](size_t, const Task& task) { titled += task.title == "Task"; });
+            if (titled != count || view.findTaskIndices("Task").size() != count) ++failures;
+        }
+    };
+
+    vector<thread> readers;
+    for (int i = 0; i < 4; ++i) readers.emplace_back(reader);
+    thread writer([&] {
+        for (int i = 0; i < 300; ++i) {
+            manager.addTask("Task", "02.01.2025", 2);
+            manager.editTask(i * 5, "", "03.01.2025");
+            if (i % 3 == 0) manager.deleteTask(i);
+        }
+    });
+    manager.update([](PersistentTaskList& tasks) {
+        for (int i = 0; i < 1000; ++i) tasks.pushBack({ "Task", "04.01.2025", 3, false });
+    });
+    writer.join();
+    writing = false;
+    for (auto& thread : readers) thread.join();
+
+    CHECK(failures.load() == 0);
+    CHECK(manager.getTaskCount() == 2000 + 300 - 100 + 1000);
+    CHECK(manager.pendingVersions() == 0);
+}
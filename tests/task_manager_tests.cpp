@@ -1,6 +1,8 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "../src/task_manager.h"
+#include "../src/task_query.h"
+#include <regex>
 
 TEST_CASE("Adding and getting tasks") {
     TaskManager manager;
@@ -64,6 +66,432 @@ TEST_CASE("Finding tasks") {
         auto results = manager.findTaskIndices("Non-existent");
         CHECK(results.empty());
     }
+
+    SUBCASE("Find does not match across title and date") {
+        auto results = manager.findTaskIndices("milk01");
+        CHECK(results.empty());
+    }
+
+    SUBCASE("Find after edit, delete and add") {
+        manager.findTaskIndices("Buy");
+        manager.editTask(1, "Buy cheese", "", -1);
+        manager.deleteTask(0);
+        manager.addTask("Buy tea", "04.01.2025", 1);
+
+        auto results = manager.findTaskIndices("Buy");
+        REQUIRE(results.size() == 3);
+        CHECK(results[0] == 0);
+        CHECK(results[1] == 1);
+        CHECK(results[2] == 2);
+    }
+}
+
+TEST_CASE("Finding tasks by expression") {
+    TaskManager manager;
+    manager.addTask("Buy milk", "01.01.2025", 1);
+    manager.addTask("Feed the cat", "02.01.2025", 2);
+    manager.addTask("Buy bread", "03.01.2025", 3);
+    manager.addTask("Buy cat food", "03.01.2025", 1);
+
+    SUBCASE("OR") {
+        CHECK(manager.findTaskIndicesMatching("milk OR bread") == vector<size_t>{ 0, 2 });
+    }
+
+    SUBCASE("AND") {
+        CHECK(manager.findTaskIndicesMatching("cat AND Feed") == vector<size_t>{ 1 });
+        CHECK(manager.findTaskIndicesMatching("Buy 03.01") == vector<size_t>{ 2, 3 });
+    }
+
+    SUBCASE("NOT") {
+        CHECK(manager.findTaskIndicesMatching("Buy NOT cat") == vector<size_t>{ 0, 2 });
+    }
+
+    SUBCASE("Single keyword behaves like findTaskIndices") {
+        CHECK(manager.findTaskIndicesMatching("Buy") == manager.findTaskIndices("Buy"));
+    }
+
+    SUBCASE("Invalid expression") {
+        CHECK_THROWS_AS(manager.findTaskIndicesMatching("milk OR"), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Fuzzy search") {
+    TaskManager manager;
+    manager.addTask("Finish homework", "01.01.2025", 1);
+    manager.addTask("Call mom", "02.01.2025", 2);
+    manager.addTask("Homework review", "03.01.2025", 3);
+    manager.addTask("Book tickets", "04.01.2025", 1);
+
+    SUBCASE("Ranks by distance") {
+        auto matches = manager.findTasksFuzzy("homwork", 2);
+        REQUIRE(matches.size() == 2);
+        CHECK(matches[0].index == 0);
+        CHECK(matches[0].distance == 1);
+        CHECK(matches[1].index == 2);
+        CHECK(matches[1].distance == 2);
+    }
+
+    SUBCASE("Distance bound") {
+        CHECK(manager.findTasksFuzzy("homwork", 1).size() == 1);
+        CHECK(manager.findTasksFuzzy("homwork", 0).empty());
+    }
+
+    SUBCASE("Dates are not searched") {
+        CHECK(manager.findTasksFuzzy("02.01.2025", 0).empty());
+    }
+}
+
+TEST_CASE("Finding tasks by date range") {
+    TaskManager manager;
+    manager.addTask("March", "15.03.2025", 1);
+    manager.addTask("January", "20.01.2025", 2);
+    manager.addTask("February", "10.02.2025", 3);
+    manager.addTask("No date", "someday", 1);
+    manager.addTask("Also January", "20.01.2025", 1);
+
+    SUBCASE("Results in date order") {
+        CHECK(manager.findTasksInRange("01.01.2025", "28.02.2025") == vector<size_t>{ 1, 4, 2 });
+        CHECK(manager.findTasksInRange("20.01.2025", "20.01.2025") == vector<size_t>{ 1, 4 });
+        CHECK(manager.findTasksInRange("01.04.2025", "01.05.2025").empty());
+        CHECK(manager.findTasksInRange("01.05.2025", "01.04.2025").empty());
+    }
+
+    SUBCASE("Index follows edits and deletes") {
+        manager.editTask(0, "", "05.01.2025", -1);
+        manager.deleteTask(1);
+        manager.addTask("Late January", "31.01.2025", 1);
+        CHECK(manager.findTasksInRange("01.01.2025", "31.01.2025") == vector<size_t>{ 0, 3, 4 });
+    }
+
+    SUBCASE("Index follows sorting") {
+        manager.sortTasks([](const Task& a, const Task& b) { return a.title < b.title; });
+        CHECK(manager.getTask(0).title == "Also January");
+        CHECK(manager.findTasksInRange("01.01.2025", "31.01.2025") == vector<size_t>{ 0, 2 });
+    }
+
+    SUBCASE("Invalid bounds") {
+        CHECK_THROWS_AS(manager.findTasksInRange("tomorrow", "01.01.2025"), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Structured queries") {
+    TaskManager manager;
+    for (int i = 0; i < 1000; ++i) {
+        const string day = (i % 28 + 1 < 10 ? "0" : "") + to_string(i % 28 + 1);
+        manager.addTask(i % 10 == 0 ? "Buy milk" : "Task", day + ".0" + to_string(i % 9 + 1) + ".2025", i % 3 + 1);
+        if (i % 4 == 0) manager.markCompleted(i);
+    }
+
+    auto bruteForce = [&](const string& query) {
+        const auto parsed = TaskQuery::parse(query);
+        vector<size_t> indices;
+        for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+            if (parsed.matches(manager.getTask(i))) indices.push_back(i);
+        }
+        return indices;
+    };
+
+    SUBCASE("Results match a full evaluation") {
+        for (const string query : {
+            "priority>=2 completed:no due<01.05.2025 text:\"milk\"",
+            "due:01.01.2025",
+            "priority:3 OR completed:yes",
+            "NOT milk",
+            "priority!=2 due>=15.03.2025",
+            "completed:no (milk OR priority:1)" }) {
+            CHECK(manager.findTasksByQuery(query) == bruteForce(query));
+        }
+    }
+
+    SUBCASE("Planner picks the most selective index") {
+        CHECK(manager.explainQuery("due:01.01.2025 priority>=2").find("Plan: date index range due=01.01.2025 -> filter") != string::npos);
+        CHECK(manager.explainQuery("priority:1").find("Plan: priority index range priority=1\n") != string::npos);
+        CHECK(manager.explainQuery("completed:yes").find("Plan: completion bitmap") != string::npos);
+        CHECK(manager.explainQuery("milk").find("Plan: text scan") != string::npos);
+        CHECK(manager.explainQuery("NOT milk").find("Plan: full scan") != string::npos);
+        CHECK(manager.explainQuery("due:01.01.2025 OR due:02.01.2025").find("Plan: union of") != string::npos);
+    }
+
+    SUBCASE("Explain reports estimated and actual rows") {
+        const string explain = manager.explainQuery("due:01.01.2025");
+        CHECK(explain.find("Candidate rows: estimated 4, actual 4") != string::npos);
+        CHECK(explain.find("Result rows: estimated 4, actual 4") != string::npos);
+    }
+
+    SUBCASE("Indexes follow mutations") {
+        manager.editTask(1, "", "01.01.2025", 3);
+        manager.deleteTask(0);
+        manager.markCompleted(0);
+        CHECK(manager.findTasksByQuery("due:01.01.2025 priority:3 completed:yes") == bruteForce("due:01.01.2025 priority:3 completed:yes"));
+        CHECK(manager.findTasksByQuery("completed:yes") == bruteForce("completed:yes"));
+    }
+}
+
+TEST_CASE("Ranked search") {
+    TaskManager manager;
+    RankingOptions options;
+    options.todayKey = 20250101;
+
+    manager.addTask("Buy milk", "01.06.2025", 1);
+    manager.addTask("Buy bread and milk", "01.06.2025", 1);
+    manager.addTask("Call mom", "01.06.2025", 1);
+    manager.addTask("Buy milk", "01.06.2025", 3);
+    manager.addTask("Buy milk", "01.01.2025", 1);
+
+    SUBCASE("Top k, best first") {
+        auto top = manager.findTopTasks("milk", 2, options);
+        REQUIRE(top.size() == 2);
+        CHECK(top[0].index == 4);
+        CHECK(top[1].index == 3);
+        CHECK(top[0].score >= top[1].score);
+    }
+
+    SUBCASE("Only matching tasks are returned") {
+        auto top = manager.findTopTasks("milk", 10, options);
+        CHECK(top.size() == 4);
+        CHECK(top.back().index == 1);
+        CHECK(manager.findTopTasks("tea", 10, options).empty());
+        CHECK(manager.findTopTasks("milk", 0, options).empty());
+    }
+
+    SUBCASE("Without boosts shorter titles win") {
+        options.priorityWeight = 0;
+        options.dueWeight = 0;
+        auto top = manager.findTopTasks("MILK", 4, options);
+        REQUIRE(top.size() == 4);
+        CHECK(top[0].index == 0);
+        CHECK(top[3].index == 1);
+    }
+
+    SUBCASE("Statistics follow edits and deletes") {
+        manager.editTask(2, "Call mom about milk", "", -1);
+        manager.deleteTask(0);
+        options.priorityWeight = 0;
+        options.dueWeight = 0;
+        auto top = manager.findTopTasks("mom milk", 1, options);
+        REQUIRE(top.size() == 1);
+        CHECK(top[0].index == 1);
+    }
+}
+
+TEST_CASE("Regex search") {
+    TaskManager manager;
+    for (int i = 0; i < 3 * 4096; ++i) {
+        const string titles[] = { "Buy milk", "Buy bread", "Sell milk", "Купить хлеб", "Call mom about milk" };
+        manager.addTask(i == 5000 ? "Renew passport 2025" : titles[i % 5], "01.06.2025", 1);
+    }
+
+    auto bruteForce = [&](const string& pattern) {
+        const std::regex reference(pattern);
+        vector<size_t> indices;
+        for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+            if (std::regex_search(manager.getTask(i).title, reference)) indices.push_back(i);
+        }
+        return indices;
+    };
+
+    for (const string pattern : { "^Buy (milk|bread)", "milk$", "mom.*milk", "passport \\d+", "^(Sell|Call) ", "o[^o]*o" }) {
+        CHECK(manager.findTasksByRegex(pattern) == bruteForce(pattern));
+    }
+    CHECK(manager.findTasksByRegex("^Куп[иа]ть").size() == 3 * 4096 / 5);
+
+    const auto before = manager.blockSkipStats();
+    CHECK(manager.findTasksByRegex("pass(port|word)") == vector<size_t>{ 5000 });
+    CHECK(manager.blockSkipStats().skipped - before.skipped == 2);
+
+    manager.addTask("Buy bread", "01.06.2025", 1);
+    CHECK(manager.findTasksByRegex("^Buy (milk|bread)") == bruteForce("^Buy (milk|bread)"));
+    CHECK_THROWS_AS(manager.findTasksByRegex("(milk"), invalid_argument);
+}
+
+TEST_CASE("Paginated search") {
+    TaskManager manager;
+    for (int i = 0; i < 10; ++i) manager.addTask(i % 2 ? "Buy milk" : "Call mom", "01.06.2025", 1);
+
+    SUBCASE("Pages in task order") {
+        auto cursor = manager.searchCursor("milk");
+        CHECK(cursor.next(2) == vector<size_t>{ 1, 3 });
+        CHECK(cursor.next(2) == vector<size_t>{ 5, 7 });
+        CHECK_FALSE(cursor.done());
+        CHECK(cursor.next(2) == vector<size_t>{ 9 });
+        CHECK(cursor.done());
+        CHECK(cursor.next(2).empty());
+    }
+
+    SUBCASE("Offset and limit") {
+        auto cursor = manager.searchCursor("MILK OR mom", true);
+        CHECK(cursor.skip(7) == 7);
+        CHECK(cursor.next(5) == vector<size_t>{ 7, 8, 9 });
+        CHECK(manager.searchCursor("milk").skip(100) == 5);
+    }
+
+    SUBCASE("Resuming from a token") {
+        auto cursor = manager.searchCursor("milk NOT mom");
+        cursor.next(3);
+        manager.addTask("Buy milk", "01.06.2025", 1);
+        auto resumed = manager.resumeSearch(cursor.token());
+        CHECK(resumed.next(10) == vector<size_t>{ 7, 9, 10 });
+        CHECK(cursor.next(10) == vector<size_t>{ 7, 9, 10 });
+    }
+
+    SUBCASE("Stale and malformed tokens") {
+        auto cursor = manager.searchCursor("milk");
+        cursor.next(1);
+        const string token = cursor.token();
+        manager.editTask(0, "Buy milk", "", -1);
+        CHECK_THROWS_AS(manager.resumeSearch(token), invalid_argument);
+        CHECK_THROWS_AS(cursor.next(1), invalid_argument);
+        CHECK_THROWS_AS(manager.resumeSearch("garbage"), invalid_argument);
+        CHECK_THROWS_AS(manager.resumeSearch("1:x:c:milk"), invalid_argument);
+        CHECK_THROWS_AS(manager.resumeSearch("99999:0:c:milk"), invalid_argument);
+    }
+}
+
+TEST_CASE("Case-insensitive search") {
+    TaskManager manager;
+    manager.addTask("Купить молоко", "01.06.2025", 1);
+    manager.addTask("КУПИТЬ хлеб", "01.06.2025", 1);
+    manager.addTask("Buy MILK", "01.06.2025", 1);
+
+    CHECK(manager.findTaskIndices("купить").empty());
+    CHECK(manager.findTaskIndices("купить", true) == vector<size_t>{ 0, 1 });
+    CHECK(manager.findTaskIndices("Milk", true) == vector<size_t>{ 2 });
+    CHECK(manager.findTaskIndicesMatching("кУпИтЬ AND (Молоко OR ХЛЕБ)", true) == vector<size_t>{ 0, 1 });
+    CHECK(manager.findTaskIndicesMatching("купить NOT ХЛЕБ", true) == vector<size_t>{ 0 });
+
+    SUBCASE("The folded column follows edits and appends") {
+        manager.editTask(2, "Купить сыр", "", -1);
+        CHECK(manager.findTaskIndices("КУПИТЬ", true) == vector<size_t>{ 0, 1, 2 });
+        manager.addTask("купить чай", "01.06.2025", 1);
+        CHECK(manager.findTaskIndices("КУПИТЬ", true) == vector<size_t>{ 0, 1, 2, 3 });
+        manager.deleteTask(0);
+        CHECK(manager.findTaskIndices("молоко", true).empty());
+    }
+
+    SUBCASE("Suggestions ignore case") {
+        CHECK(manager.suggestTitles("куп") == vector<string>{ "КУПИТЬ хлеб", "Купить молоко" });
+    }
+}
+
+TEST_CASE("Title suggestions") {
+    TaskManager manager;
+    manager.addTask("Buy milk", "01.06.2025", 1);
+    manager.addTask("Buy bread", "01.06.2025", 1);
+    manager.addTask("Buy milk", "02.06.2025", 2);
+
+    CHECK(manager.suggestTitles("buy") == vector<string>{ "Buy milk", "Buy bread" });
+    CHECK(manager.suggestTitles("buy", 1) == vector<string>{ "Buy milk" });
+
+    manager.editTask(1, "Call mom", "", -1);
+    CHECK(manager.suggestTitles("buy b").empty());
+    CHECK(manager.suggestTitles("c") == vector<string>{ "Call mom" });
+
+    manager.deleteTask(0);
+    manager.deleteTask(1);
+    CHECK(manager.suggestTitles("buy").empty());
+}
+
+TEST_CASE("Search result cache") {
+    TaskManager manager;
+    manager.addTask("Buy milk", "01.01.2025", 1);
+    manager.addTask("Call mom", "02.01.2025", 2);
+
+    SUBCASE("Repeated search is a hit") {
+        manager.findTaskIndices("Buy");
+        CHECK(manager.findTaskIndices("Buy") == vector<size_t>{ 0 });
+        CHECK(manager.resultCacheStats().misses == 1);
+        CHECK(manager.resultCacheStats().hits == 1);
+    }
+
+    SUBCASE("Appends patch the cached result") {
+        manager.findTasksByQuery("priority>=1 Buy");
+        manager.addTask("Buy bread", "03.01.2025", 3);
+        CHECK(manager.findTasksByQuery("priority>=1 AND Buy") == vector<size_t>{ 0, 2 });
+        CHECK(manager.resultCacheStats().patches == 1);
+        CHECK(manager.resultCacheStats().misses == 1);
+    }
+
+    SUBCASE("Other mutations invalidate the cached result") {
+        manager.findTaskIndicesMatching("milk OR mom");
+        manager.editTask(1, "Call dad", "", -1);
+        CHECK(manager.findTaskIndicesMatching("milk OR mom") == vector<size_t>{ 0 });
+        manager.deleteTask(0);
+        CHECK(manager.findTaskIndicesMatching("milk OR mom").empty());
+        manager.markCompleted(0);
+        CHECK(manager.findTaskIndicesMatching("milk OR mom").empty());
+        CHECK(manager.resultCacheStats().misses == 4);
+        CHECK(manager.resultCacheStats().hits == 0);
+    }
+
+    SUBCASE("Disabled cache") {
+        manager.setResultCacheCapacity(0);
+        manager.findTaskIndices("Buy");
+        manager.findTaskIndices("Buy");
+        CHECK(manager.resultCacheStats().misses == 2);
+    }
+}
+
+TEST_CASE("Finding tasks in a large list") {
+    TaskManager manager;
+    for (int i = 0; i < 100000; ++i) {
+        manager.addTask(i % 7 == 0 ? "Buy milk " + to_string(i) : "Task " + to_string(i), "01.01.2025", 1);
+    }
+
+    auto results = manager.findTaskIndices("milk");
+    REQUIRE(results.size() == (100000 + 6) / 7);
+    for (size_t i = 0; i < results.size(); ++i) CHECK(results[i] == i * 7);
+}
+
+TEST_CASE("Skipping blocks") {
+    TaskManager manager;
+    const int count = 5 * 4096;
+    for (int i = 0; i < count; ++i) {
+        const int month = i * 12 / count + 1;
+        manager.addTask(i == 10000 ? "Renew passport" : "Task " + to_string(i % 100),
+            "01." + string(month < 10 ? "0" : "") + to_string(month) + ".2025", i < 3 * 4096 ? 1 + i % 3 : 2);
+    }
+
+    auto bruteForce = [&](const string& query) {
+        const auto parsed = TaskQuery::parse(query);
+        vector<size_t> indices;
+        for (size_t i = 0; i < manager.getTaskCount(); ++i) {
+            if (parsed.matches(manager.getTask(i))) indices.push_back(i);
+        }
+        return indices;
+    };
+
+    SUBCASE("Keyword scans skip blocks without the keyword's trigrams") {
+        const auto before = manager.blockSkipStats();
+        CHECK(manager.findTaskIndices("passport") == vector<size_t>{ 10000 });
+        CHECK(manager.findTaskIndices("PASSPORT", true) == vector<size_t>{ 10000 });
+        const auto after = manager.blockSkipStats();
+        CHECK(after.skipped - before.skipped >= 8);
+        CHECK(after.scanned - before.scanned <= 2);
+
+        manager.addTask("Passport photos", "01.12.2025", 1);
+        manager.editTask(0, "Passport", "", -1);
+        CHECK(manager.findTaskIndices("assport") == vector<size_t>{ 0, 10000, static_cast<size_t>(count) });
+        CHECK(manager.findTaskIndices("passport", true) == vector<size_t>{ 0, 10000, static_cast<size_t>(count) });
+    }
+
+    SUBCASE("Full scans skip or take whole blocks by zone map") {
+        for (const string query : { "NOT due<01.10.2025", "NOT priority:2", "NOT (completed:yes OR due<01.06.2025)" }) {
+            CHECK(manager.explainQuery(query).find("Plan: full scan") != string::npos);
+            CHECK(manager.findTasksByQuery(query) == bruteForce(query));
+        }
+        CHECK(manager.explainQuery("NOT due<01.10.2025").find("Blocks decided by zone maps: 4 of 5") != string::npos);
+        CHECK(manager.explainQuery("NOT priority:2").find("Blocks decided by zone maps: 2 of 5") != string::npos);
+    }
+
+    SUBCASE("Zone maps follow mutations") {
+        manager.editTask(100, "", "01.12.2025", 5);
+        manager.markCompleted(5000);
+        manager.deleteTask(4000);
+        manager.addTask("Extra", "01.01.2025", 7);
+        for (const string query : { "NOT due<01.10.2025", "NOT priority:2", "NOT (completed:yes OR due<01.06.2025)", "NOT priority<=3" }) {
+            CHECK(manager.findTasksByQuery(query) == bruteForce(query));
+        }
+    }
 }
 
 TEST_CASE("Editing tasks") {
@@ -125,6 +553,150 @@ TEST_CASE("Sorting tasks") {
         CHECK(manager.getTask(0).date == "03.01.2025");
         CHECK(manager.getTask(2).date == "01.01.2025");
     }
+
+    SUBCASE("Type-erased comparator") {
+        const function<bool(const Task&, const Task&)> comparator = [](const Task& a, const Task& b) { return a.title < b.title; };
+        manager.sortTasks(comparator);
+        CHECK(manager.getTask(0).title == "High");
+        CHECK(manager.getTask(2).title == "Medium");
+    }
+}
+
+TEST_CASE("Named sort orders") {
+    TaskManager manager;
+    manager.addTask("Report", "05.03.2025", 2);
+    manager.addTask("Call", "20.01.2026", 1);
+    manager.addTask("Buy milk", "10.12.2024", 3);
+
+    const auto titles = [&] {
+        string joined;
+        for (size_t i = 0; i < manager.getTaskCount(); ++i) joined += manager.getTask(i).title + ";";
+        return joined;
+    };
+
+    SUBCASE("Priority") {
+        manager.sortTasks(SortOrder::PriorityAscending);
+        CHECK(titles() == "Call;Report;Buy milk;");
+        manager.sortTasks(SortOrder::PriorityDescending);
+        CHECK(titles() == "Buy milk;Report;Call;");
+    }
+
+    SUBCASE("Dates compare chronologically, not as strings") {
+        manager.sortTasks(SortOrder::DateAscending);
+        CHECK(titles() == "Buy milk;Report;Call;");
+        manager.sortTasks(ByDateDescending());
+        CHECK(titles() == "Call;Report;Buy milk;");
+    }
+
+    SUBCASE("Title") {
+        manager.sortTasks(SortOrder::Title);
+        CHECK(titles() == "Buy milk;Call;Report;");
+    }
+
+    SUBCASE("Priority and date orders are stable") {
+        manager.addTask("Pay bills", "05.03.2025", 2);
+        manager.addTask("Undated", "", 1);
+        manager.sortTasks(ByPriorityDescending());
+        CHECK(titles() == "Buy milk;Report;Pay bills;Call;Undated;");
+        manager.sortTasks(SortOrder::DateAscending);
+        CHECK(titles() == "Undated;Buy milk;Report;Pay bills;Call;");
+    }
+
+    SUBCASE("Collated title") {
+        manager.addTask("яблоко", "", 1);
+        manager.addTask("Арбуз", "", 1);
+        manager.sortTasks(SortOrder::CollatedTitle);
+        CHECK(titles() == "Арбуз;яблоко;Buy milk;Call;Report;");
+
+        // The cached keys follow edits, deletions and the reorder.
+        manager.editTask(1, "ёлка");
+        manager.deleteTask(0);
+        manager.addTask("Дыня", "", 1);
+        vector<size_t> order;
+        manager.forEachInOrder(SortOrder::CollatedTitle, [&](size_t index) { order.push_back(index); });
+        CHECK(order == vector<size_t>{ 4, 0, 1, 2, 3 });
+        manager.sortTasks(SortOrder::CollatedTitle);
+        CHECK(titles() == "Дыня;ёлка;Buy milk;Call;Report;");
+    }
+
+    SUBCASE("Sortedness survives changes that keep the order") {
+        manager.sortTasks(SortOrder::PriorityAscending);
+        CHECK(manager.isSortedBy({ { SortField::Priority } }));
+        CHECK_FALSE(manager.isSortedBy({ { SortField::Priority, true } }));
+
+        manager.addTask("Plan", "", 3);
+        manager.editTask(0, "", "", 0);
+        manager.deleteTask(1);
+        CHECK(manager.isSortedBy({ { SortField::Priority } }));
+
+        manager.editTask(0, "", "", 4);
+        CHECK_FALSE(manager.isSortedBy({ { SortField::Priority } }));
+        manager.sortTasks(SortOrder::PriorityAscending);
+        CHECK(titles() == "Buy milk;Plan;Call;");
+
+        manager.addTask("Urgent", "", 1);
+        CHECK_FALSE(manager.isSortedBy({ { SortField::Priority } }));
+    }
+
+    SUBCASE("Custom comparators clear the sortedness") {
+        manager.sortTasks(SortOrder::Title);
+        CHECK(manager.isSortedBy({ { SortField::Title } }));
+        manager.sortTasks([](const Task& a, const Task& b) { return a.priority < b.priority; });
+        CHECK_FALSE(manager.isSortedBy({ { SortField::Title } }));
+    }
+
+    SUBCASE("Indexes follow the new order") {
+        manager.sortTasks(SortOrder::Title);
+        CHECK(manager.findTaskIndices("Report") == vector<size_t>{ 2 });
+        CHECK(manager.findTasksByQuery("priority>=3") == vector<size_t>{ 0 });
+    }
+}
+
+TEST_CASE("Ordered views") {
+    TaskManager manager;
+    manager.addTask("Report", "05.03.2025", 2);
+    manager.addTask("Call", "20.01.2026", 1);
+    manager.addTask("Buy milk", "10.12.2024", 3);
+    manager.addTask("Apply", "05.03.2025", 2);
+
+    const auto order = [&](SortOrder sortOrder) {
+        vector<size_t> indices;
+        manager.forEachInOrder(sortOrder, [&](size_t index) { indices.push_back(index); });
+        return indices;
+    };
+
+    SUBCASE("Every order without moving tasks") {
+        CHECK(order(SortOrder::PriorityAscending) == vector<size_t>{ 1, 0, 3, 2 });
+        CHECK(order(SortOrder::PriorityDescending) == vector<size_t>{ 2, 0, 3, 1 });
+        CHECK(order(SortOrder::DateAscending) == vector<size_t>{ 2, 0, 3, 1 });
+        CHECK(order(SortOrder::DateDescending) == vector<size_t>{ 1, 0, 3, 2 });
+        CHECK(order(SortOrder::Title) == vector<size_t>{ 3, 2, 1, 0 });
+        CHECK(manager.getTask(0).title == "Report");
+    }
+
+    SUBCASE("Views follow edits") {
+        manager.editTask(1, "Zoo trip", "01.01.2024", 3);
+        CHECK(order(SortOrder::PriorityDescending) == vector<size_t>{ 1, 2, 0, 3 });
+        CHECK(order(SortOrder::DateAscending) == vector<size_t>{ 1, 2, 0, 3 });
+        CHECK(order(SortOrder::Title) == vector<size_t>{ 3, 2, 0, 1 });
+    }
+
+    SUBCASE("Views follow additions and deletions") {
+        manager.addTask("Clean", "01.01.2025", 1);
+        manager.deleteTask(0);
+        CHECK(order(SortOrder::PriorityAscending) == vector<size_t>{ 0, 3, 2, 1 });
+        CHECK(order(SortOrder::DateAscending) == vector<size_t>{ 1, 3, 2, 0 });
+        CHECK(order(SortOrder::Title) == vector<size_t>{ 2, 1, 0, 3 });
+    }
+
+    SUBCASE("Views agree with a physical sort") {
+        const auto titles = order(SortOrder::Title);
+        vector<string> expected;
+        for (const size_t index : titles) expected.push_back(manager.getTask(index).title);
+        manager.sortTasks(SortOrder::Title);
+        CHECK(order(SortOrder::Title) == vector<size_t>{ 0, 1, 2, 3 });
+        for (size_t i = 0; i < expected.size(); ++i) CHECK(manager.getTask(i).title == expected[i]);
+    }
 }
 
 TEST_CASE("File operations") {
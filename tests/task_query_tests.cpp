@@ -0,0 +1,38 @@
+#include "doctest.h"
+#include "../src/task_query.h"
+#include "../src/task_manager.h"
+#include <stdexcept>
+
+TEST_CASE("Task query parsing") {
+    SUBCASE("Normalized form") {
+        CHECK(TaskQuery::parse("priority>=2 completed:no due<01.05.2025 text:\"milk\"").toString()
+            == "(priority>=2 AND completed:no AND due<01.05.2025 AND text:\"milk\")");
+        CHECK(TaskQuery::parse("priority:3 OR NOT \"buy milk\"").toString() == "(priority=3 OR NOT text:\"buy milk\")");
+        CHECK(TaskQuery::parse("milk").toString() == "text:\"milk\"");
+        CHECK(TaskQuery::parse("text:\"a (b)\"").toString() == "text:\"a (b)\"");
+    }
+
+    SUBCASE("Evaluation") {
+        const Task task{ "Buy milk", "15.04.2025", 2, false };
+        CHECK(TaskQuery::parse("priority>=2 completed:no due<01.05.2025 text:\"milk\"").matches(task));
+        CHECK_FALSE(TaskQuery::parse("priority>2").matches(task));
+        CHECK(TaskQuery::parse("due>=15.04.2025 due<=15.04.2025").matches(task));
+        CHECK(TaskQuery::parse("priority!=1 AND (bread OR milk)").matches(task));
+        CHECK_FALSE(TaskQuery::parse("NOT milk").matches(task));
+    }
+
+    SUBCASE("Tasks without a valid date never match due predicates") {
+        const Task task{ "Someday", "later", 1, false };
+        CHECK_FALSE(TaskQuery::parse("due<01.05.2025").matches(task));
+        CHECK_FALSE(TaskQuery::parse("due>01.05.2025").matches(task));
+    }
+
+    SUBCASE("Errors") {
+        CHECK_THROWS_AS(TaskQuery::parse(""), invalid_argument);
+        CHECK_THROWS_AS(TaskQuery::parse("priority>=high"), invalid_argument);
+        CHECK_THROWS_AS(TaskQuery::parse("due<tomorrow"), invalid_argument);
+        CHECK_THROWS_AS(TaskQuery::parse("completed:maybe"), invalid_argument);
+        CHECK_THROWS_AS(TaskQuery::parse("completed>yes"), invalid_argument);
+        CHECK_THROWS_AS(TaskQuery::parse("(milk"), invalid_argument);
+    }
+}
@@ -0,0 +1,270 @@
+#include "doctest.h"
+#include "../src/concurrent_task_manager.h"
+#include "../src/task_journal.h"
+#include "../src/task_transaction.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace {
+
+string readFile(const string& filename) {
+    ifstream file(filename, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+vector<string> titlesOf(const ConcurrentTaskManager& manager) {
+    vector<string> titles;
+    for (const auto& task : manager.snapshot()) titles.push_back(task.title + (task.completed ? "+" : ""));
+    return titles;
+}
+
+}
+
+TEST_CASE("Task transactions") {
+    TaskTransaction transaction;
+    transaction.addTask("Pay bills, rent", "01.02.2025", 3);
+    transaction.editTask(0, "", "05.05.2025");
+    transaction.markCompleted(1);
+    transaction.deleteTask(0);
+    transaction.sortTasks(SortOrder::CollatedTitle);
+    transaction.sortTasks({ { SortField::Priority, true }, { SortField::Title } });
+
+    SUBCASE("Indices are checked in order") {
+        CHECK(transaction.validFor(1));
+        CHECK_FALSE(transaction.validFor(0));
+        TaskTransaction deleteTwice;
+        deleteTwice.deleteTask(0);
+        deleteTwice.deleteTask(0);
+        CHECK_FALSE(deleteTwice.validFor(1));
+        CHECK(deleteTwice.validFor(2));
+    }
+
+    SUBCASE("Records round-trip") {
+        const string record = transaction.serialize();
+        CHECK(record.find("add,3,01.02.2025,Pay bills%2C rent\n") == 0);
+        const auto parsed = TaskTransaction::parse(record);
+        CHECK(parsed.size() == 6);
+        CHECK(parsed.serialize() == record);
+        CHECK_THROWS_AS(TaskTransaction::parse("remove,1\n"), invalid_argument);
+        CHECK_THROWS_AS(TaskTransaction::parse("delete,x\n"), invalid_argument);
+        CHECK_THROWS_AS(TaskTransaction::parse("sortby,7+\n"), invalid_argument);
+        CHECK_THROWS_AS(TaskTransaction::parse("add,1,,a,b\n"), invalid_argument);
+        CHECK_THROWS_AS(TaskTransaction::parse("add,1,,50%\n"), invalid_argument);
+    }
+
+    SUBCASE("Separators and line breaks in dates and titles survive a round trip") {
+        TaskTransaction tricky;
+        tricky.addTask("First\ncommit\nadd,1,,Fake", "1,2", 2);
+        tricky.editTask(0, "100% done\r\n", "3,4,5");
+        const string record = tricky.serialize();
+        CHECK(count(record.begin(), record.end(), '\n') == 2);
+
+        TaskManager manager;
+        TaskTransaction::parse(record).applyTo(manager);
+        REQUIRE(manager.getTaskCount() == 1);
+        CHECK(manager.getTask(0).title == "100% done\r\n");
+        CHECK(manager.getTask(0).date == "3,4,5");
+
+        TaskManager added;
+        TaskTransaction firstOnly;
+        firstOnly.addTask("First\ncommit\nadd,1,,Fake", "1,2", 2);
+        TaskTransaction::parse(firstOnly.serialize()).applyTo(added);
+        CHECK(added.getTask(0).title == "First\ncommit\nadd,1,,Fake");
+        CHECK(added.getTask(0).date == "1,2");
+    }
+
+    SUBCASE("Applied to a task manager") {
+        TaskManager manager;
+        manager.addTask("Buy milk", "10.12.2024", 1);
+        transaction.applyTo(manager);
+        REQUIRE(manager.getTaskCount() == 1);
+        CHECK(manager.getTask(0).title == "Pay bills, rent");
+        CHECK(manager.getTask(0).completed);
+    }
+}
+
+TEST_CASE("Concurrent task manager transactions") {
+    ConcurrentTaskManager manager;
+    manager.addTask("Buy milk", "10.12.2024", 2);
+    manager.addTask("Call mom", "20.01.2026", 1);
+
+    SUBCASE("Commit applies everything, rollback nothing") {
+        auto transaction = manager.begin();
+        transaction.editTask(0, "Buy bread");
+        transaction.addTask("Pay bills", "01.02.2025", 3);
+        transaction.deleteTask(1);
+        CHECK(manager.getTask(0)->title == "Buy milk");
+        CHECK(transaction.commit());
+        CHECK(titlesOf(manager) == vector<string>{ "Buy bread", "Pay bills" });
+        CHECK(transaction.empty());
+
+        transaction.deleteTask(0);
+        transaction.rollback();
+        CHECK(transaction.commit());
+        CHECK(manager.getTaskCount() == 2);
+    }
+
+    SUBCASE("A transaction that does not fit changes nothing") {
+        auto transaction = manager.begin();
+        transaction.markCompleted(0);
+        transaction.deleteTask(1);
+        transaction.editTask(1, "Gone");
+        CHECK_FALSE(transaction.commit());
+        CHECK(titlesOf(manager) == vector<string>{ "Buy milk", "Call mom" });
+    }
+}
+
+TEST_CASE("Task journal") {
+    const string journalFile = "task_journal_test.log";
+    remove(journalFile.c_str());
+
+    SUBCASE("Commits are replayed after a restart") {
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            manager.addTask("Buy milk", "10.12.2024", 2);
+            auto transaction = manager.begin();
+            transaction.addTask("Call mom", "20.01.2026", 1);
+            transaction.addTask("Pay bills", "01.02.2025", 3);
+            transaction.markCompleted(0);
+            transaction.sortTasks(SortOrder::PriorityDescending);
+            CHECK(transaction.commit());
+            CHECK_FALSE(manager.deleteTask(7));
+            // The journal's checkpoint record, then the two commits.
+            CHECK(manager.journalSyncCount() == 3);
+            CHECK_THROWS_AS(manager.loadFromFile("missing.txt"), logic_error);
+        }
+        ConcurrentTaskManager recovered;
+        recovered.openJournal(journalFile);
+        CHECK(titlesOf(recovered) == vector<string>{ "Pay bills", "Buy milk+", "Call mom" });
+    }
+
+    SUBCASE("A title that looks like a commit line replays as one task") {
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            manager.addTask("Half\ncommit\nadd,1,,Injected", "1,2", 2);
+        }
+        ConcurrentTaskManager recovered;
+        recovered.openJournal(journalFile);
+        REQUIRE(recovered.getTaskCount() == 1);
+        CHECK(recovered.getTask(0)->title == "Half\ncommit\nadd,1,,Injected");
+        CHECK(recovered.getTask(0)->date == "1,2");
+    }
+
+    SUBCASE("A torn last record is dropped") {
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            manager.addTask("Buy milk", "10.12.2024", 2);
+        }
+        {
+            ofstream torn(journalFile, ios::app);
+            torn << "add,1,,Half written\ncomm";
+        }
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            CHECK(titlesOf(manager) == vector<string>{ "Buy milk" });
+            manager.addTask("Call mom", "20.01.2026", 1);
+        }
+        TaskJournal journal(journalFile);
+        const auto& records = journal.recoveredRecords();
+        REQUIRE(records.size() == 3);
+        CHECK(records[0].find("checkpoint,0,") == 0);
+        CHECK(records[1] == "add,2,10.12.2024,Buy milk\n");
+        CHECK(records[2] == "add,1,20.01.2026,Call mom\n");
+    }
+
+    SUBCASE("Saving checkpoints the journal") {
+        const string taskFile = "task_journal_test.txt";
+        string beforeSave, afterSave;
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            manager.addTask("Buy milk", "10.12.2024", 2);
+            manager.addTask("Call mom", "20.01.2026", 1);
+            beforeSave = readFile(journalFile);
+            manager.saveToFile(taskFile);
+            afterSave = readFile(journalFile);
+            manager.addTask("Pay bills", "01.02.2025", 3);
+            manager.deleteTask(0);
+        }
+        CHECK(afterSave.size() < beforeSave.size());
+
+        ConcurrentTaskManager recovered;
+        recovered.loadFromFile(taskFile);
+        recovered.openJournal(journalFile);
+        CHECK(titlesOf(recovered) == vector<string>{ "Call mom", "Pay bills" });
+
+        // A crash after the rename, before the journal restarted: the journal still holds
+        // the saved changes, followed by the checkpoint of the saved file.
+        {
+            ofstream crashed(journalFile, ios::binary | ios::trunc);
+            crashed << beforeSave << afterSave;
+        }
+        ConcurrentTaskManager afterCrash;
+        afterCrash.loadFromFile(taskFile);
+        afterCrash.openJournal(journalFile);
+        CHECK(titlesOf(afterCrash) == vector<string>{ "Buy milk", "Call mom" });
+
+        // A crash before the rename: the old file (here none) replays everything.
+        ConcurrentTaskManager beforeRename;
+        beforeRename.openJournal(journalFile);
+        CHECK(titlesOf(beforeRename) == vector<string>{ "Buy milk", "Call mom" });
+        CHECK(ifstream(taskFile + ".tmp").fail());
+        remove(taskFile.c_str());
+    }
+
+    SUBCASE("Direct writes are refused while a journal is open") {
+        {
+            ConcurrentTaskManager manager;
+            manager.write([](TaskManager& tasks) { tasks.addTask("Before the journal", "01.01.2025", 1); });
+            manager.saveToFile("task_journal_test.txt");
+            manager.openJournal(journalFile);
+            CHECK_THROWS_AS(manager.write([](TaskManager& tasks) { tasks.deleteTask(0); }), logic_error);
+            manager.addTask("Journaled", "02.01.2025", 2);
+            CHECK(manager.getTaskCount() == 2);
+        }
+        ConcurrentTaskManager recovered;
+        recovered.loadFromFile("task_journal_test.txt");
+        recovered.openJournal(journalFile);
+        CHECK(titlesOf(recovered) == vector<string>{ "Before the journal", "Journaled" });
+        remove("task_journal_test.txt");
+    }
+
+    SUBCASE("A journal is not replayed onto other tasks") {
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            manager.addTask("Buy milk", "10.12.2024", 2);
+        }
+        ConcurrentTaskManager other;
+        other.addTask("Something else", "01.01.2025", 1);
+        CHECK_THROWS_AS(other.openJournal(journalFile), runtime_error);
+    }
+
+    SUBCASE("Concurrent commits all become durable") {
+        {
+            ConcurrentTaskManager manager;
+            manager.openJournal(journalFile);
+            vector<thread> committers;
+            for (int t = 0; t < 4; ++t) {
+                committers.emplace_back([&manager, t] {
+                    for (int i = 0; i < 25; ++i) manager.addTask("Task " + to_string(t), "01.01.2025", 1);
+                });
+            }
+            for (auto& thread : committers) thread.join();
+            CHECK(manager.journalSyncCount() <= 100);
+        }
+        ConcurrentTaskManager recovered;
+        recovered.openJournal(journalFile);
+        CHECK(recovered.getTaskCount() == 100);
+        CHECK(recovered.findTaskIndices("Task 3").size() == 25);
+    }
+
+    remove(journalFile.c_str());
+}
@@ -0,0 +1,103 @@
+#include "doctest.h"
+#include "../src/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Thread pool") {
+    ThreadPool pool(4);
+    CHECK(pool.size() == 4);
+
+    SUBCASE("Runs every job exactly once") {
+        vector<int> hits(1000, 0);
+        pool.run(hits.size(), [&](size_t i) { ++hits[i]; });
+        for (int hit : hits) CHECK(hit == 1);
+    }
+
+    SUBCASE("Runs consecutive batches") {
+        atomic<size_t> sum{ 0 };
+        for (int batch = 0; batch < 50; ++batch) {
+            pool.run(10, [&](size_t i) { sum += i; });
+        }
+        CHECK(sum == 50 * 45);
+    }
+
+    SUBCASE("Nested run executes inline") {
+        atomic<size_t> inner{ 0 };
+        pool.run(4, [&](size_t) { pool.run(3, [&](size_t) { ++inner; }); });
+        CHECK(inner == 12);
+    }
+
+    SUBCASE("Rethrows job exceptions") {
+        CHECK_THROWS_AS(pool.run(8, [](size_t i) { if (i == 5) throw runtime_error("job failed"); }), runtime_error);
+        atomic<size_t> count{ 0 };
+        pool.run(8, [&](size_t) { ++count; });
+        CHECK(count == 8);
+    }
+
+    SUBCASE("Concurrent callers do not wait for each other's batches") {
+        // The first batch only finishes once the second one has run, which deadlocks if
+        // batches are serialized.
+        atomic<bool> secondRan{ false };
+        atomic<bool> timedOut{ false };
+        thread first([&] {
+            pool.run(4, [&](size_t i) {
+                if (i != 0) return;
+                const auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+                while (!secondRan) {
+                    if (chrono::steady_clock::now() > deadline) { timedOut = true; return; }
+                    this_thread::yield();
+                }
+            });
+        });
+        thread second([&] {
+            this_thread::sleep_for(chrono::milliseconds(20));
+            pool.run(4, [&](size_t) { secondRan = true; });
+        });
+        first.join();
+        second.join();
+        CHECK(secondRan);
+        CHECK_FALSE(timedOut);
+    }
+
+    SUBCASE("Concurrent scans return their own results") {
+        vector<thread> callers;
+        atomic<size_t> wrong{ 0 };
+        for (size_t c = 0; c < 4; ++c) {
+            callers.emplace_back([&, c] {
+                for (int round = 0; round < 50; ++round) {
+                    const size_t total = 1000 + c * 100;
+                    const auto result = pool.scanChunks<size_t>(total, [&](size_t first, size_t last, vector<size_t>& out) {
+                        for (size_t i = first; i < last; ++i) out.push_back(i * (c + 1));
+                    });
+                    bool ok = result.size() == total;
+                    for (size_t i = 0; ok && i < total; ++i) ok = result[i] == i * (c + 1);
+                    if (!ok) ++wrong;
+                }
+            });
+        }
+        for (auto& caller : callers) caller.join();
+        CHECK(wrong == 0);
+    }
+}
+
+TEST_CASE("Parallel stable sort") {
+    mt19937 rng(11);
+    for (const size_t threads : { 1, 3, 4, 7 }) {
+        ThreadPool pool(threads);
+        for (const size_t count : { 0, 5, 5000, 40000, 100003 }) {
+            // Few distinct keys, so stability is visible through the second member.
+            vector<pair<int, size_t>> values(count);
+            for (size_t i = 0; i < count; ++i) values[i] = { static_cast<int>(rng() % 50), i };
+            auto expected = values;
+            const auto byKey = [](const pair<int, size_t>& a, const pair<int, size_t>& b) { return a.first < b.first; };
+            stable_sort(expected.begin(), expected.end(), byKey);
+            pool.stableSort(values.begin(), values.end(), byKey);
+            CHECK(values == expected);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "doctest.h"
+#include "../src/tim_sort.h"
+#include <random>
+
+namespace {
+
+// Key plus original position, so that stable_sort's order shows any instability.
+using Item = pair<int, int>;
+
+bool byKey(const Item& a, const Item& b) { return a.first < b.first; }
+
+vector<Item> numbered(const vector<int>& keys) {
+    vector<Item> items;
+    for (size_t i = 0; i < keys.size(); ++i) items.push_back({ keys[i], static_cast<int>(i) });
+    return items;
+}
+
+void checkMatchesStableSort(const vector<int>& keys) {
+    vector<Item> expected = numbered(keys);
+    stable_sort(expected.begin(), expected.end(), byKey);
+    vector<Item> actual = numbered(keys);
+    timSort(actual.begin(), actual.end(), byKey);
+    CHECK(actual == expected);
+}
+
+}
+
+TEST_CASE("TimSort") {
+    SUBCASE("Short inputs") {
+        checkMatchesStableSort({});
+        checkMatchesStableSort({ 1 });
+        checkMatchesStableSort({ 2, 1 });
+        checkMatchesStableSort({ 3, 1, 3, 2, 1, 3 });
+    }
+
+    SUBCASE("Descending runs with equal keys stay stable") {
+        checkMatchesStableSort({ 5, 4, 4, 3, 2, 2, 1 });
+        vector<int> keys;
+        for (int i = 0; i < 5000; ++i) keys.push_back((5000 - i) / 3);
+        checkMatchesStableSort(keys);
+    }
+
+    SUBCASE("Matches stable_sort on random and nearly sorted input") {
+        mt19937 rng(11);
+        for (const size_t count : { 31u, 64u, 1000u, 20000u }) {
+            for (const int range : { 2, 100, 1 << 30 }) {
+                vector<int> keys(count);
+                for (auto& key : keys) key = static_cast<int>(rng() % range);
+                checkMatchesStableSort(keys);
+
+                sort(keys.begin(), keys.end());
+                for (size_t i = 0; i < count / 50 + 1; ++i) keys[rng() % count] = static_cast<int>(rng() % range);
+                checkMatchesStableSort(keys);
+            }
+        }
+    }
+
+    SUBCASE("Long runs gallop in both directions") {
+        vector<int> keys;
+        for (int i = 0; i < 4000; ++i) keys.push_back(i * 2);
+        for (int i = 0; i < 300; ++i) keys.push_back(i * 27 + 1);
+        for (int i = 0; i < 4000; ++i) keys.push_back(i);
+        for (int i = 0; i < 200; ++i) keys.push_back(8000 - i * 40);
+        checkMatchesStableSort(keys);
+    }
+
+    SUBCASE("Sorted input takes a single pass") {
+        vector<int> keys(100000);
+        for (size_t i = 0; i < keys.size(); ++i) keys[i] = static_cast<int>(i / 4);
+        size_t comparisons = 0;
+        timSort(keys.begin(), keys.end(), [&](int a, int b) { ++comparisons; return a < b; });
+        CHECK(comparisons == keys.size() - 1);
+        CHECK(is_sorted(keys.begin(), keys.end()));
+    }
+}
@@ -0,0 +1,33 @@
+#include "doctest.h"
+#include "../src/title_order.h"
+#include "../src/task_manager.h"
+
+TEST_CASE("Title order") {
+    vector<Task> tasks = { { "b", "", 1, false }, { "a", "", 1, false }, { "b", "", 1, false } };
+    TitleOrder order;
+    order.rebuild(tasks);
+    CHECK(order.indices(tasks) == vector<uint32_t>{ 1, 0, 2 });
+
+    SUBCASE("Added tasks are merged in on the next read") {
+        tasks.push_back({ "a", "", 1, false });
+        order.insert(3);
+        tasks.push_back({ "c", "", 1, false });
+        order.insert(4);
+        CHECK(order.indices(tasks) == vector<uint32_t>{ 1, 3, 0, 2, 4 });
+    }
+
+    SUBCASE("Renamed task moves") {
+        order.remove(tasks, 0);
+        tasks[0].title = "0";
+        order.insert(0);
+        CHECK(order.indices(tasks) == vector<uint32_t>{ 0, 1, 2 });
+    }
+
+    SUBCASE("Deleted task renumbers the rest") {
+        tasks.push_back({ "0", "", 1, false });
+        order.insert(3);
+        order.erase(tasks, 0);
+        tasks.erase(tasks.begin());
+        CHECK(order.indices(tasks) == vector<uint32_t>{ 2, 0, 1 });
+    }
+}
@@ -0,0 +1,68 @@
+#include "doctest.h"
+#include "../src/title_trie.h"
+
+TEST_CASE("Title normalization") {
+    CHECK(normalizeTitle("  Buy   MILK\t") == "buy milk");
+    CHECK(normalizeTitle("") == "");
+}
+
+TEST_CASE("Title completion") {
+    TitleTrie trie(3);
+    trie.insert("Buy milk");
+    trie.insert("buy  MILK");
+    trie.insert("Buy bread");
+    trie.insert("Call mom");
+    trie.insert("Buy butter");
+    trie.insert("Buy");
+
+    CHECK(trie.titleCount() == 5);
+
+    SUBCASE("Most used first, then alphabetical") {
+        CHECK(trie.complete("bu", 10) == vector<string>{ "Buy milk", "Buy", "Buy bread" });
+        CHECK(trie.complete("BUY B", 10) == vector<string>{ "Buy bread", "Buy butter" });
+        CHECK(trie.complete("buy bu", 1) == vector<string>{ "Buy butter" });
+        CHECK(trie.complete("", 2) == vector<string>{ "Buy milk", "Buy" });
+    }
+
+    SUBCASE("A trailing space is part of the prefix") {
+        CHECK(trie.complete("buy ", 10) == vector<string>{ "Buy milk", "Buy bread", "Buy butter" });
+    }
+
+    SUBCASE("Unknown prefixes") {
+        CHECK(trie.complete("tea", 10).empty());
+        CHECK(trie.complete("buy milkshake", 10).empty());
+    }
+
+    SUBCASE("Erase") {
+        trie.erase("BUY MILK");
+        CHECK(trie.complete("buy m", 10) == vector<string>{ "Buy milk" });
+        trie.erase("buy milk");
+        CHECK(trie.complete("buy m", 10).empty());
+        trie.erase("buy milk");
+        trie.erase("Buy b");
+        CHECK(trie.titleCount() == 4);
+        CHECK(trie.complete("b", 10) == vector<string>{ "Buy", "Buy bread", "Buy butter" });
+
+        trie.insert("Buy mango");
+        CHECK(trie.complete("buy m", 10) == vector<string>{ "Buy mango" });
+    }
+
+    SUBCASE("Heavy editing does not grow the arenas") {
+        const size_t before = trie.memoryUsage();
+        for (int i = 0; i < 20000; ++i) {
+            const string title = "Temporary task number " + to_string(i) + " with a long tail";
+            trie.insert(title);
+            trie.erase(title);
+        }
+        CHECK(trie.memoryUsage() < before + 16 * 1024);
+        CHECK(trie.complete("temp", 10).empty());
+        CHECK(trie.complete("buy m", 10) == vector<string>{ "Buy milk" });
+        CHECK(trie.complete("b", 2) == vector<string>{ "Buy milk", "Buy" });
+    }
+
+    SUBCASE("Clear") {
+        trie.clear();
+        CHECK(trie.titleCount() == 0);
+        CHECK(trie.complete("", 10).empty());
+    }
+}